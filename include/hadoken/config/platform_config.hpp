@@ -49,6 +49,39 @@
 
 
 // compiler detector
+#if (defined __GNUC__) || (defined __clang__)
+#define HADOKEN_COMPILER_IS_GNU_COMPATIBLE 1
+#endif
+
+// x86 target with function level instruction set selection ( target attribute, __builtin_cpu_supports )
+#if (defined HADOKEN_COMPILER_IS_GNU_COMPATIBLE) && ((defined __x86_64__) || (defined __i386__)) &&                       \
+    !(defined HADOKEN_COMPILER_IS_NVCC)
+#define HADOKEN_PLATFORM_HAS_X86_TARGETS 1
+#endif
+
+
+// no aliasing hint
+#ifndef HADOKEN_RESTRICT
+
+#if (defined HADOKEN_COMPILER_IS_GNU_COMPATIBLE)
+#define HADOKEN_RESTRICT __restrict__
+#else
+#define HADOKEN_RESTRICT
+#endif
+
+#endif // HADOKEN_RESTRICT
+
+
+// force inlining
+#ifndef HADOKEN_ALWAYS_INLINE
+
+#if (defined HADOKEN_COMPILER_IS_GNU_COMPATIBLE)
+#define HADOKEN_ALWAYS_INLINE inline __attribute__((always_inline))
+#else
+#define HADOKEN_ALWAYS_INLINE inline
+#endif
+
+#endif // HADOKEN_ALWAYS_INLINE
 
 
 #endif // HADOKEN_PLATFORM_CONFIG_HPP
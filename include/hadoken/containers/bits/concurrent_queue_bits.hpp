@@ -49,6 +49,20 @@ inline void concurrent_queue_stl_mut<T, ThreadModel, Allocator>::push(T element)
     }
 }
 
+template <typename T, typename ThreadModel, typename Allocator>
+template <typename InputIterator>
+inline void concurrent_queue_stl_mut<T, ThreadModel, Allocator>::push_n(InputIterator first, std::size_t n) {
+    {
+        std::lock_guard<std::mutex> l(_qmut);
+
+        for (std::size_t i = 0; i < n; ++i, ++first) {
+            _dek.push_back(std::move(*first));
+        }
+        _buffer_capacity = std::max<std::uint64_t>(_dek.size(), _buffer_capacity);
+        _qcond.notify_all();
+    }
+}
+
 
 template <typename T, typename ThreadModel, typename Allocator>
 template <typename Duration>
@@ -87,7 +101,15 @@ inline optional<T> concurrent_queue_stl_mut<T, ThreadModel, Allocator>::try_pop(
 
 template <typename T, typename ThreadModel, typename Allocator>
 inline optional<T> concurrent_queue_stl_mut<T, ThreadModel, Allocator>::try_pop() {
-    return try_pop(std::chrono::milliseconds(0));
+    // non blocking version, do not touch the condition variable
+    std::lock_guard<decltype(_qmut)> l(_qmut);
+    if (_dek.empty()) {
+        return details::empty_optional<T>();
+    }
+
+    optional<T> res(std::move(_dek.front()));
+    _dek.pop_front();
+    return res;
 }
 
 
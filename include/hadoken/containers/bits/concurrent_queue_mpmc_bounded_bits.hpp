@@ -0,0 +1,203 @@
+/**
+ * Copyright (c) 2018, Adrien Devresse <adrien.devresse@epfl.ch>
+ *
+ * Boost Software License - Version 1.0
+ *
+ * Permission is hereby granted, free of charge, to any person or organization
+ * obtaining a copy of the software and accompanying documentation covered by
+ * this license (the "Software") to use, reproduce, display, distribute,
+ * execute, and transmit the Software, and to prepare derivative works of the
+ * Software, and to permit third-parties to whom the Software is furnished to
+ * do so, all subject to the following:
+ *
+ * The copyright notices in the Software and this entire statement, including
+ * the above license grant, this restriction and the following disclaimer,
+ * must be included in all copies of the Software, in whole or in part, and
+ * all derivative works of the Software, unless such copies or derivative
+ * works are solely in the form of machine-executable object code generated by
+ * a source language processor.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+ * SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+ * FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ *
+ */
+#ifndef CONCURRENT_QUEUE_MPMC_BOUNDED_BITS_HPP
+#define CONCURRENT_QUEUE_MPMC_BOUNDED_BITS_HPP
+
+#include <cstdint>
+#include <new>
+#include <thread>
+
+#include "../concurrent_queue_mpmc_bounded.hpp"
+
+namespace hadoken {
+
+
+namespace details {
+
+// spin, then yield, between two attempts on a lock-free structure
+inline void backoff_wait(std::size_t& attempt) {
+    attempt += 1;
+#ifndef HADOKEN_SPIN_NO_YIELD
+    if (attempt % 64 == 0) {
+        std::this_thread::yield();
+    }
+#else
+    if (attempt % 64 == 0) {
+        std::this_thread::sleep_for(std::chrono::microseconds(1));
+    }
+#endif
+}
+
+} // namespace details
+
+
+template <typename T, std::size_t Capacity>
+inline concurrent_queue_mpmc_bounded<T, Capacity>::concurrent_queue_mpmc_bounded()
+    : _buffer(new char[Capacity * slot_size + cache_line_size]), _slots(nullptr), _pad_begin(), _enqueue_pos(0),
+      _pad_enqueue(), _dequeue_pos(0), _pad_dequeue() {
+
+    // align the slots manually on a cache line, C++11 operator new ignores extended alignment
+    const std::uintptr_t raw = reinterpret_cast<std::uintptr_t>(_buffer.get());
+    _slots = _buffer.get() + ((cache_line_size - (raw % cache_line_size)) % cache_line_size);
+
+    for (std::size_t i = 0; i < Capacity; ++i) {
+        slot* s = new (_slots + i * slot_size) slot();
+        s->sequence.store(i, std::memory_order_relaxed);
+    }
+}
+
+
+template <typename T, std::size_t Capacity>
+inline concurrent_queue_mpmc_bounded<T, Capacity>::~concurrent_queue_mpmc_bounded() {
+    // destroy remaining elements
+    while (try_pop()) {
+    }
+
+    for (std::size_t i = 0; i < Capacity; ++i) {
+        _slot_at(i)->~slot();
+    }
+}
+
+
+template <typename T, std::size_t Capacity>
+inline typename concurrent_queue_mpmc_bounded<T, Capacity>::slot*
+concurrent_queue_mpmc_bounded<T, Capacity>::_slot_at(std::size_t pos) const {
+    return reinterpret_cast<slot*>(_slots + (pos & (Capacity - 1)) * slot_size);
+}
+
+
+template <typename T, std::size_t Capacity>
+inline bool concurrent_queue_mpmc_bounded<T, Capacity>::try_push(T&& element) {
+    slot* cell;
+    std::size_t pos = _enqueue_pos.load(std::memory_order_relaxed);
+
+    while (true) {
+        cell = _slot_at(pos);
+        const std::size_t seq = cell->sequence.load(std::memory_order_acquire);
+        const std::intptr_t diff = static_cast<std::intptr_t>(seq) - static_cast<std::intptr_t>(pos);
+
+        if (diff == 0) {
+            if (_enqueue_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                break;
+            }
+        } else if (diff < 0) {
+            // full
+            return false;
+        } else {
+            pos = _enqueue_pos.load(std::memory_order_relaxed);
+        }
+    }
+
+    new (&cell->storage) T(std::move(element));
+    cell->sequence.store(pos + 1, std::memory_order_release);
+    return true;
+}
+
+
+template <typename T, std::size_t Capacity>
+inline void concurrent_queue_mpmc_bounded<T, Capacity>::push(T element) {
+    std::size_t attempt = 0;
+    while (try_push(std::move(element)) == false) {
+        details::backoff_wait(attempt);
+    }
+}
+
+template <typename T, std::size_t Capacity>
+template <typename InputIterator>
+inline void concurrent_queue_mpmc_bounded<T, Capacity>::push_n(InputIterator first, std::size_t n) {
+    for (std::size_t i = 0; i < n; ++i, ++first) {
+        push(std::move(*first));
+    }
+}
+
+
+template <typename T, std::size_t Capacity>
+inline optional<T> concurrent_queue_mpmc_bounded<T, Capacity>::try_pop() {
+    slot* cell;
+    std::size_t pos = _dequeue_pos.load(std::memory_order_relaxed);
+
+    while (true) {
+        cell = _slot_at(pos);
+        const std::size_t seq = cell->sequence.load(std::memory_order_acquire);
+        const std::intptr_t diff = static_cast<std::intptr_t>(seq) - static_cast<std::intptr_t>(pos + 1);
+
+        if (diff == 0) {
+            if (_dequeue_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                break;
+            }
+        } else if (diff < 0) {
+            // empty
+            return details::empty_optional<T>();
+        } else {
+            pos = _dequeue_pos.load(std::memory_order_relaxed);
+        }
+    }
+
+    T* element = reinterpret_cast<T*>(&cell->storage);
+    optional<T> res(std::move(*element));
+    element->~T();
+    cell->sequence.store(pos + Capacity, std::memory_order_release);
+    return res;
+}
+
+
+template <typename T, std::size_t Capacity>
+template <typename Duration>
+inline optional<T> concurrent_queue_mpmc_bounded<T, Capacity>::try_pop(const Duration& d) {
+    // lock-free: no condition variable to sleep on, spin and yield until the deadline
+    const auto deadline = std::chrono::steady_clock::now() + d;
+    std::size_t attempt = 0;
+
+    while (true) {
+        optional<T> res = try_pop();
+        if (res || std::chrono::steady_clock::now() >= deadline) {
+            return res;
+        }
+        details::backoff_wait(attempt);
+    }
+}
+
+
+template <typename T, std::size_t Capacity>
+inline bool concurrent_queue_mpmc_bounded<T, Capacity>::empty() const {
+    return size() == 0;
+}
+
+
+template <typename T, std::size_t Capacity>
+inline std::size_t concurrent_queue_mpmc_bounded<T, Capacity>::size() const {
+    const std::size_t dequeue_pos = _dequeue_pos.load(std::memory_order_relaxed);
+    const std::size_t enqueue_pos = _enqueue_pos.load(std::memory_order_relaxed);
+    return (enqueue_pos > dequeue_pos) ? (enqueue_pos - dequeue_pos) : 0;
+}
+
+
+} // namespace hadoken
+
+#endif // CONCURRENT_QUEUE_MPMC_BOUNDED_BITS_HPP
@@ -0,0 +1,271 @@
+/**
+ * Copyright (c) 2018, Adrien Devresse <adrien.devresse@epfl.ch>
+ *
+ * Boost Software License - Version 1.0
+ *
+ * Permission is hereby granted, free of charge, to any person or organization
+ * obtaining a copy of the software and accompanying documentation covered by
+ * this license (the "Software") to use, reproduce, display, distribute,
+ * execute, and transmit the Software, and to prepare derivative works of the
+ * Software, and to permit third-parties to whom the Software is furnished to
+ * do so, all subject to the following:
+ *
+ * The copyright notices in the Software and this entire statement, including
+ * the above license grant, this restriction and the following disclaimer,
+ * must be included in all copies of the Software, in whole or in part, and
+ * all derivative works of the Software, unless such copies or derivative
+ * works are solely in the form of machine-executable object code generated by
+ * a source language processor.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+ * SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+ * FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ *
+ */
+#ifndef CONCURRENT_QUEUE_SPSC_BITS_HPP
+#define CONCURRENT_QUEUE_SPSC_BITS_HPP
+
+#include <algorithm>
+#include <iterator>
+#include <mutex>
+#include <new>
+#include <thread>
+
+#include "../concurrent_queue_spsc.hpp"
+
+namespace hadoken {
+
+
+namespace details {
+
+inline std::size_t next_power_of_two(std::size_t v) {
+    std::size_t res = 2;
+    while (res < v) {
+        res <<= 1;
+    }
+    return res;
+}
+
+} // namespace details
+
+
+template <typename T, typename ThreadModel>
+inline concurrent_queue_spsc<T, ThreadModel>::concurrent_queue_spsc(std::size_t capacity)
+    : _mask(details::next_power_of_two(capacity) - 1), _ring(new storage_type[_mask + 1]), _spin_count(1024), _pad_producer(),
+      _tail(0), _head_cache(0), _pad_consumer(), _head(0), _tail_cache(0), _pad_end(), _park_lock(), _park_cond(),
+      _producer_parked(false), _consumer_parked(false) {}
+
+
+template <typename T, typename ThreadModel>
+inline concurrent_queue_spsc<T, ThreadModel>::~concurrent_queue_spsc() {
+    const std::size_t tail = _tail.load(std::memory_order_relaxed);
+    for (std::size_t pos = _head.load(std::memory_order_relaxed); pos != tail; ++pos) {
+        _slot(pos)->~T();
+    }
+}
+
+
+// producer only
+template <typename T, typename ThreadModel>
+inline std::size_t concurrent_queue_spsc<T, ThreadModel>::_free_slots(std::size_t wanted) {
+    const std::size_t tail = _tail.load(std::memory_order_relaxed);
+    std::size_t free_slots = capacity() - (tail - _head_cache);
+    if (free_slots < wanted) {
+        _head_cache = _head.load(std::memory_order_acquire);
+        free_slots = capacity() - (tail - _head_cache);
+    }
+    return free_slots;
+}
+
+
+// consumer only
+template <typename T, typename ThreadModel>
+inline std::size_t concurrent_queue_spsc<T, ThreadModel>::_available_slots(std::size_t wanted) {
+    const std::size_t head = _head.load(std::memory_order_relaxed);
+    std::size_t available = _tail_cache - head;
+    if (available < wanted) {
+        _tail_cache = _tail.load(std::memory_order_acquire);
+        available = _tail_cache - head;
+    }
+    return available;
+}
+
+
+template <typename T, typename ThreadModel>
+template <typename Predicate, typename TimePoint>
+inline bool concurrent_queue_spsc<T, ThreadModel>::_wait(Predicate pred, std::atomic<bool>& parked_flag,
+                                                         const TimePoint& deadline) {
+    for (std::size_t i = 1; i <= _spin_count; ++i) {
+        if (pred()) {
+            return true;
+        }
+
+#ifndef HADOKEN_SPIN_NO_YIELD
+        if (i % 64 == 0) {
+            std::this_thread::yield();
+        }
+#endif
+    }
+
+    std::unique_lock<decltype(_park_lock)> l(_park_lock);
+    parked_flag.store(true);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+
+    bool res = pred();
+    while (res == false) {
+        if (_park_cond.wait_until(l, deadline) == std::cv_status::timeout) {
+            res = pred();
+            break;
+        }
+        res = pred();
+    }
+
+    parked_flag.store(false);
+    return res;
+}
+
+
+template <typename T, typename ThreadModel>
+inline void concurrent_queue_spsc<T, ThreadModel>::_notify(std::atomic<bool>& parked_flag) {
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (parked_flag.load(std::memory_order_relaxed)) {
+        std::lock_guard<decltype(_park_lock)> l(_park_lock);
+        _park_cond.notify_all();
+    }
+}
+
+
+template <typename T, typename ThreadModel>
+inline bool concurrent_queue_spsc<T, ThreadModel>::try_push(T&& element) {
+    if (_free_slots() == 0) {
+        return false;
+    }
+
+    const std::size_t tail = _tail.load(std::memory_order_relaxed);
+    new (_slot(tail)) T(std::move(element));
+    _tail.store(tail + 1, std::memory_order_release);
+    _notify(_consumer_parked);
+    return true;
+}
+
+
+template <typename T, typename ThreadModel>
+inline void concurrent_queue_spsc<T, ThreadModel>::push(T element) {
+    while (try_push(std::move(element)) == false) {
+        _wait([this]() { return _free_slots() > 0; }, _producer_parked,
+              std::chrono::steady_clock::now() + std::chrono::milliseconds(100));
+    }
+}
+
+
+template <typename T, typename ThreadModel>
+template <typename ForwardIterator>
+inline std::size_t concurrent_queue_spsc<T, ThreadModel>::push_n(ForwardIterator first, std::size_t n) {
+    const std::size_t count = std::min(n, _free_slots(n));
+    if (count == 0) {
+        return 0;
+    }
+
+    const std::size_t tail = _tail.load(std::memory_order_relaxed);
+
+    // at most two contiguous segments: up to the end of the ring, then from its beginning
+    const std::size_t first_segment = std::min(count, capacity() - (tail & _mask));
+    ForwardIterator middle = first;
+    std::advance(middle, first_segment);
+    ForwardIterator last = middle;
+    std::advance(last, count - first_segment);
+
+    std::uninitialized_copy(std::make_move_iterator(first), std::make_move_iterator(middle), _slot(tail));
+    std::uninitialized_copy(std::make_move_iterator(middle), std::make_move_iterator(last), _slot(0));
+
+    _tail.store(tail + count, std::memory_order_release);
+    _notify(_consumer_parked);
+    return count;
+}
+
+
+template <typename T, typename ThreadModel>
+inline optional<T> concurrent_queue_spsc<T, ThreadModel>::try_pop() {
+    if (_available_slots() == 0) {
+        return details::empty_optional<T>();
+    }
+
+    const std::size_t head = _head.load(std::memory_order_relaxed);
+    T* element = _slot(head);
+    optional<T> res(std::move(*element));
+    element->~T();
+    _head.store(head + 1, std::memory_order_release);
+    _notify(_producer_parked);
+    return res;
+}
+
+
+template <typename T, typename ThreadModel>
+template <typename Duration>
+inline optional<T> concurrent_queue_spsc<T, ThreadModel>::try_pop(const Duration& d) {
+    optional<T> res = try_pop();
+    if (!res && _wait([this]() { return _available_slots() > 0; }, _consumer_parked, std::chrono::steady_clock::now() + d)) {
+        res = try_pop();
+    }
+    return res;
+}
+
+
+template <typename T, typename ThreadModel>
+inline T concurrent_queue_spsc<T, ThreadModel>::pop() {
+    while (true) {
+        optional<T> res = try_pop(std::chrono::milliseconds(100));
+        if (res) {
+            return std::move(res.get());
+        }
+    }
+}
+
+
+template <typename T, typename ThreadModel>
+template <typename OutputIterator>
+inline std::size_t concurrent_queue_spsc<T, ThreadModel>::pop_n(OutputIterator output, std::size_t n) {
+    const std::size_t count = std::min(n, _available_slots(n));
+    if (count == 0) {
+        return 0;
+    }
+
+    const std::size_t head = _head.load(std::memory_order_relaxed);
+    const std::size_t first_segment = std::min(count, capacity() - (head & _mask));
+    const std::size_t second_segment = count - first_segment;
+
+    T* first = _slot(head);
+    output = std::move(first, first + first_segment, output);
+    std::move(_slot(0), _slot(0) + second_segment, output);
+
+    for (std::size_t i = 0; i < count; ++i) {
+        _slot(head + i)->~T();
+    }
+
+    _head.store(head + count, std::memory_order_release);
+    _notify(_producer_parked);
+    return count;
+}
+
+
+template <typename T, typename ThreadModel>
+inline bool concurrent_queue_spsc<T, ThreadModel>::empty() const {
+    return size() == 0;
+}
+
+
+template <typename T, typename ThreadModel>
+inline std::size_t concurrent_queue_spsc<T, ThreadModel>::size() const {
+    // head first, tail never goes behind a previously read head
+    const std::size_t head = _head.load(std::memory_order_acquire);
+    return _tail.load(std::memory_order_acquire) - head;
+}
+
+
+} // namespace hadoken
+
+#endif // CONCURRENT_QUEUE_SPSC_BITS_HPP
@@ -0,0 +1,163 @@
+/**
+ * Copyright (c) 2018, Adrien Devresse <adrien.devresse@epfl.ch>
+ *
+ * Boost Software License - Version 1.0
+ *
+ * Permission is hereby granted, free of charge, to any person or organization
+ * obtaining a copy of the software and accompanying documentation covered by
+ * this license (the "Software") to use, reproduce, display, distribute,
+ * execute, and transmit the Software, and to prepare derivative works of the
+ * Software, and to permit third-parties to whom the Software is furnished to
+ * do so, all subject to the following:
+ *
+ * The copyright notices in the Software and this entire statement, including
+ * the above license grant, this restriction and the following disclaimer,
+ * must be included in all copies of the Software, in whole or in part, and
+ * all derivative works of the Software, unless such copies or derivative
+ * works are solely in the form of machine-executable object code generated by
+ * a source language processor.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+ * SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+ * FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ *
+ */
+#ifndef WORK_STEALING_DEQUE_BITS_HPP
+#define WORK_STEALING_DEQUE_BITS_HPP
+
+#include "../work_stealing_deque.hpp"
+
+namespace hadoken {
+
+
+template <typename T>
+class work_stealing_deque<T>::ring_buffer {
+  public:
+    explicit ring_buffer(std::size_t capacity) : _mask(capacity - 1), _slots(new std::atomic<T>[capacity]) {}
+
+    inline std::int64_t capacity() const { return static_cast<std::int64_t>(_mask + 1); }
+
+    inline void put(std::int64_t pos, T element) {
+        _slots[static_cast<std::size_t>(pos) & _mask].store(element, std::memory_order_relaxed);
+    }
+
+    inline T get(std::int64_t pos) const { return _slots[static_cast<std::size_t>(pos) & _mask].load(std::memory_order_relaxed); }
+
+  private:
+    std::size_t _mask;
+    std::unique_ptr<std::atomic<T>[]> _slots;
+};
+
+
+template <typename T>
+inline work_stealing_deque<T>::work_stealing_deque(std::size_t initial_capacity)
+    : _top(0), _pad_top(), _bottom(0), _buffer(), _pad_bottom(), _buffers() {
+    // capacity need to be a power of 2
+    std::size_t capacity = 2;
+    while (capacity < initial_capacity) {
+        capacity <<= 1;
+    }
+
+    _buffers.emplace_back(new ring_buffer(capacity));
+    _buffer.store(_buffers.back().get(), std::memory_order_relaxed);
+}
+
+
+template <typename T>
+inline void work_stealing_deque<T>::push(T element) {
+    const std::int64_t bottom = _bottom.load(std::memory_order_relaxed);
+    const std::int64_t top = _top.load(std::memory_order_acquire);
+    ring_buffer* buffer = _buffer.load(std::memory_order_relaxed);
+
+    if (bottom - top > buffer->capacity() - 1) {
+        buffer = _grow(buffer, bottom, top);
+    }
+
+    buffer->put(bottom, element);
+    std::atomic_thread_fence(std::memory_order_release);
+    _bottom.store(bottom + 1, std::memory_order_relaxed);
+}
+
+
+template <typename T>
+inline optional<T> work_stealing_deque<T>::pop() {
+    const std::int64_t bottom = _bottom.load(std::memory_order_relaxed) - 1;
+    ring_buffer* buffer = _buffer.load(std::memory_order_relaxed);
+    _bottom.store(bottom, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    std::int64_t top = _top.load(std::memory_order_relaxed);
+
+    if (top > bottom) {
+        // empty deque
+        _bottom.store(bottom + 1, std::memory_order_relaxed);
+        return details::empty_optional<T>();
+    }
+
+    T element = buffer->get(bottom);
+    if (top == bottom) {
+        // last element, race against thieves
+        const bool won = _top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed);
+        _bottom.store(bottom + 1, std::memory_order_relaxed);
+        if (won == false) {
+            return details::empty_optional<T>();
+        }
+    }
+    return optional<T>(std::move(element));
+}
+
+
+template <typename T>
+inline optional<T> work_stealing_deque<T>::steal() {
+    std::int64_t top = _top.load(std::memory_order_acquire);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    const std::int64_t bottom = _bottom.load(std::memory_order_acquire);
+
+    if (top < bottom) {
+        // consume ordering is promoted to acquire by every mainstream compiler
+        ring_buffer* buffer = _buffer.load(std::memory_order_acquire);
+        T element = buffer->get(top);
+        if (_top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+            return optional<T>(std::move(element));
+        }
+    }
+    return details::empty_optional<T>();
+}
+
+
+template <typename T>
+inline bool work_stealing_deque<T>::empty() const {
+    return size() == 0;
+}
+
+
+template <typename T>
+inline std::size_t work_stealing_deque<T>::size() const {
+    const std::int64_t bottom = _bottom.load(std::memory_order_relaxed);
+    const std::int64_t top = _top.load(std::memory_order_relaxed);
+    return static_cast<std::size_t>((bottom > top) ? (bottom - top) : 0);
+}
+
+
+template <typename T>
+inline typename work_stealing_deque<T>::ring_buffer* work_stealing_deque<T>::_grow(ring_buffer* buffer, std::int64_t bottom,
+                                                                                   std::int64_t top) {
+    std::unique_ptr<ring_buffer> new_buffer(new ring_buffer(static_cast<std::size_t>(buffer->capacity()) * 2));
+
+    for (std::int64_t i = top; i < bottom; ++i) {
+        new_buffer->put(i, buffer->get(i));
+    }
+
+    ring_buffer* res = new_buffer.get();
+    _buffers.emplace_back(std::move(new_buffer));
+    _buffer.store(res, std::memory_order_release);
+    return res;
+}
+
+
+} // namespace hadoken
+
+#endif // WORK_STEALING_DEQUE_BITS_HPP
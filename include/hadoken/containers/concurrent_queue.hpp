@@ -50,6 +50,10 @@ class concurrent_queue_stl_mut {
 
     void push(T element);
 
+    /// push n elements with a single lock acquisition, elements are moved from the input
+    template <typename InputIterator>
+    void push_n(InputIterator first, std::size_t n);
+
 
     template <typename Duration>
     optional<T> try_pop(const Duration& d);
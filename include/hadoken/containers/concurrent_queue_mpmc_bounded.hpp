@@ -0,0 +1,116 @@
+/**
+ * Copyright (c) 2018, Adrien Devresse <adrien.devresse@epfl.ch>
+ *
+ * Boost Software License - Version 1.0
+ *
+ * Permission is hereby granted, free of charge, to any person or organization
+ * obtaining a copy of the software and accompanying documentation covered by
+ * this license (the "Software") to use, reproduce, display, distribute,
+ * execute, and transmit the Software, and to prepare derivative works of the
+ * Software, and to permit third-parties to whom the Software is furnished to
+ * do so, all subject to the following:
+ *
+ * The copyright notices in the Software and this entire statement, including
+ * the above license grant, this restriction and the following disclaimer,
+ * must be included in all copies of the Software, in whole or in part, and
+ * all derivative works of the Software, unless such copies or derivative
+ * works are solely in the form of machine-executable object code generated by
+ * a source language processor.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+ * SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+ * FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ *
+ */
+#ifndef CONCURRENT_QUEUE_MPMC_BOUNDED_HPP
+#define CONCURRENT_QUEUE_MPMC_BOUNDED_HPP
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <type_traits>
+
+
+#include <hadoken/utility/optional.hpp>
+
+namespace hadoken {
+
+///
+/// lock-free, bounded, multi-producers multi-consumers queue
+///
+/// ring buffer of cache line padded slots, each slot carries a sequence number
+/// ( D. Vyukov bounded MPMC queue )
+///
+/// no lock and no memory allocation after construction
+///
+/// API compatible with concurrent_queue_stl_mut, push() spins if the queue is full
+///
+template <typename T, std::size_t Capacity = 1024>
+class concurrent_queue_mpmc_bounded {
+  public:
+    static_assert(Capacity >= 2 && (Capacity & (Capacity - 1)) == 0, "Capacity must be a power of 2");
+
+    typedef T value_type;
+
+    concurrent_queue_mpmc_bounded();
+
+    ~concurrent_queue_mpmc_bounded();
+
+    /// push an element, wait for a free slot if the queue is full
+    void push(T element);
+
+    /// try to push an element, element is moved only in case of success
+    bool try_push(T&& element);
+
+    /// push n elements, elements are moved from the input
+    template <typename InputIterator>
+    void push_n(InputIterator first, std::size_t n);
+
+    template <typename Duration>
+    optional<T> try_pop(const Duration& d);
+
+    optional<T> try_pop();
+
+    bool empty() const;
+
+    std::size_t size() const;
+
+    static constexpr std::size_t capacity() { return Capacity; }
+
+  private:
+    static constexpr std::size_t cache_line_size = 64;
+
+    struct slot {
+        std::atomic<std::size_t> sequence;
+        typename std::aligned_storage<sizeof(T), alignof(T)>::type storage;
+    };
+
+    static constexpr std::size_t slot_size = ((sizeof(slot) + cache_line_size - 1) / cache_line_size) * cache_line_size;
+
+    concurrent_queue_mpmc_bounded(const concurrent_queue_mpmc_bounded&) = delete;
+    concurrent_queue_mpmc_bounded& operator=(const concurrent_queue_mpmc_bounded&) = delete;
+
+    slot* _slot_at(std::size_t pos) const;
+
+    std::unique_ptr<char[]> _buffer;
+    char* _slots;
+
+    char _pad_begin[cache_line_size];
+    std::atomic<std::size_t> _enqueue_pos;
+    char _pad_enqueue[cache_line_size - sizeof(std::atomic<std::size_t>)];
+    std::atomic<std::size_t> _dequeue_pos;
+    char _pad_dequeue[cache_line_size - sizeof(std::atomic<std::size_t>)];
+};
+
+
+} // namespace hadoken
+
+
+#include "bits/concurrent_queue_mpmc_bounded_bits.hpp"
+
+#endif // CONCURRENT_QUEUE_MPMC_BOUNDED_HPP
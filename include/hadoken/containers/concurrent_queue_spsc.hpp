@@ -0,0 +1,144 @@
+/**
+ * Copyright (c) 2018, Adrien Devresse <adrien.devresse@epfl.ch>
+ *
+ * Boost Software License - Version 1.0
+ *
+ * Permission is hereby granted, free of charge, to any person or organization
+ * obtaining a copy of the software and accompanying documentation covered by
+ * this license (the "Software") to use, reproduce, display, distribute,
+ * execute, and transmit the Software, and to prepare derivative works of the
+ * Software, and to permit third-parties to whom the Software is furnished to
+ * do so, all subject to the following:
+ *
+ * The copyright notices in the Software and this entire statement, including
+ * the above license grant, this restriction and the following disclaimer,
+ * must be included in all copies of the Software, in whole or in part, and
+ * all derivative works of the Software, unless such copies or derivative
+ * works are solely in the form of machine-executable object code generated by
+ * a source language processor.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+ * SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+ * FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ *
+ */
+#ifndef CONCURRENT_QUEUE_SPSC_HPP
+#define CONCURRENT_QUEUE_SPSC_HPP
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <type_traits>
+
+
+#include <hadoken/threading/std_thread_model.hpp>
+#include <hadoken/utility/optional.hpp>
+
+namespace hadoken {
+
+///
+/// wait-free, bounded, single-producer single-consumer ring queue
+///
+/// - each side keeps a cached copy of the other side index,
+///   the shared indexes are read only when the cache says full / empty
+/// - push_n / pop_n move whole spans with a single index update
+/// - blocking operations spin first, then park on a condition variable
+///
+/// exactly one thread can push and exactly one thread can pop at a given time
+///
+template <typename T, typename ThreadModel = std_thread_model>
+class concurrent_queue_spsc {
+  public:
+    typedef T value_type;
+
+    /// capacity is rounded up to the next power of 2
+    explicit concurrent_queue_spsc(std::size_t capacity = 1024);
+
+    ~concurrent_queue_spsc();
+
+    /// push an element, wait for a free slot if the queue is full
+    void push(T element);
+
+    /// try to push an element, element is moved only in case of success
+    bool try_push(T&& element);
+
+    /// move up to n elements from first, return the number of elements pushed
+    /// the range is traversed twice, to split it at the end of the ring: first is a forward iterator
+    template <typename ForwardIterator>
+    std::size_t push_n(ForwardIterator first, std::size_t n);
+
+    /// pop an element, wait until one is available
+    T pop();
+
+    template <typename Duration>
+    optional<T> try_pop(const Duration& d);
+
+    optional<T> try_pop();
+
+    /// move up to n elements to output, return the number of elements popped
+    template <typename OutputIterator>
+    std::size_t pop_n(OutputIterator output, std::size_t n);
+
+    bool empty() const;
+
+    std::size_t size() const;
+
+    std::size_t capacity() const { return _mask + 1; }
+
+    /// number of iterations spent spinning before parking a waiting thread
+    void set_spin_count(std::size_t spin_count) { _spin_count = spin_count; }
+
+  private:
+    static constexpr std::size_t cache_line_size = 64;
+
+    using storage_type = typename std::aligned_storage<sizeof(T), alignof(T)>::type;
+
+    concurrent_queue_spsc(const concurrent_queue_spsc&) = delete;
+    concurrent_queue_spsc& operator=(const concurrent_queue_spsc&) = delete;
+
+    T* _slot(std::size_t pos) const { return reinterpret_cast<T*>(&_ring[pos & _mask]); }
+
+    // producer side only, refresh the cached head if less than wanted slots are free
+    std::size_t _free_slots(std::size_t wanted = 1);
+
+    // consumer side only, refresh the cached tail if less than wanted slots are used
+    std::size_t _available_slots(std::size_t wanted = 1);
+
+    template <typename Predicate, typename TimePoint>
+    bool _wait(Predicate pred, std::atomic<bool>& parked_flag, const TimePoint& deadline);
+
+    void _notify(std::atomic<bool>& parked_flag);
+
+    const std::size_t _mask;
+    std::unique_ptr<storage_type[]> _ring;
+    std::size_t _spin_count;
+
+    // producer side
+    char _pad_producer[cache_line_size];
+    std::atomic<std::size_t> _tail;
+    std::size_t _head_cache;
+
+    // consumer side
+    char _pad_consumer[cache_line_size - sizeof(std::atomic<std::size_t>) - sizeof(std::size_t)];
+    std::atomic<std::size_t> _head;
+    std::size_t _tail_cache;
+    char _pad_end[cache_line_size - sizeof(std::atomic<std::size_t>) - sizeof(std::size_t)];
+
+    // parking
+    typename ThreadModel::mutex _park_lock;
+    typename ThreadModel::condition_variable _park_cond;
+    std::atomic<bool> _producer_parked, _consumer_parked;
+};
+
+
+} // namespace hadoken
+
+
+#include "bits/concurrent_queue_spsc_bits.hpp"
+
+#endif // CONCURRENT_QUEUE_SPSC_HPP
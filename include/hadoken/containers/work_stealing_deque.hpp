@@ -0,0 +1,103 @@
+/**
+ * Copyright (c) 2018, Adrien Devresse <adrien.devresse@epfl.ch>
+ *
+ * Boost Software License - Version 1.0
+ *
+ * Permission is hereby granted, free of charge, to any person or organization
+ * obtaining a copy of the software and accompanying documentation covered by
+ * this license (the "Software") to use, reproduce, display, distribute,
+ * execute, and transmit the Software, and to prepare derivative works of the
+ * Software, and to permit third-parties to whom the Software is furnished to
+ * do so, all subject to the following:
+ *
+ * The copyright notices in the Software and this entire statement, including
+ * the above license grant, this restriction and the following disclaimer,
+ * must be included in all copies of the Software, in whole or in part, and
+ * all derivative works of the Software, unless such copies or derivative
+ * works are solely in the form of machine-executable object code generated by
+ * a source language processor.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+ * SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+ * FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ *
+ */
+#ifndef WORK_STEALING_DEQUE_HPP
+#define WORK_STEALING_DEQUE_HPP
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <type_traits>
+#include <vector>
+
+
+#include <hadoken/utility/optional.hpp>
+
+namespace hadoken {
+
+///
+/// work stealing deque ( Chase-Lev )
+///
+/// lock-free, dynamically growing, deque designed for work stealing schedulers
+/// - the owner thread pushes and pops at the bottom ( LIFO )
+/// - any other thread can steal at the top ( FIFO )
+///
+/// implementation follows "Correct and Efficient Work-Stealing for Weak Memory Models", Le et al., PPoPP 2013
+///
+/// T must be trivially copyable ( usually a pointer to a task )
+///
+template <typename T>
+class work_stealing_deque {
+  public:
+    static_assert(std::is_trivially_copyable<T>::value, "work_stealing_deque requires a trivially copyable type");
+
+    explicit work_stealing_deque(std::size_t initial_capacity = 256);
+
+    /// push an element at the bottom of the deque, owner thread only
+    void push(T element);
+
+    /// pop an element from the bottom of the deque, owner thread only
+    optional<T> pop();
+
+    /// steal an element from the top of the deque, any thread
+    /// can fail spuriously under contention
+    optional<T> steal();
+
+    /// approximation of the emptiness of the deque, any thread
+    bool empty() const;
+
+    /// approximation of the size of the deque, any thread
+    std::size_t size() const;
+
+  private:
+    class ring_buffer;
+
+    work_stealing_deque(const work_stealing_deque&) = delete;
+    work_stealing_deque& operator=(const work_stealing_deque&) = delete;
+
+    ring_buffer* _grow(ring_buffer* buffer, std::int64_t bottom, std::int64_t top);
+
+    // padding instead of alignas, C++11 operator new ignores extended alignment
+    std::atomic<std::int64_t> _top;
+    char _pad_top[64 - sizeof(std::atomic<std::int64_t>)];
+    std::atomic<std::int64_t> _bottom;
+    std::atomic<ring_buffer*> _buffer;
+    char _pad_bottom[64 - sizeof(std::atomic<std::int64_t>) - sizeof(std::atomic<ring_buffer*>)];
+
+    // previous buffers are kept alive until destruction,
+    // a concurrent thief might still read them
+    std::vector<std::unique_ptr<ring_buffer>> _buffers;
+};
+
+
+} // namespace hadoken
+
+
+#include "bits/work_stealing_deque_bits.hpp"
+
+#endif // WORK_STEALING_DEQUE_HPP
@@ -0,0 +1,169 @@
+/**
+ * Copyright (c) 2018, Adrien Devresse <adrien.devresse@epfl.ch>
+ *
+ * Boost Software License - Version 1.0
+ *
+ * Permission is hereby granted, free of charge, to any person or organization
+ * obtaining a copy of the software and accompanying documentation covered by
+ * this license (the "Software") to use, reproduce, display, distribute,
+ * execute, and transmit the Software, and to prepare derivative works of the
+ * Software, and to permit third-parties to whom the Software is furnished to
+ * do so, all subject to the following:
+ *
+ * The copyright notices in the Software and this entire statement, including
+ * the above license grant, this restriction and the following disclaimer,
+ * must be included in all copies of the Software, in whole or in part, and
+ * all derivative works of the Software, unless such copies or derivative
+ * works are solely in the form of machine-executable object code generated by
+ * a source language processor.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+ * SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+ * FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ *
+ */
+#ifndef _HADOKEN_EXECUTOR_COROUTINE_BITS_HPP_
+#define _HADOKEN_EXECUTOR_COROUTINE_BITS_HPP_
+
+#include "../coroutine.hpp"
+
+namespace hadoken {
+
+
+inline frame_allocator::frame_allocator() noexcept : _lock() {
+    for (std::size_t i = 0; i < n_size_class; ++i) {
+        _heads[i] = nullptr;
+        _counts[i] = 0;
+    }
+}
+
+inline frame_allocator::~frame_allocator() {
+    for (std::size_t i = 0; i < n_size_class; ++i) {
+        while (_heads[i] != nullptr) {
+            free_block* block = _heads[i];
+            _heads[i] = block->next;
+            ::operator delete(static_cast<void*>(block));
+        }
+    }
+}
+
+inline void* frame_allocator::allocate(std::size_t size) {
+    const std::size_t size_class = _size_class(size);
+    if (size_class >= n_size_class) {
+        return ::operator new(size);
+    }
+
+    {
+        std::lock_guard<thread::spin_lock> lock(_lock);
+        free_block* block = _heads[size_class];
+        if (block != nullptr) {
+            _heads[size_class] = block->next;
+            _counts[size_class] -= 1;
+            return static_cast<void*>(block);
+        }
+    }
+    return ::operator new(min_frame_size << size_class);
+}
+
+inline void frame_allocator::deallocate(void* ptr, std::size_t size) noexcept {
+    const std::size_t size_class = _size_class(size);
+    if (size_class < n_size_class) {
+        std::lock_guard<thread::spin_lock> lock(_lock);
+        if (_counts[size_class] < max_cached_frames) {
+            free_block* block = ::new (ptr) free_block;
+            block->next = _heads[size_class];
+            _heads[size_class] = block;
+            _counts[size_class] += 1;
+            return;
+        }
+    }
+    ::operator delete(ptr);
+}
+
+inline std::size_t frame_allocator::cached_frames() const noexcept {
+    std::lock_guard<thread::spin_lock> lock(_lock);
+
+    std::size_t res = 0;
+    for (std::size_t i = 0; i < n_size_class; ++i) {
+        res += _counts[i];
+    }
+    return res;
+}
+
+inline std::size_t frame_allocator::_size_class(std::size_t size) noexcept {
+    std::size_t size_class = 0;
+    while (size_class < n_size_class && (min_frame_size << size_class) < size) {
+        size_class += 1;
+    }
+    return size_class;
+}
+
+
+namespace details {
+
+inline void* allocate_frame(std::size_t size, frame_allocator* allocator) {
+    const std::size_t block_size = size + frame_prefix_size;
+    void* block = (allocator != nullptr) ? (allocator->allocate(block_size))
+                                         : (thread::details::block_cache::local_allocate(block_size));
+
+    *static_cast<frame_allocator**>(block) = allocator;
+    return static_cast<char*>(block) + frame_prefix_size;
+}
+
+inline void deallocate_frame(void* frame, std::size_t size) noexcept {
+    void* block = static_cast<char*>(frame) - frame_prefix_size;
+    const std::size_t block_size = size + frame_prefix_size;
+
+    frame_allocator* allocator = *static_cast<frame_allocator**>(block);
+    if (allocator != nullptr) {
+        allocator->deallocate(block, block_size);
+    } else {
+        thread::details::block_cache::local_deallocate(block, block_size);
+    }
+}
+
+
+template <typename T>
+inline task<T> task_promise<T>::get_return_object() noexcept {
+    return task<T>(std::coroutine_handle<task_promise<T>>::from_promise(*this));
+}
+
+inline task<void> task_promise<void>::get_return_object() noexcept {
+    return task<void>(std::coroutine_handle<task_promise<void>>::from_promise(*this));
+}
+
+
+template <typename T>
+inline detached_coroutine sync_wait_run(task<T>& t, thread::promise<T>& result) {
+    try {
+        if constexpr (std::is_void_v<T>) {
+            co_await t;
+            result.set_value();
+        } else {
+            result.set_value(co_await t);
+        }
+    } catch (...) {
+        result.set_exception(std::current_exception());
+    }
+}
+
+} // namespace details
+
+
+template <typename T>
+inline T sync_wait(task<T> t) {
+    thread::promise<T> result;
+    thread::future<T> res = result.get_future();
+
+    details::sync_wait_run(t, result);
+    return res.get();
+}
+
+
+} // namespace hadoken
+
+#endif // _HADOKEN_EXECUTOR_COROUTINE_BITS_HPP_
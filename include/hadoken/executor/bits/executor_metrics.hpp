@@ -0,0 +1,379 @@
+/**
+ * Copyright (c) 2018, Adrien Devresse <adrien.devresse@epfl.ch>
+ *
+ * Boost Software License - Version 1.0
+ *
+ * Permission is hereby granted, free of charge, to any person or organization
+ * obtaining a copy of the software and accompanying documentation covered by
+ * this license (the "Software") to use, reproduce, display, distribute,
+ * execute, and transmit the Software, and to prepare derivative works of the
+ * Software, and to permit third-parties to whom the Software is furnished to
+ * do so, all subject to the following:
+ *
+ * The copyright notices in the Software and this entire statement, including
+ * the above license grant, this restriction and the following disclaimer,
+ * must be included in all copies of the Software, in whole or in part, and
+ * all derivative works of the Software, unless such copies or derivative
+ * works are solely in the form of machine-executable object code generated by
+ * a source language processor.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+ * SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+ * FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ *
+ */
+#ifndef _HADOKEN_EXECUTOR_METRICS_HPP_
+#define _HADOKEN_EXECUTOR_METRICS_HPP_
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+
+namespace hadoken {
+
+///
+/// distribution of durations in nanoseconds, by power of two
+///
+/// bucket 0 counts the value 0, bucket i the values in [2^(i-1), 2^i)
+///
+struct histogram_snapshot {
+    static constexpr std::size_t n_buckets = 64;
+
+    inline histogram_snapshot() : buckets(), sum(0) {}
+
+    std::array<std::uint64_t, n_buckets> buckets;
+
+    /// sum of the recorded values
+    std::uint64_t sum;
+
+    inline std::uint64_t count() const {
+        std::uint64_t res = 0;
+        for (std::uint64_t b : buckets) {
+            res += b;
+        }
+        return res;
+    }
+
+    inline double mean() const {
+        const std::uint64_t n = count();
+        return (n == 0) ? (0.0) : (double(sum) / double(n));
+    }
+
+    /// upper bound of the bucket containing the p quantile, p in [0, 1]
+    inline std::uint64_t percentile(double p) const {
+        const std::uint64_t n = count();
+        if (n == 0) {
+            return 0;
+        }
+
+        const std::uint64_t rank = static_cast<std::uint64_t>(p * double(n - 1)) + 1;
+        std::uint64_t seen = 0;
+        for (std::size_t i = 0; i < n_buckets; ++i) {
+            seen += buckets[i];
+            if (seen >= rank) {
+                return (i == 0) ? (0) : ((std::uint64_t(1) << i) - 1);
+            }
+        }
+        return UINT64_MAX;
+    }
+
+    inline void merge(const histogram_snapshot& other) {
+        for (std::size_t i = 0; i < n_buckets; ++i) {
+            buckets[i] += other.buckets[i];
+        }
+        sum += other.sum;
+    }
+};
+
+
+///
+/// lock-free log2 histogram with a single writer, readable by any thread at any time
+///
+class log2_histogram {
+  public:
+    inline log2_histogram() noexcept : _sum(0) {
+        for (auto& b : _buckets) {
+            b.store(0, std::memory_order_relaxed);
+        }
+    }
+
+    /// writer thread only
+    inline void record(std::uint64_t value) noexcept {
+        std::atomic<std::uint64_t>& bucket = _buckets[_bucket_of(value)];
+        bucket.store(bucket.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        _sum.store(_sum.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+    }
+
+    inline histogram_snapshot snapshot() const noexcept {
+        histogram_snapshot res;
+        for (std::size_t i = 0; i < histogram_snapshot::n_buckets; ++i) {
+            res.buckets[i] = _buckets[i].load(std::memory_order_relaxed);
+        }
+        res.sum = _sum.load(std::memory_order_relaxed);
+        return res;
+    }
+
+  private:
+    static inline std::size_t _bucket_of(std::uint64_t value) noexcept {
+        return (value == 0) ? (0) : (std::size_t(64 - __builtin_clzll(value)) % histogram_snapshot::n_buckets);
+    }
+
+    std::array<std::atomic<std::uint64_t>, histogram_snapshot::n_buckets> _buckets;
+    std::atomic<std::uint64_t> _sum;
+};
+
+
+///
+/// activity of a worker of a thread pool, durations in nanoseconds
+///
+struct worker_metrics {
+    inline worker_metrics() : worker_id(0), tasks(0), busy_time(0), elapsed_time(0), steals(0), parks(0) {}
+
+    std::size_t worker_id;
+
+    /// number of tasks executed
+    std::uint64_t tasks;
+
+    /// time spent executing tasks, tasks executed while waiting on a future are not counted twice
+    std::uint64_t busy_time;
+
+    /// time since the start of the worker
+    std::uint64_t elapsed_time;
+
+    /// number of tasks stolen from other workers
+    std::uint64_t steals;
+
+    /// number of times the worker parked without work
+    std::uint64_t parks;
+
+    /// time between the submission and the start of the tasks
+    histogram_snapshot queue_latency;
+
+    /// execution time of the tasks
+    histogram_snapshot run_time;
+
+    /// busy ratio, between 0 and 1
+    inline double utilization() const { return (elapsed_time == 0) ? (0.0) : (double(busy_time) / double(elapsed_time)); }
+};
+
+
+///
+/// snapshot of the metrics of a thread pool
+///
+/// collected only when HADOKEN_EXECUTOR_METRICS is defined, enabled is false otherwise
+///
+struct executor_metrics {
+    inline executor_metrics() : enabled(false), pending_tasks(0), workers() {}
+
+    bool enabled;
+
+    /// tasks submitted and not completed, queued or running
+    std::size_t pending_tasks;
+
+    std::vector<worker_metrics> workers;
+
+    inline std::uint64_t tasks() const {
+        std::uint64_t res = 0;
+        for (const worker_metrics& w : workers) {
+            res += w.tasks;
+        }
+        return res;
+    }
+
+    /// busy ratio of the whole pool, between 0 and 1
+    inline double utilization() const {
+        std::uint64_t busy = 0, elapsed = 0;
+        for (const worker_metrics& w : workers) {
+            busy += w.busy_time;
+            elapsed += w.elapsed_time;
+        }
+        return (elapsed == 0) ? (0.0) : (double(busy) / double(elapsed));
+    }
+
+    inline histogram_snapshot queue_latency() const {
+        histogram_snapshot res;
+        for (const worker_metrics& w : workers) {
+            res.merge(w.queue_latency);
+        }
+        return res;
+    }
+
+    inline histogram_snapshot run_time() const {
+        histogram_snapshot res;
+        for (const worker_metrics& w : workers) {
+            res.merge(w.run_time);
+        }
+        return res;
+    }
+};
+
+
+namespace details {
+
+inline std::uint64_t metrics_timestamp() noexcept {
+    return static_cast<std::uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+
+#ifdef HADOKEN_EXECUTOR_METRICS
+
+///
+/// counters of a worker, written by the worker only
+///
+class worker_metrics_recorder {
+  public:
+    static constexpr bool enabled = true;
+
+    inline worker_metrics_recorder() noexcept
+        : _tasks(0), _busy_time(0), _steals(0), _parks(0), _start_time(0), _depth(0), _queue_latency(), _run_time() {}
+
+    /// bind the recorder to the current thread
+    inline void begin_recording() noexcept {
+        _start_time.store(metrics_timestamp(), std::memory_order_relaxed);
+        _current() = this;
+    }
+
+    inline void count_steal() noexcept { _increment(_steals, 1); }
+
+    inline void count_park() noexcept { _increment(_parks, 1); }
+
+    /// recorder of the current worker thread, nullptr for other threads
+    static inline worker_metrics_recorder* current() noexcept { return _current(); }
+
+    // accounting of a task execution
+    class task_scope {
+      public:
+        inline task_scope(worker_metrics_recorder& recorder, std::uint64_t enqueue_time) noexcept
+            : _recorder(recorder), _start(metrics_timestamp()) {
+            _recorder._queue_latency.record((_start > enqueue_time) ? (_start - enqueue_time) : (0));
+            _recorder._depth += 1;
+        }
+
+        inline ~task_scope() {
+            const std::uint64_t run_time = metrics_timestamp() - _start;
+            _recorder._depth -= 1;
+            _recorder._run_time.record(run_time);
+            _recorder._increment(_recorder._tasks, 1);
+
+            // tasks executed while helping are already accounted by the outer task
+            if (_recorder._depth == 0) {
+                _recorder._increment(_recorder._busy_time, run_time);
+            }
+        }
+
+      private:
+        task_scope(const task_scope&) = delete;
+        task_scope& operator=(const task_scope&) = delete;
+
+        worker_metrics_recorder& _recorder;
+        std::uint64_t _start;
+    };
+
+    inline worker_metrics snapshot(std::size_t worker_id) const {
+        worker_metrics res;
+        res.worker_id = worker_id;
+        res.tasks = _tasks.load(std::memory_order_relaxed);
+        res.busy_time = _busy_time.load(std::memory_order_relaxed);
+        res.steals = _steals.load(std::memory_order_relaxed);
+        res.parks = _parks.load(std::memory_order_relaxed);
+
+        const std::uint64_t start_time = _start_time.load(std::memory_order_relaxed);
+        res.elapsed_time = (start_time == 0) ? (0) : (metrics_timestamp() - start_time);
+
+        res.queue_latency = _queue_latency.snapshot();
+        res.run_time = _run_time.snapshot();
+        return res;
+    }
+
+  private:
+    static inline worker_metrics_recorder*& _current() noexcept {
+        static thread_local worker_metrics_recorder* recorder = nullptr;
+        return recorder;
+    }
+
+    // single writer: no read-modify-write operation needed
+    static inline void _increment(std::atomic<std::uint64_t>& counter, std::uint64_t value) noexcept {
+        counter.store(counter.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+    }
+
+    // counters of different workers on different cache lines
+    char _pad_begin[64];
+
+    std::atomic<std::uint64_t> _tasks, _busy_time, _steals, _parks, _start_time;
+    std::size_t _depth;
+
+    log2_histogram _queue_latency, _run_time;
+
+    char _pad_end[64];
+};
+
+
+// task tagged with its submission time
+template <typename Function>
+class timestamped_task {
+  public:
+    template <typename Fun>
+    explicit inline timestamped_task(Fun&& func) : _func(std::forward<Fun>(func)), _enqueue_time(metrics_timestamp()) {}
+
+    inline void operator()() {
+        worker_metrics_recorder* recorder = worker_metrics_recorder::current();
+        if (recorder == nullptr) {
+            _func();
+            return;
+        }
+
+        worker_metrics_recorder::task_scope scope(*recorder, _enqueue_time);
+        _func();
+    }
+
+  private:
+    Function _func;
+    std::uint64_t _enqueue_time;
+};
+
+
+template <typename Function>
+inline timestamped_task<typename std::decay<Function>::type> instrument_task(Function&& func) {
+    return timestamped_task<typename std::decay<Function>::type>(std::forward<Function>(func));
+}
+
+#else
+
+// metrics disabled: empty base class of the workers, everything compiles away
+class worker_metrics_recorder {
+  public:
+    static constexpr bool enabled = false;
+
+    inline void begin_recording() noexcept {}
+
+    inline void count_steal() noexcept {}
+
+    inline void count_park() noexcept {}
+
+    inline worker_metrics snapshot(std::size_t) const { return worker_metrics(); }
+};
+
+
+template <typename Function>
+inline Function&& instrument_task(Function&& func) noexcept {
+    return std::forward<Function>(func);
+}
+
+#endif
+
+} // namespace details
+
+} // namespace hadoken
+
+#endif // _HADOKEN_EXECUTOR_METRICS_HPP_
@@ -0,0 +1,259 @@
+/**
+ * Copyright (c) 2018, Adrien Devresse <adrien.devresse@epfl.ch>
+ *
+ * Boost Software License - Version 1.0
+ *
+ * Permission is hereby granted, free of charge, to any person or organization
+ * obtaining a copy of the software and accompanying documentation covered by
+ * this license (the "Software") to use, reproduce, display, distribute,
+ * execute, and transmit the Software, and to prepare derivative works of the
+ * Software, and to permit third-parties to whom the Software is furnished to
+ * do so, all subject to the following:
+ *
+ * The copyright notices in the Software and this entire statement, including
+ * the above license grant, this restriction and the following disclaimer,
+ * must be included in all copies of the Software, in whole or in part, and
+ * all derivative works of the Software, unless such copies or derivative
+ * works are solely in the form of machine-executable object code generated by
+ * a source language processor.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+ * SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+ * FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ *
+ */
+#ifndef _HADOKEN_PRIORITY_LANES_HPP_
+#define _HADOKEN_PRIORITY_LANES_HPP_
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+#include <hadoken/executor/unique_task.hpp>
+#include <hadoken/utility/optional.hpp>
+
+
+namespace hadoken {
+
+///
+/// priority of a task submitted to a thread pool
+///
+enum class task_priority : std::size_t { high = 0, normal = 1, low = 2 };
+
+
+///
+/// statistics of a priority lane
+///
+struct priority_lane_stats {
+    /// number of tasks queued in the lane
+    std::size_t depth;
+
+    /// number of tasks dequeued from the lane since creation
+    std::size_t executed;
+
+    /// number of tasks dequeued before the tasks of a higher priority lane, by aging
+    std::size_t aged;
+
+    /// queueing time of the dequeued tasks
+    std::chrono::nanoseconds total_wait, max_wait;
+
+    inline std::chrono::nanoseconds mean_wait() const {
+        using rep = std::chrono::nanoseconds::rep;
+        return (executed > 0) ? (total_wait / static_cast<rep>(executed)) : (std::chrono::nanoseconds(0));
+    }
+};
+
+
+namespace details {
+
+///
+/// fixed set of priority lanes, one mutex per lane
+///
+/// each lane is a heap ordered by effective deadline, then by submission order:
+/// the effective deadline of a task is its deadline, bounded by its submission time
+/// plus the aging threshold at submission. Tasks are executed earliest deadline first,
+/// and a task can not be overtaken by tasks with an earlier deadline for longer than
+/// the aging threshold: tasks without deadline do not starve
+///
+/// a task waiting for longer than the aging threshold is dequeued before
+/// the tasks of higher priority lanes: low priority tasks can not starve
+///
+class priority_lanes {
+  public:
+    using clock = std::chrono::steady_clock;
+
+    static constexpr std::size_t n_lanes = 3;
+
+    inline priority_lanes()
+        : _lanes(), _size(0), _sequence(0),
+          _aging_threshold(std::chrono::duration_cast<clock::duration>(std::chrono::milliseconds(100)).count()) {}
+
+    inline void push(unique_task task, task_priority prio, clock::time_point deadline = clock::time_point::max());
+
+    ///
+    /// \brief dequeue the task of highest priority, aged tasks first
+    ///
+    /// if urgent_only is true, only tasks of the high lane and aged tasks are considered
+    ///
+    inline optional<unique_task> try_pop(bool urgent_only = false);
+
+    inline bool empty() const { return _size.load() == 0; }
+
+    inline priority_lane_stats stats(task_priority prio) const;
+
+    inline void set_aging_threshold(clock::duration threshold) { _aging_threshold.store(threshold.count()); }
+
+    inline clock::duration get_aging_threshold() const { return clock::duration(_aging_threshold.load()); }
+
+  private:
+    struct entry {
+        unique_task task;
+        clock::time_point enqueue_time, deadline;
+        std::uint64_t sequence;
+    };
+
+    // heap order: the top is the earliest effective deadline, then the oldest submission
+    struct entry_after {
+        inline bool operator()(const entry& e1, const entry& e2) const {
+            return (e1.deadline != e2.deadline) ? (e1.deadline > e2.deadline) : (e1.sequence > e2.sequence);
+        }
+    };
+
+    struct lane {
+        inline lane() : lock(), heap(), depth(0), executed(0), aged(0), total_wait(0), max_wait(0) {}
+
+        mutable std::mutex lock;
+        std::vector<entry> heap;
+        std::atomic<std::size_t> depth;
+        std::size_t executed, aged;
+        clock::duration total_wait, max_wait;
+    };
+
+    inline bool _has_work_above(std::size_t lane_index) const {
+        for (std::size_t i = 0; i < lane_index; ++i) {
+            if (_lanes[i].depth.load() != 0) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    inline optional<unique_task> _pop_from(lane& l, clock::time_point now, bool aged_only, clock::duration threshold);
+
+    std::array<lane, n_lanes> _lanes;
+    std::atomic<std::size_t> _size;
+    std::atomic<std::uint64_t> _sequence;
+    std::atomic<clock::rep> _aging_threshold;
+};
+
+
+inline void priority_lanes::push(unique_task task, task_priority prio, clock::time_point deadline) {
+    lane& l = _lanes[std::min(static_cast<std::size_t>(prio), n_lanes - 1)];
+
+    const clock::time_point now = clock::now();
+    const clock::duration threshold = get_aging_threshold();
+
+    // effective deadline, without overflow for the tasks without deadline
+    const clock::time_point effective_deadline = (threshold < deadline - now) ? (now + threshold) : (deadline);
+
+    entry e{std::move(task), now, effective_deadline, _sequence.fetch_add(1, std::memory_order_relaxed)};
+
+    std::lock_guard<std::mutex> guard(l.lock);
+    l.heap.push_back(std::move(e));
+    std::push_heap(l.heap.begin(), l.heap.end(), entry_after());
+    l.depth.fetch_add(1);
+    _size.fetch_add(1);
+}
+
+inline optional<unique_task> priority_lanes::try_pop(bool urgent_only) {
+    if (empty()) {
+        return optional<unique_task>();
+    }
+
+    const clock::time_point now = clock::now();
+    const clock::duration threshold = get_aging_threshold();
+
+    // starvation protection: aged tasks of the lower lanes first, lowest lane first,
+    // only relevant if a lane of higher priority has work
+    for (std::size_t i = n_lanes - 1; i > 0; --i) {
+        if (_has_work_above(i) == false) {
+            continue;
+        }
+        optional<unique_task> res = _pop_from(_lanes[i], now, true, threshold);
+        if (res) {
+            return res;
+        }
+    }
+
+    const std::size_t last_lane = (urgent_only) ? (1) : (n_lanes);
+    for (std::size_t i = 0; i < last_lane; ++i) {
+        optional<unique_task> res = _pop_from(_lanes[i], now, false, threshold);
+        if (res) {
+            return res;
+        }
+    }
+    return optional<unique_task>();
+}
+
+inline optional<unique_task> priority_lanes::_pop_from(lane& l, clock::time_point now, bool aged_only,
+                                                       clock::duration threshold) {
+    optional<unique_task> res;
+
+    // lock-free check, most lanes are empty most of the time
+    if (l.depth.load() == 0) {
+        return res;
+    }
+
+    std::lock_guard<std::mutex> guard(l.lock);
+    if (l.heap.empty()) {
+        return res;
+    }
+
+    const clock::duration wait = now - l.heap.front().enqueue_time;
+    const bool aged = (wait > threshold);
+    if (aged_only && aged == false) {
+        return res;
+    }
+
+    std::pop_heap(l.heap.begin(), l.heap.end(), entry_after());
+    res = std::move(l.heap.back().task);
+    l.heap.pop_back();
+
+    l.depth.fetch_sub(1);
+    _size.fetch_sub(1);
+
+    l.executed += 1;
+    l.aged += (aged_only) ? (1) : (0);
+    l.total_wait += std::max(wait, clock::duration(0));
+    l.max_wait = std::max(l.max_wait, wait);
+    return res;
+}
+
+inline priority_lane_stats priority_lanes::stats(task_priority prio) const {
+    const lane& l = _lanes[std::min(static_cast<std::size_t>(prio), n_lanes - 1)];
+
+    std::lock_guard<std::mutex> guard(l.lock);
+
+    priority_lane_stats res;
+    res.depth = l.heap.size();
+    res.executed = l.executed;
+    res.aged = l.aged;
+    res.total_wait = std::chrono::duration_cast<std::chrono::nanoseconds>(l.total_wait);
+    res.max_wait = std::chrono::duration_cast<std::chrono::nanoseconds>(l.max_wait);
+    return res;
+}
+
+
+} // namespace details
+
+} // namespace hadoken
+
+#endif // _HADOKEN_PRIORITY_LANES_HPP_
@@ -0,0 +1,373 @@
+/**
+ * Copyright (c) 2018, Adrien Devresse <adrien.devresse@epfl.ch>
+ *
+ * Boost Software License - Version 1.0
+ *
+ * Permission is hereby granted, free of charge, to any person or organization
+ * obtaining a copy of the software and accompanying documentation covered by
+ * this license (the "Software") to use, reproduce, display, distribute,
+ * execute, and transmit the Software, and to prepare derivative works of the
+ * Software, and to permit third-parties to whom the Software is furnished to
+ * do so, all subject to the following:
+ *
+ * The copyright notices in the Software and this entire statement, including
+ * the above license grant, this restriction and the following disclaimer,
+ * must be included in all copies of the Software, in whole or in part, and
+ * all derivative works of the Software, unless such copies or derivative
+ * works are solely in the form of machine-executable object code generated by
+ * a source language processor.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+ * SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+ * FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ *
+ */
+#ifndef _HADOKEN_TIMING_WHEEL_HPP_
+#define _HADOKEN_TIMING_WHEEL_HPP_
+
+#include <array>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <vector>
+
+#include <hadoken/executor/unique_task.hpp>
+
+
+namespace hadoken {
+
+namespace details {
+
+///
+/// hierarchical timing wheel, not thread-safe
+///
+/// 4 levels of 256 slots: level l covers 256^(l+1) ticks, timers further away
+/// are re-inserted each time their last level slot expires
+///
+/// - insert and cancel are O(1)
+/// - timers live in a slab of nodes linked by index, with a generation counter
+///   to detect stale handles
+/// - a bitmap of occupied slots gives the next tick with work, the wheel can
+///   jump directly to it
+///
+class timing_wheel {
+  public:
+    using tick_type = std::uint64_t;
+
+    static constexpr std::size_t n_levels = 4;
+    static constexpr std::size_t slot_bits = 8;
+    static constexpr std::size_t n_slots = std::size_t(1) << slot_bits;
+
+    static constexpr tick_type no_event = std::numeric_limits<tick_type>::max();
+
+    struct handle {
+        std::uint32_t index, generation;
+    };
+
+    inline timing_wheel();
+
+    /// last processed tick
+    inline tick_type current_tick() const { return _current; }
+
+    /// number of pending timers
+    inline std::size_t size() const { return _size; }
+
+    ///
+    /// \brief add a timer expiring at tick expiry, repeated every period ticks if period > 0
+    ///
+    /// a timer expiring before current_tick() + 1 expires at current_tick() + 1
+    ///
+    inline handle insert(tick_type expiry, unique_task task, tick_type period = 0);
+
+    /// remove a pending timer, return false if it already expired or was cancelled
+    inline bool cancel(const handle& h);
+
+    ///
+    /// \brief process every tick up to target, sink(unique_task&&) receives the expired tasks
+    ///
+    /// periodic timers are re-armed, their sink task calls a shared callable
+    ///
+    template <typename Sink>
+    inline void advance(tick_type target, Sink&& sink);
+
+    /// first tick with an expiry or a cascade, no_event if the wheel is empty
+    inline tick_type next_event() const;
+
+  private:
+    static constexpr std::uint32_t npos = std::numeric_limits<std::uint32_t>::max();
+    static constexpr std::uint32_t unlinked = std::numeric_limits<std::uint32_t>::max();
+    static constexpr std::size_t bitmap_words = n_slots / 64;
+
+    struct node {
+        std::uint32_t prev, next;
+        std::uint32_t generation;
+        std::uint32_t slot;
+        tick_type expiry, period;
+        unique_task task;
+        std::shared_ptr<unique_task> periodic_task;
+    };
+
+    // callable dispatched at each period of a periodic timer
+    struct periodic_call {
+        std::shared_ptr<unique_task> task;
+
+        inline void operator()() { (*task)(); }
+    };
+
+    inline std::uint32_t _allocate_node();
+
+    inline void _release_node(std::uint32_t index);
+
+    inline void _link(std::uint32_t index);
+
+    inline void _unlink(std::uint32_t index);
+
+    inline std::uint32_t _detach_slot(std::uint32_t slot);
+
+    template <typename Sink>
+    inline void _process_tick(Sink& sink);
+
+    // distance to the first occupied slot after idx at level, 1 to n_slots, 0 if empty
+    inline std::size_t _next_occupied(std::size_t level, std::size_t idx) const;
+
+    std::vector<node> _nodes;
+    std::uint32_t _free_head;
+    std::array<std::uint32_t, n_levels * n_slots> _heads;
+    std::array<std::uint64_t, n_levels * bitmap_words> _occupied;
+    std::array<std::size_t, n_levels> _level_size;
+    tick_type _current;
+    std::size_t _size;
+};
+
+
+inline timing_wheel::timing_wheel() : _nodes(), _free_head(npos), _heads(), _occupied(), _level_size(), _current(0), _size(0) {
+    _heads.fill(std::uint32_t(npos));
+    _occupied.fill(0);
+    _level_size.fill(0);
+}
+
+inline timing_wheel::handle timing_wheel::insert(tick_type expiry, unique_task task, tick_type period) {
+    const std::uint32_t index = _allocate_node();
+    node& n = _nodes[index];
+
+    n.expiry = std::max(expiry, _current + 1);
+    n.period = period;
+    if (period > 0) {
+        n.periodic_task = std::make_shared<unique_task>(std::move(task));
+    } else {
+        n.task = std::move(task);
+    }
+
+    _link(index);
+    _size += 1;
+    return handle{index, n.generation};
+}
+
+inline bool timing_wheel::cancel(const handle& h) {
+    if (h.index >= _nodes.size()) {
+        return false;
+    }
+
+    node& n = _nodes[h.index];
+    if (n.generation != h.generation || n.slot == unlinked) {
+        return false;
+    }
+
+    _unlink(h.index);
+    _release_node(h.index);
+    _size -= 1;
+    return true;
+}
+
+template <typename Sink>
+inline void timing_wheel::advance(tick_type target, Sink&& sink) {
+    while (_current < target) {
+        const tick_type next = next_event();
+        if (next > target) {
+            // nothing happens in between: jump
+            _current = target;
+            break;
+        }
+        _current = next;
+        _process_tick(sink);
+    }
+}
+
+inline timing_wheel::tick_type timing_wheel::next_event() const {
+    tick_type res = no_event;
+
+    for (std::size_t level = 0; level < n_levels; ++level) {
+        if (_level_size[level] == 0) {
+            continue;
+        }
+
+        const std::size_t shift = level * slot_bits;
+        const tick_type base = _current >> shift;
+        const std::size_t distance = _next_occupied(level, static_cast<std::size_t>(base & (n_slots - 1)));
+        if (distance > 0) {
+            res = std::min(res, (base + distance) << shift);
+        }
+    }
+    return res;
+}
+
+inline std::uint32_t timing_wheel::_allocate_node() {
+    if (_free_head != npos) {
+        const std::uint32_t index = _free_head;
+        _free_head = _nodes[index].next;
+        return index;
+    }
+
+    _nodes.emplace_back();
+    node& n = _nodes.back();
+    n.prev = n.next = npos;
+    n.generation = 0;
+    n.slot = unlinked;
+    return static_cast<std::uint32_t>(_nodes.size() - 1);
+}
+
+inline void timing_wheel::_release_node(std::uint32_t index) {
+    node& n = _nodes[index];
+    n.task.reset();
+    n.periodic_task.reset();
+    n.generation += 1;
+    n.slot = unlinked;
+    n.prev = npos;
+    n.next = _free_head;
+    _free_head = index;
+}
+
+inline void timing_wheel::_link(std::uint32_t index) {
+    node& n = _nodes[index];
+
+    const tick_type delta = (n.expiry > _current) ? (n.expiry - _current) : (0);
+
+    std::size_t level = 0;
+    while (level + 1 < n_levels && delta >= (tick_type(1) << ((level + 1) * slot_bits))) {
+        level += 1;
+    }
+
+    // beyond the last level: park in the furthest slot, re-inserted when it expires
+    const tick_type max_delta = (tick_type(1) << (n_levels * slot_bits)) - 1;
+    const tick_type position = (delta > max_delta) ? (_current + max_delta) : (n.expiry);
+
+    const std::size_t slot_index = static_cast<std::size_t>((position >> (level * slot_bits)) & (n_slots - 1));
+    const std::uint32_t slot = static_cast<std::uint32_t>(level * n_slots + slot_index);
+
+    n.slot = slot;
+    n.prev = npos;
+    n.next = _heads[slot];
+    if (n.next != npos) {
+        _nodes[n.next].prev = index;
+    }
+    _heads[slot] = index;
+
+    _occupied[level * bitmap_words + slot_index / 64] |= (std::uint64_t(1) << (slot_index % 64));
+    _level_size[level] += 1;
+}
+
+inline void timing_wheel::_unlink(std::uint32_t index) {
+    node& n = _nodes[index];
+    const std::uint32_t slot = n.slot;
+
+    if (n.prev != npos) {
+        _nodes[n.prev].next = n.next;
+    } else {
+        _heads[slot] = n.next;
+    }
+    if (n.next != npos) {
+        _nodes[n.next].prev = n.prev;
+    }
+
+    const std::size_t level = slot / n_slots;
+    if (_heads[slot] == npos) {
+        const std::size_t slot_index = slot % n_slots;
+        _occupied[level * bitmap_words + slot_index / 64] &= ~(std::uint64_t(1) << (slot_index % 64));
+    }
+    _level_size[level] -= 1;
+
+    n.slot = unlinked;
+    n.prev = n.next = npos;
+}
+
+inline std::uint32_t timing_wheel::_detach_slot(std::uint32_t slot) {
+    const std::uint32_t first = _heads[slot];
+    const std::size_t level = slot / n_slots;
+    const std::size_t slot_index = slot % n_slots;
+
+    std::size_t count = 0;
+    for (std::uint32_t i = first; i != npos; i = _nodes[i].next) {
+        _nodes[i].slot = unlinked;
+        count += 1;
+    }
+
+    _heads[slot] = npos;
+    _occupied[level * bitmap_words + slot_index / 64] &= ~(std::uint64_t(1) << (slot_index % 64));
+    _level_size[level] -= count;
+    return first;
+}
+
+template <typename Sink>
+inline void timing_wheel::_process_tick(Sink& sink) {
+    // cascade the slots of the upper levels starting at this tick, highest level first
+    for (std::size_t level = n_levels - 1; level > 0; --level) {
+        const std::size_t shift = level * slot_bits;
+        if ((_current & ((tick_type(1) << shift) - 1)) != 0) {
+            continue;
+        }
+
+        const std::uint32_t slot = static_cast<std::uint32_t>(level * n_slots + ((_current >> shift) & (n_slots - 1)));
+        std::uint32_t i = _detach_slot(slot);
+        while (i != npos) {
+            const std::uint32_t next = _nodes[i].next;
+            _link(i);
+            i = next;
+        }
+    }
+
+    // expire the current slot of the first level
+    std::uint32_t i = _detach_slot(static_cast<std::uint32_t>(_current & (n_slots - 1)));
+    while (i != npos) {
+        node& n = _nodes[i];
+        const std::uint32_t next = n.next;
+
+        if (n.period > 0) {
+            sink(unique_task(periodic_call{n.periodic_task}));
+
+            // re-armed on the period grid, missed periods are skipped
+            const tick_type missed = (_current - n.expiry) / n.period + 1;
+            n.expiry += missed * n.period;
+            _link(i);
+        } else {
+            sink(std::move(n.task));
+            _release_node(i);
+            _size -= 1;
+        }
+        i = next;
+    }
+}
+
+inline std::size_t timing_wheel::_next_occupied(std::size_t level, std::size_t idx) const {
+    const std::uint64_t* bitmap = &_occupied[level * bitmap_words];
+
+    for (std::size_t distance = 1; distance <= n_slots;) {
+        const std::size_t position = (idx + distance) & (n_slots - 1);
+        const std::uint64_t word = bitmap[position / 64] >> (position % 64);
+        if (word != 0) {
+            return distance + static_cast<std::size_t>(__builtin_ctzll(word));
+        }
+        distance += 64 - (position % 64);
+    }
+    return 0;
+}
+
+
+} // namespace details
+
+} // namespace hadoken
+
+#endif // _HADOKEN_TIMING_WHEEL_HPP_
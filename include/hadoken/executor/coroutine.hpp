@@ -0,0 +1,408 @@
+/**
+ * Copyright (c) 2018, Adrien Devresse <adrien.devresse@epfl.ch>
+ *
+ * Boost Software License - Version 1.0
+ *
+ * Permission is hereby granted, free of charge, to any person or organization
+ * obtaining a copy of the software and accompanying documentation covered by
+ * this license (the "Software") to use, reproduce, display, distribute,
+ * execute, and transmit the Software, and to prepare derivative works of the
+ * Software, and to permit third-parties to whom the Software is furnished to
+ * do so, all subject to the following:
+ *
+ * The copyright notices in the Software and this entire statement, including
+ * the above license grant, this restriction and the following disclaimer,
+ * must be included in all copies of the Software, in whole or in part, and
+ * all derivative works of the Software, unless such copies or derivative
+ * works are solely in the form of machine-executable object code generated by
+ * a source language processor.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+ * SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+ * FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ *
+ */
+#ifndef _HADOKEN_EXECUTOR_COROUTINE_HPP_
+#define _HADOKEN_EXECUTOR_COROUTINE_HPP_
+
+//
+// C++20 coroutine support for the hadoken executors
+//
+// this header is empty when the compiler does not support coroutines,
+// HADOKEN_HAS_COROUTINES is defined otherwise
+//
+#if defined(__cpp_impl_coroutine) && (__cplusplus >= 202002L)
+
+#include <coroutine>
+#include <cstddef>
+#include <exception>
+#include <mutex>
+#include <new>
+#include <optional>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+#include <hadoken/thread/future.hpp>
+#include <hadoken/thread/spinlock.hpp>
+
+#define HADOKEN_HAS_COROUTINES 1
+
+
+namespace hadoken {
+
+template <typename T = void>
+class task;
+
+
+///
+/// \brief allocator of coroutine frames, typically one per executor
+///
+/// released frames are kept per size class and reused, a frame can be released by any thread
+///
+/// a coroutine returning a task allocates its frame from a frame_allocator when
+/// its first parameter, after the object for a member function, is a frame_allocator&
+///     task<int> compute(frame_allocator& alloc, int value);
+///
+/// the allocator must outlive every frame allocated from it
+/// other coroutines use the per-thread block cache of hadoken::thread::future
+///
+class frame_allocator {
+  public:
+    /// size classes from 64 to 8192 bytes, larger frames go to operator new
+    static constexpr std::size_t n_size_class = 8;
+    static constexpr std::size_t min_frame_size = 64;
+
+    /// maximum number of free frames kept per size class
+    static constexpr std::size_t max_cached_frames = 1024;
+
+    inline frame_allocator() noexcept;
+
+    inline ~frame_allocator();
+
+    inline void* allocate(std::size_t size);
+
+    inline void deallocate(void* ptr, std::size_t size) noexcept;
+
+    /// number of free frames ready for reuse
+    inline std::size_t cached_frames() const noexcept;
+
+  private:
+    frame_allocator(const frame_allocator&) = delete;
+    frame_allocator& operator=(const frame_allocator&) = delete;
+
+    struct free_block {
+        free_block* next;
+    };
+
+    static inline std::size_t _size_class(std::size_t size) noexcept;
+
+    mutable thread::spin_lock _lock;
+    free_block* _heads[n_size_class];
+    std::size_t _counts[n_size_class];
+};
+
+
+namespace details {
+
+// frames are prefixed by the allocator they come from, nullptr for the block cache
+// the prefix keeps the default alignment of operator new
+constexpr std::size_t frame_prefix_size = __STDCPP_DEFAULT_NEW_ALIGNMENT__;
+
+inline void* allocate_frame(std::size_t size, frame_allocator* allocator);
+
+inline void deallocate_frame(void* frame, std::size_t size) noexcept;
+
+
+// executor on which a coroutine is resumed, type erased
+class resume_executor {
+  public:
+    template <typename Executor>
+    inline void set(Executor& executor) noexcept {
+        _executor = static_cast<void*>(&executor);
+        _schedule = [](void* exec, std::coroutine_handle<> handle) {
+            static_cast<Executor*>(exec)->execute([handle]() { handle.resume(); });
+        };
+    }
+
+    explicit inline operator bool() const noexcept { return _executor != nullptr; }
+
+    inline void schedule(std::coroutine_handle<> handle) const { _schedule(_executor, handle); }
+
+  private:
+    void* _executor = nullptr;
+    void (*_schedule)(void*, std::coroutine_handle<>) = nullptr;
+};
+
+
+class task_promise_base {
+  public:
+    struct final_awaiter {
+        inline bool await_ready() const noexcept { return false; }
+
+        template <typename Promise>
+        inline std::coroutine_handle<> await_suspend(std::coroutine_handle<Promise> handle) noexcept {
+            return handle.promise()._complete();
+        }
+
+        inline void await_resume() const noexcept {}
+    };
+
+    inline std::suspend_always initial_suspend() const noexcept { return {}; }
+
+    inline final_awaiter final_suspend() const noexcept { return {}; }
+
+    inline void unhandled_exception() noexcept { _error = std::current_exception(); }
+
+    inline void set_continuation(std::coroutine_handle<> continuation) noexcept { _continuation = continuation; }
+
+    template <typename Executor>
+    inline void set_resume_executor(Executor& executor) noexcept {
+        _resume.set(executor);
+    }
+
+    static inline void* operator new(std::size_t size) { return allocate_frame(size, nullptr); }
+
+    template <typename... Args>
+    static inline void* operator new(std::size_t size, frame_allocator& allocator, Args&...) {
+        return allocate_frame(size, &allocator);
+    }
+
+    // member function coroutines
+    template <typename Object, typename... Args>
+    static inline void* operator new(std::size_t size, Object&, frame_allocator& allocator, Args&...) {
+        return allocate_frame(size, &allocator);
+    }
+
+    static inline void operator delete(void* frame, std::size_t size) noexcept { deallocate_frame(frame, size); }
+
+  protected:
+    inline void _rethrow_if_error() const {
+        if (_error) {
+            std::rethrow_exception(_error);
+        }
+    }
+
+  private:
+    // next coroutine to execute once the task completed
+    inline std::coroutine_handle<> _complete() noexcept {
+        if (!_continuation) {
+            return std::noop_coroutine();
+        }
+
+        if (_resume) {
+            // the continuation can destroy this frame as soon as it is scheduled
+            const std::coroutine_handle<> continuation = _continuation;
+            try {
+                _resume.schedule(continuation);
+                return std::noop_coroutine();
+            } catch (...) {
+                // the executor refused the continuation: resume it inline
+                return continuation;
+            }
+        }
+        return _continuation;
+    }
+
+    std::coroutine_handle<> _continuation;
+    resume_executor _resume;
+    std::exception_ptr _error;
+};
+
+
+template <typename T>
+class task_promise : public task_promise_base {
+  public:
+    inline task<T> get_return_object() noexcept;
+
+    template <typename Value>
+    inline void return_value(Value&& value) {
+        _value.emplace(std::forward<Value>(value));
+    }
+
+    inline T result() {
+        _rethrow_if_error();
+        return std::move(*_value);
+    }
+
+  private:
+    std::optional<T> _value;
+};
+
+
+template <>
+class task_promise<void> : public task_promise_base {
+  public:
+    inline task<void> get_return_object() noexcept;
+
+    inline void return_void() noexcept {}
+
+    inline void result() { _rethrow_if_error(); }
+};
+
+
+// eagerly started coroutine destroying itself on completion
+struct detached_coroutine {
+    struct promise_type {
+        inline detached_coroutine get_return_object() const noexcept { return {}; }
+
+        inline std::suspend_never initial_suspend() const noexcept { return {}; }
+
+        inline std::suspend_never final_suspend() const noexcept { return {}; }
+
+        inline void return_void() const noexcept {}
+
+        inline void unhandled_exception() const noexcept { std::terminate(); }
+    };
+};
+
+} // namespace details
+
+
+///
+/// \brief awaitable transferring the execution of the awaiting coroutine to an executor
+///
+///     co_await schedule_on(pool);
+///     // executed by a worker of pool
+///
+template <typename Executor>
+class schedule_awaitable {
+  public:
+    explicit inline schedule_awaitable(Executor& executor) noexcept : _executor(&executor) {}
+
+    inline bool await_ready() const noexcept { return false; }
+
+    inline void await_suspend(std::coroutine_handle<> handle) {
+        // the coroutine can be resumed, and this awaitable destroyed, before execute() returns
+        _executor->execute([handle]() { handle.resume(); });
+    }
+
+    inline void await_resume() const noexcept {}
+
+  private:
+    Executor* _executor;
+};
+
+
+template <typename Executor>
+inline schedule_awaitable<Executor> schedule_on(Executor& executor) noexcept {
+    return schedule_awaitable<Executor>(executor);
+}
+
+
+///
+/// \brief lazy coroutine producing a T
+///
+/// the coroutine starts when the task is awaited, the awaiting coroutine is resumed
+/// when it completes: inline by default, or on the executor given to resume_on()
+///
+///     task<int> child();
+///     int value = co_await child().resume_on(pool);
+///
+/// exceptions escaping the coroutine are rethrown to the awaiting coroutine
+///
+template <typename T>
+class task {
+  public:
+    using promise_type = details::task_promise<T>;
+
+    class awaiter {
+      public:
+        explicit inline awaiter(std::coroutine_handle<promise_type> handle) noexcept : _handle(handle) {}
+
+        inline bool await_ready() const noexcept { return !_handle || _handle.done(); }
+
+        inline std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiting) noexcept {
+            _handle.promise().set_continuation(awaiting);
+            return _handle;
+        }
+
+        inline T await_resume() {
+            if (!_handle) {
+                throw std::logic_error("co_await on an empty hadoken::task");
+            }
+            return _handle.promise().result();
+        }
+
+      private:
+        std::coroutine_handle<promise_type> _handle;
+    };
+
+    inline task() noexcept : _handle() {}
+
+    inline task(task&& other) noexcept : _handle(std::exchange(other._handle, nullptr)) {}
+
+    inline task& operator=(task&& other) noexcept {
+        if (this != &other) {
+            _destroy();
+            _handle = std::exchange(other._handle, nullptr);
+        }
+        return *this;
+    }
+
+    task(const task&) = delete;
+    task& operator=(const task&) = delete;
+
+    inline ~task() { _destroy(); }
+
+    /// true if the task refers to a coroutine
+    inline bool valid() const noexcept { return static_cast<bool>(_handle); }
+
+    /// true if the coroutine completed
+    inline bool is_ready() const noexcept { return _handle && _handle.done(); }
+
+    ///
+    /// \brief resume the awaiting coroutine on executor, instead of the thread completing the task
+    ///
+    template <typename Executor>
+    inline task& resume_on(Executor& executor) & noexcept {
+        _handle.promise().set_resume_executor(executor);
+        return *this;
+    }
+
+    template <typename Executor>
+    inline task&& resume_on(Executor& executor) && noexcept {
+        _handle.promise().set_resume_executor(executor);
+        return std::move(*this);
+    }
+
+    inline awaiter operator co_await() const noexcept { return awaiter(_handle); }
+
+  private:
+    friend promise_type;
+
+    explicit inline task(std::coroutine_handle<promise_type> handle) noexcept : _handle(handle) {}
+
+    inline void _destroy() noexcept {
+        if (_handle) {
+            _handle.destroy();
+            _handle = nullptr;
+        }
+    }
+
+    std::coroutine_handle<promise_type> _handle;
+};
+
+
+///
+/// \brief start a task and block the calling thread until it completes
+/// \return the result of the task, or rethrow its exception
+///
+/// a worker of a hadoken thread pool executes other tasks of the pool meanwhile
+///
+template <typename T>
+inline T sync_wait(task<T> t);
+
+
+} // namespace hadoken
+
+
+#include "bits/coroutine_bits.hpp"
+
+#endif // coroutine support
+
+#endif // _HADOKEN_EXECUTOR_COROUTINE_HPP_
@@ -29,6 +29,7 @@
 #pragma once
 
 #include <thread>
+#include <utility>
 
 namespace hadoken {
 
@@ -40,8 +41,9 @@ class simple_thread_executor {
     simple_thread_executor() {}
     ~simple_thread_executor() {}
 
-    void execute(std::function<void(void)> fun) {
-        std::thread exec(std::move(fun));
+    template <typename Function>
+    void execute(Function&& fun) {
+        std::thread exec(std::forward<Function>(fun));
         exec.detach();
     }
 
@@ -29,7 +29,7 @@
 #pragma once
 
 
-#include <future>
+#include <utility>
 
 #include <hadoken/executor/thread_pool_executor.hpp>
 #include <hadoken/utility/singleton.hpp>
@@ -44,24 +44,37 @@ namespace hadoken {
 class system_executor {
   public:
     template <typename T>
-    using future = std::future<T>;
+    using future = thread_pool_executor::future<T>;
 
     template <typename T>
-    using promise = std::promise<T>;
+    using promise = thread_pool_executor::promise<T>;
 
     inline system_executor() { singleton<thread_pool_executor>::init(); }
 
     inline ~system_executor() {}
 
-    inline void execute(std::function<void(void)> task) {
-        singleton<thread_pool_executor>::instance().execute(std::move(task));
+    template <typename Function>
+    inline void execute(Function&& task) {
+        singleton<thread_pool_executor>::instance().execute(std::forward<Function>(task));
     }
 
     template <typename Function>
     inline future<decltype(std::declval<Function>()())> twoway_execute(Function func) {
-        return singleton<thread_pool_executor>::instance().twoway_execute(func);
+        return singleton<thread_pool_executor>::instance().twoway_execute(std::move(func));
+    }
+
+    template <typename Function>
+    inline void bulk_execute(std::size_t n, Function func) {
+        singleton<thread_pool_executor>::instance().bulk_execute(n, std::move(func));
     }
 
+    template <typename Function>
+    inline future<void> bulk_twoway_execute(std::size_t n, Function func) {
+        return singleton<thread_pool_executor>::instance().bulk_twoway_execute(n, std::move(func));
+    }
+
+
+    inline std::size_t get_thread_count() const { return singleton<thread_pool_executor>::instance().get_thread_count(); }
 
   private:
     singleton<thread_pool_executor> _s;
@@ -28,55 +28,220 @@
  */
 #pragma once
 
+#include <algorithm>
 #include <atomic>
 #include <bitset>
 #include <chrono>
+#include <cstdint>
+#include <exception>
 #include <functional>
-#include <iostream>
+#include <memory>
+#include <stdexcept>
 #include <thread>
 #include <type_traits>
+#include <utility>
 #include <vector>
 
 #include <hadoken/containers/concurrent_queue.hpp>
-#include <hadoken/thread/future_helpers.hpp>
+#include <hadoken/containers/work_stealing_deque.hpp>
+#include <hadoken/executor/bits/executor_metrics.hpp>
+#include <hadoken/executor/bits/priority_lanes.hpp>
+#include <hadoken/executor/unique_task.hpp>
+#include <hadoken/os/topology.hpp>
+#include <hadoken/thread/event_count.hpp>
+#include <hadoken/thread/future.hpp>
 #include <hadoken/threading/std_thread_model.hpp>
 
 
 namespace hadoken {
 
+template <template <typename> class WorkQueue>
+class basic_thread_pool_executor;
 
-namespace details {
 
-class worker_thread {
+///
+/// \brief placement of the workers of a thread pool
+///
+/// - none: no pinning, a single shared queue ( default )
+/// - cpu_set: each worker is pinned on one cpu of the set, round-robin
+/// - numa: workers are spread over the NUMA nodes and pinned on the cpus of their node,
+///   each node has its own queue and stealing prefers workers of the same node
+///
+/// a single node machine, or a machine without NUMA information, results in a single group
+///
+class worker_affinity {
   public:
-    explicit inline worker_thread(concurrent_queue<std::function<void()>>& queue) : _queue_ref(queue), exec(), finished(false) {
-        std::thread runner([this]() { run(); });
+    enum class mode { none, cpu_set, numa };
 
-        exec.swap(runner);
-    }
+    inline worker_affinity() : _mode(mode::none), _nodes() {}
 
+    static inline worker_affinity none() { return worker_affinity(); }
 
-    inline ~worker_thread() {
-        finished.store(true);
-        if (exec.joinable()) {
-            exec.join();
+    static inline worker_affinity cpu_set(std::vector<std::size_t> cpus) {
+        worker_affinity res;
+        if (cpus.empty() == false) {
+            res._mode = mode::cpu_set;
+            res._nodes.push_back(numa_node{0, std::move(cpus)});
         }
+        return res;
     }
 
-
-    inline void run() {
-        while (!finished) {
-            auto work_item = _queue_ref.try_pop(std::chrono::milliseconds(10));
-            if (work_item) {
-                work_item.get()();
+    static inline worker_affinity numa(std::vector<numa_node> nodes = get_numa_nodes()) {
+        worker_affinity res;
+        for (auto& node : nodes) {
+            if (node.cpus.empty() == false) {
+                res._nodes.push_back(std::move(node));
             }
         }
+        res._mode = (res._nodes.empty()) ? (mode::none) : (mode::numa);
+        return res;
+    }
+
+    inline mode get_mode() const { return _mode; }
+
+    /// groups of cpus: one per node in numa mode, a single one in cpu_set mode
+    inline const std::vector<numa_node>& nodes() const { return _nodes; }
+
+    inline std::size_t cpu_count() const {
+        std::size_t n_cpus = 0;
+        for (auto& node : _nodes) {
+            n_cpus += node.cpus.size();
+        }
+        return n_cpus;
     }
 
+  private:
+    mode _mode;
+    std::vector<numa_node> _nodes;
+};
+
+
+namespace details {
+
+///
+/// task stored in the local deque of a worker
+///
+/// nodes are recycled by the block cache of the thread executing them
+///
+struct task_node {
+    template <typename Function>
+    explicit inline task_node(Function&& func) : task(std::forward<Function>(func)) {}
+
+    static inline void* operator new(std::size_t size) { return thread::details::block_cache::local_allocate(size); }
+
+    static inline void operator delete(void* ptr, std::size_t size) noexcept {
+        thread::details::block_cache::local_deallocate(ptr, size);
+    }
+
+    unique_task task;
+};
+
+
+///
+/// shared state of a bulk submission
+///
+/// each ticket executes the indices taken from a shared counter until exhaustion,
+/// the last ticket to finish completes the promise
+///
+template <typename Function>
+class bulk_state {
+  public:
+    inline bulk_state(Function&& func, std::size_t n, std::size_t n_tickets)
+        : _func(std::move(func)), _size(n), _next_index(0), _running_tickets(n_tickets), _failed(false), _error(),
+          _promise(), _has_future(false) {}
+
+    inline thread::future<void> get_future() {
+        _has_future = true;
+        return _promise.get_future();
+    }
+
+    inline void run_ticket();
+
+  private:
+    bulk_state(const bulk_state&) = delete;
+    bulk_state& operator=(const bulk_state&) = delete;
+
+    Function _func;
+    const std::size_t _size;
+    std::atomic<std::size_t> _next_index;
+    std::atomic<std::size_t> _running_tickets;
+    std::atomic<bool> _failed;
+    std::exception_ptr _error;
+    thread::promise<void> _promise;
+    bool _has_future;
+};
+
+
+template <typename Pool>
+class worker_thread : public thread::wait_helper, public worker_metrics_recorder {
+  public:
+    using task_type = unique_task;
+
+    /// maximum number of tasks executed recursively by a worker waiting on futures
+    static constexpr std::size_t max_help_depth = 128;
+
+    explicit inline worker_thread(Pool& pool, std::size_t id, std::size_t node = 0,
+                                  std::vector<std::size_t> cpus = std::vector<std::size_t>());
+
+    inline ~worker_thread();
+
+    inline void start();
+
+    inline void stop();
+
+    inline void join();
+
+    inline void run();
+
+    /// execute one task of the pool while waiting on a future, see thread::wait_helper
+    inline bool help() override;
+
+    /// push a task on the local deque, worker thread only
+    inline void push_local(task_node* task) { _local_tasks.push(task); }
+
+    /// pop the last pushed task from the local deque, worker thread only
+    inline task_node* pop_local() {
+        auto res = _local_tasks.pop();
+        return (res) ? (res.get()) : (nullptr);
+    }
+
+    /// steal the oldest task of the local deque, any thread
+    inline task_node* steal() {
+        auto res = _local_tasks.steal();
+        return (res) ? (res.get()) : (nullptr);
+    }
+
+    inline bool has_local_work() const { return _local_tasks.empty() == false; }
+
+    inline std::size_t id() const { return _id; }
+
+    /// worker group, NUMA node index in the pool
+    inline std::size_t node() const { return _node; }
+
+    /// xorshift generator used to select steal victims
+    inline std::uint64_t next_random() {
+        _rand_state ^= _rand_state << 13;
+        _rand_state ^= _rand_state >> 7;
+        _rand_state ^= _rand_state << 17;
+        return _rand_state;
+    }
+
+    inline bool is_finished() const { return finished.load(); }
+
   private:
     worker_thread(const worker_thread&) = delete;
 
-    concurrent_queue<std::function<void()>>& _queue_ref;
+    Pool& _pool;
+
+    std::size_t _id, _node;
+
+    std::vector<std::size_t> _cpus;
+
+    std::uint64_t _rand_state;
+
+    work_stealing_deque<task_node*> _local_tasks;
+
+    std::size_t _help_depth;
 
     std::thread exec;
 
@@ -89,79 +254,698 @@ class worker_thread {
 ///
 /// \brief Executor implementation for a simple thread
 ///
-class thread_pool_executor : public std_thread_model {
+/// by default, every task goes through a shared queue
+///
+/// tasks are stored as unique_task: submitting a small callable does not allocate,
+/// twoway_execute() returns a hadoken::thread::future whose shared state
+/// is served by a per-thread block cache
+///
+/// a worker blocked on a future executes other tasks of the pool until the result
+/// is ready ( help-while-waiting ): twoway_execute() and bulk_twoway_execute()
+/// called from a task run in parallel, nested parallel algorithms use every worker
+///
+/// when the flag work_stealing is set, tasks submitted from a worker of the pool
+/// are pushed on the local deque of this worker ( LIFO ) and idle workers
+/// steal from a random victim
+///
+/// idle workers poll for work during a configurable spin budget, then park
+/// on an eventcount until new work is submitted: an idle pool does not consume CPU
+///
+/// every submitted task is accounted until the end of its execution,
+/// wait_idle() blocks until no task is queued or running
+///
+/// at destruction, the running tasks complete and the tasks still queued are destroyed
+/// without execution: the futures of twoway tasks receive a broken_promise error.
+/// With the flag complete_all_before_delete, the destructor waits first for the
+/// completion of every submitted task, see wait_idle()
+///
+/// execute(task, priority [, deadline]) submits to one of the priority lanes
+/// ( high, normal, low ): high priority tasks are executed before the regular queue,
+/// normal and low priority ones after it. A task with a deadline is executed
+/// earliest deadline first within its lane, but tasks with an earlier deadline
+/// overtake a task for at most the aging threshold, and a task waiting for longer
+/// than the aging threshold goes before the tasks of higher priority.
+/// Queue depth and waiting time are reported per lane with get_lane_stats()
+///
+/// workers can be pinned with a worker_affinity: on a NUMA machine, workers
+/// are grouped per node, with one queue per node, and steal preferably
+/// from workers of their own node
+///
+/// bulk_execute(n, func) runs func(i) for i in [0, n) with O(1) submission cost:
+/// at most one ticket per worker, pushed in a single queue operation,
+/// and a single completion counter
+///
+/// when HADOKEN_EXECUTOR_METRICS is defined, workers count their tasks, busy time,
+/// steals and parks, and record queue latency and run time histograms, see metrics()
+/// without it, the instrumentation compiles away
+///
+/// WorkQueue is the shared queue type, any queue template with the
+/// push / try_pop / empty interface of concurrent_queue can be used,
+/// bulk submission requires push_n in addition
+///
+/// e.g. a lock-free bounded queue
+///     template <typename T>
+///     using bounded_queue = concurrent_queue_mpmc_bounded<T, 4096>;
+///     basic_thread_pool_executor<bounded_queue> pool;
+///
+template <template <typename> class WorkQueue>
+class basic_thread_pool_executor : public std_thread_model {
   public:
-    enum class flags : std::size_t { complete_all_before_delete = 0 };
+    enum class flags : std::size_t { complete_all_before_delete = 0, work_stealing = 1 };
 
     template <typename T>
-    using future = std::future<T>;
+    using future = thread::future<T>;
 
     template <typename T>
-    using promise = std::promise<T>;
-
-    explicit inline thread_pool_executor(std::size_t n_thread = 0) : _flags(0), _work_queue(), _executors() {
+    using promise = thread::promise<T>;
+
+    using work_queue_type = WorkQueue<unique_task>;
+
+    ///
+    /// \brief create a pool of n_thread workers
+    ///
+    /// by default, one worker per cpu of the affinity, or per hardware thread without affinity
+    ///
+    explicit inline basic_thread_pool_executor(std::size_t n_thread = 0, const worker_affinity& affinity = worker_affinity())
+        : _flags(0), _work_queues(), _next_queue(0), _lanes(), _executors(), _idle_event(), _spin_budget(default_spin_budget),
+          _pending_tasks(0), _done_event() {
         pthread_key_create(&_recursive_key, NULL);
 
-        const std::size_t n_workers = (n_thread > 0) ? n_thread : (std::thread::hardware_concurrency());
+        const bool numa_mode = (affinity.get_mode() == worker_affinity::mode::numa);
+        const std::size_t n_queues = (numa_mode) ? (affinity.nodes().size()) : (1);
+        for (std::size_t i = 0; i < n_queues; ++i) {
+            _work_queues.emplace_back(new work_queue_type());
+        }
+
+        // (node index, cpu) of every cpu of the affinity, node by node
+        std::vector<std::pair<std::size_t, std::size_t>> cpu_slots;
+        for (std::size_t n = 0; n < affinity.nodes().size(); ++n) {
+            for (std::size_t cpu : affinity.nodes()[n].cpus) {
+                cpu_slots.emplace_back(n, cpu);
+            }
+        }
+
+        const std::size_t default_workers = (cpu_slots.empty()) ? (std::thread::hardware_concurrency()) : (cpu_slots.size());
+        const std::size_t n_workers = (n_thread > 0) ? (n_thread) : (std::max<std::size_t>(1, default_workers));
+
         for (std::size_t i = 0; i < n_workers; ++i) {
-            _executors.emplace_back(new details::worker_thread(_work_queue));
+            if (cpu_slots.empty()) {
+                _executors.emplace_back(new worker_type(*this, i));
+                continue;
+            }
+
+            // spread the workers evenly over the cpus, and thus over the nodes
+            const std::size_t slot =
+                (n_workers <= cpu_slots.size()) ? (i * cpu_slots.size() / n_workers) : (i % cpu_slots.size());
+            const std::size_t node = cpu_slots[slot].first;
+
+            std::vector<std::size_t> cpus =
+                (numa_mode) ? (affinity.nodes()[node].cpus) : (std::vector<std::size_t>(1, cpu_slots[slot].second));
+            _executors.emplace_back(new worker_type(*this, i, (numa_mode) ? (node) : (0), std::move(cpus)));
+        }
+
+        // start only once every worker exist, workers access their siblings for stealing
+        for (auto& worker : _executors) {
+            worker->start();
         }
     }
 
-    inline ~thread_pool_executor() {
-        pthread_key_delete(_recursive_key);
+    inline ~basic_thread_pool_executor() {
         if (_flags[static_cast<std::size_t>(flags::complete_all_before_delete)]) {
-            wait();
+            wait_idle();
+        }
+
+        // stop and join every worker before any destruction, workers steal from each other
+        for (auto& worker : _executors) {
+            worker->stop();
+        }
+        _idle_event.notify_all();
+        for (auto& worker : _executors) {
+            worker->join();
+        }
+
+        _drop_queued_tasks();
+        _executors.clear();
+
+        pthread_key_delete(_recursive_key);
+    }
+
+    template <typename Function>
+    inline void execute(Function&& task) {
+        worker_type* worker = _current_worker();
+
+        _pending_tasks.fetch_add(1);
+        if (worker != nullptr && get_flag(flags::work_stealing)) {
+            worker->push_local(new details::task_node(details::instrument_task(std::forward<Function>(task))));
+        } else {
+            _select_queue(worker).push(task_type(details::instrument_task(std::forward<Function>(task))));
         }
+        _idle_event.notify_one();
     }
 
-    inline void execute(std::function<void(void)> task) { _work_queue.push(std::move(task)); }
+    ///
+    /// \brief execute a task in a priority lane
+    ///
+    template <typename Function>
+    inline void execute(Function&& task, task_priority prio) {
+        _pending_tasks.fetch_add(1);
+        _lanes.push(task_type(details::instrument_task(std::forward<Function>(task))), prio);
+        _idle_event.notify_one();
+    }
+
+    ///
+    /// \brief execute a task in a priority lane, earliest deadline first
+    ///
+    template <typename Function>
+    inline void execute(Function&& task, task_priority prio, std::chrono::steady_clock::time_point deadline) {
+        _pending_tasks.fetch_add(1);
+        _lanes.push(task_type(details::instrument_task(std::forward<Function>(task))), prio, deadline);
+        _idle_event.notify_one();
+    }
 
     template <typename Function>
     inline future<decltype(std::declval<Function>()())> twoway_execute(Function func) {
+        using result_type = decltype(std::declval<Function>()());
 
-        // if our current thread is not part of the pool
-        // we execute in the pool
-        // if it is already a pooled_thread, we do not to avoid deadlock
-        if (pthread_getspecific(_recursive_key) == NULL) {
-
-            auto prom = std::make_shared<promise<decltype(std::declval<Function>()())>>();
-            auto future_result = prom->get_future();
-
-            _work_queue.push([prom, func, this]() mutable -> void {
-                pthread_setspecific(this->_recursive_key, (void*)1);
-                try {
-                    set_promise_from_result(*prom, func);
-                } catch (...) {
-                    try {
-                        prom->set_exception(std::current_exception());
-                    } catch (...) {
-                        std::cerr << "error during set_exception in executor" << std::endl;
-                    }
-                }
-            });
-            return future_result;
+        thread::packaged_task<result_type> task(std::move(func));
+        future<result_type> res = task.get_future();
+
+        // submitted from a worker: the task goes on its local deque, executed first
+        // by the worker itself if it waits for the result, or stolen by an idle worker
+        worker_type* worker = _current_worker();
+
+        _pending_tasks.fetch_add(1);
+        if (worker != nullptr) {
+            worker->push_local(new details::task_node(details::instrument_task(std::move(task))));
         } else {
-            return std::async(std::launch::deferred, [func]() { return func(); });
+            _select_queue(nullptr).push(task_type(details::instrument_task(std::move(task))));
         }
+        _idle_event.notify_one();
+        return res;
+    }
+
+    ///
+    /// \brief execute func(i) for every i in [0, n)
+    ///
+    /// exceptions escaping func are fatal, like for execute()
+    ///
+    template <typename Function>
+    inline void bulk_execute(std::size_t n, Function func) {
+        if (n == 0) {
+            return;
+        }
+
+        const std::size_t n_tickets = _bulk_tickets(n);
+        auto state = std::make_shared<details::bulk_state<Function>>(std::move(func), n, n_tickets);
+        _submit_tickets(state, n_tickets);
+    }
+
+    ///
+    /// \brief execute func(i) for every i in [0, n)
+    /// \return a single future, ready once every index has been executed
+    ///
+    /// the first exception thrown by func is stored in the future,
+    /// the remaining indices are then not executed
+    ///
+    template <typename Function>
+    inline future<void> bulk_twoway_execute(std::size_t n, Function func) {
+        if (n == 0) {
+            promise<void> done;
+            done.set_value();
+            return done.get_future();
+        }
+
+        const std::size_t n_tickets = _bulk_tickets(n);
+
+        auto state = std::make_shared<details::bulk_state<Function>>(std::move(func), n, n_tickets);
+        future<void> res = state->get_future();
+
+        _submit_tickets(state, n_tickets);
+        return res;
     }
 
     inline void set_flags(flags flag, bool value) { _flags[static_cast<std::size_t>(flag)] = value; }
 
     inline bool get_flag(flags flag) const { return _flags[static_cast<std::size_t>(flag)]; }
 
-    inline void wait() {
-        while (_work_queue.empty() == false) {
-            std::this_thread::yield();
+    ///
+    /// \brief number of polling rounds of an idle worker before parking
+    ///
+    /// a large budget lowers the wake-up latency, at the price of CPU burned while idle
+    /// 0 parks the worker as soon as no work is found
+    ///
+    inline void set_spin_budget(std::size_t n_rounds) { _spin_budget.store(n_rounds); }
+
+    inline std::size_t get_spin_budget() const { return _spin_budget.load(); }
+
+    ///
+    /// \brief maximum waiting time of a task in a priority lane before it goes
+    /// ahead of the tasks of higher priority ( default: 100ms )
+    ///
+    template <typename Rep, typename Period>
+    inline void set_aging_threshold(const std::chrono::duration<Rep, Period>& threshold) {
+        _lanes.set_aging_threshold(std::chrono::duration_cast<std::chrono::steady_clock::duration>(threshold));
+    }
+
+    inline std::chrono::steady_clock::duration get_aging_threshold() const { return _lanes.get_aging_threshold(); }
+
+    ///
+    /// \brief depth and waiting time statistics of a priority lane
+    ///
+    inline priority_lane_stats get_lane_stats(task_priority prio) const { return _lanes.stats(prio); }
+
+    ///
+    /// \brief number of worker threads
+    ///
+    inline std::size_t get_thread_count() const { return _executors.size(); }
+
+    ///
+    /// \brief number of worker groups, one per NUMA node in numa mode, 1 otherwise
+    ///
+    inline std::size_t get_node_count() const { return _work_queues.size(); }
+
+    ///
+    /// \brief number of tasks submitted and not yet completed, queued or running
+    ///
+    inline std::size_t pending_tasks() const { return _pending_tasks.load(); }
+
+    ///
+    /// \brief block until every submitted task completed
+    ///
+    /// tasks submitted by running tasks are waited for too
+    /// can not be called from a worker of the pool itself
+    ///
+    inline void wait_idle() {
+        _check_not_worker();
+
+        while (_pending_tasks.load() != 0) {
+            const thread::event_count::key_type key = _done_event.prepare_wait();
+            if (_pending_tasks.load() == 0) {
+                _done_event.cancel_wait();
+                break;
+            }
+            _done_event.commit_wait(key);
+        }
+    }
+
+    ///
+    /// \brief block until every submitted task completed, or timeout
+    /// \return true if the pool is idle, false in case of timeout
+    ///
+    template <typename Rep, typename Period>
+    inline bool wait_idle_for(const std::chrono::duration<Rep, Period>& d) {
+        _check_not_worker();
+
+        const auto deadline = std::chrono::steady_clock::now() + d;
+
+        while (_pending_tasks.load() != 0) {
+            const auto now = std::chrono::steady_clock::now();
+            if (now >= deadline) {
+                return false;
+            }
+
+            const thread::event_count::key_type key = _done_event.prepare_wait();
+            if (_pending_tasks.load() == 0) {
+                _done_event.cancel_wait();
+                break;
+            }
+            _done_event.commit_wait_for(key, deadline - now);
         }
+        return true;
     }
 
+    ///
+    /// \brief snapshot of the activity of the workers, taken without stopping the pool
+    ///
+    /// collected only when HADOKEN_EXECUTOR_METRICS is defined at compile time,
+    /// the returned metrics are then marked enabled
+    ///
+    inline executor_metrics metrics() const {
+        executor_metrics res;
+        res.pending_tasks = _pending_tasks.load();
+
+        if (details::worker_metrics_recorder::enabled) {
+            res.enabled = true;
+            res.workers.reserve(_executors.size());
+            for (auto& worker : _executors) {
+                res.workers.push_back(worker->snapshot(worker->id()));
+            }
+        }
+        return res;
+    }
+
+    ///
+    /// \brief wait for the completion of every submitted task, see wait_idle()
+    ///
+    inline void wait() { wait_idle(); }
+
   private:
+    using worker_type = details::worker_thread<basic_thread_pool_executor>;
+    using task_type = typename worker_type::task_type;
+
+    friend worker_type;
+
+    inline worker_type* _current_worker() const { return static_cast<worker_type*>(pthread_getspecific(_recursive_key)); }
+
+    inline void _check_not_worker() const {
+        if (_current_worker() != nullptr) {
+            throw std::logic_error("wait_idle() called from a worker of the same thread pool would deadlock");
+        }
+    }
+
+    inline std::size_t _bulk_tickets(std::size_t n) const { return std::min(n, _executors.size()); }
+
+    template <typename State>
+    inline void _submit_tickets(const std::shared_ptr<State>& state, std::size_t n_tickets) {
+        std::vector<task_type> tickets;
+        tickets.reserve(n_tickets);
+        for (std::size_t i = 0; i < n_tickets; ++i) {
+            tickets.emplace_back(details::instrument_task([state]() { state->run_ticket(); }));
+        }
+
+        _pending_tasks.fetch_add(n_tickets);
+
+        // from a worker, on the local deque: see twoway_execute
+        worker_type* worker = _current_worker();
+        if (worker != nullptr) {
+            for (auto& ticket : tickets) {
+                worker->push_local(new details::task_node(std::move(ticket)));
+            }
+            _idle_event.notify_all();
+            return;
+        }
+
+        // tickets are spread over the node queues
+        const std::size_t n_queues = _work_queues.size();
+        auto first_ticket = tickets.begin();
+        for (std::size_t q = 0; q < n_queues; ++q) {
+            const std::size_t n_queue_tickets = n_tickets / n_queues + ((q < n_tickets % n_queues) ? (1) : (0));
+            _work_queues[q]->push_n(first_ticket, n_queue_tickets);
+            first_ticket += n_queue_tickets;
+        }
+        _idle_event.notify_all();
+    }
+
+    // queue of the node of the worker, round-robin over the nodes for external threads
+    inline work_queue_type& _select_queue(worker_type* worker) {
+        const std::size_t n_queues = _work_queues.size();
+        if (n_queues == 1) {
+            return *_work_queues.front();
+        }
+
+        if (worker != nullptr) {
+            return *_work_queues[worker->node()];
+        }
+        return *_work_queues[_next_queue.fetch_add(1, std::memory_order_relaxed) % n_queues];
+    }
+
+    inline void _task_done() {
+        if (_pending_tasks.fetch_sub(1) == 1) {
+            _done_event.notify_all();
+        }
+    }
+
+    inline bool _has_pending_work() const {
+        if (_lanes.empty() == false) {
+            return true;
+        }
+
+        for (auto& queue : _work_queues) {
+            if (queue->empty() == false) {
+                return true;
+            }
+        }
+
+        for (auto& worker : _executors) {
+            if (worker->has_local_work()) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // execute one task: local deque first, then high priority lane and aged tasks,
+    // queue of the node, queues of the other nodes, normal and low priority lanes,
+    // then steal from the same node first
+    // the task is destroyed before being accounted as completed
+    // return false if no work was found
+    inline bool _run_next(worker_type& worker) {
+        std::unique_ptr<details::task_node> local_task(worker.pop_local());
+        if (local_task) {
+            local_task->task();
+            local_task.reset();
+            _task_done();
+            return true;
+        }
+
+        if (_run_prioritized(true)) {
+            return true;
+        }
+
+        const std::size_t n_queues = _work_queues.size();
+        for (std::size_t q = 0; q < n_queues; ++q) {
+            auto work_item = _work_queues[(worker.node() + q) % n_queues]->try_pop();
+            if (work_item) {
+                work_item.get()();
+                work_item = optional<task_type>();
+                _task_done();
+                return true;
+            }
+        }
+
+        if (_run_prioritized(false)) {
+            return true;
+        }
+
+        const std::size_t n_workers = _executors.size();
+        if (n_workers > 1) {
+            const std::size_t first_victim = static_cast<std::size_t>(worker.next_random() % n_workers);
+
+            // first pass on the workers of the same node, second pass on the other nodes
+            const std::size_t n_passes = (n_queues > 1) ? (2) : (1);
+            for (std::size_t pass = 0; pass < n_passes; ++pass) {
+                for (std::size_t i = 0; i < n_workers; ++i) {
+                    worker_type& victim = *_executors[(first_victim + i) % n_workers];
+                    if (victim.id() == worker.id() || (n_passes > 1 && (victim.node() == worker.node()) != (pass == 0))) {
+                        continue;
+                    }
+
+                    std::unique_ptr<details::task_node> stolen_task(victim.steal());
+                    if (stolen_task) {
+                        worker.count_steal();
+                        stolen_task->task();
+                        stolen_task.reset();
+                        _task_done();
+                        return true;
+                    }
+                }
+            }
+        }
+
+        return false;
+    }
+
+    inline bool _run_prioritized(bool urgent_only) {
+        auto work_item = _lanes.try_pop(urgent_only);
+        if (work_item) {
+            work_item.get()();
+            work_item = optional<task_type>();
+            _task_done();
+            return true;
+        }
+        return false;
+    }
+
+    // spin then park until new work is submitted
+    // return true if work is available, false if the worker has to stop
+    inline bool _wait_for_work(worker_type& worker) {
+        const std::size_t spin_budget = _spin_budget.load(std::memory_order_relaxed);
+
+        for (std::size_t i = 0; i < spin_budget; ++i) {
+            if (worker.is_finished()) {
+                return false;
+            }
+            if (_has_pending_work()) {
+                return true;
+            }
+            std::this_thread::yield();
+        }
+
+        while (true) {
+            const thread::event_count::key_type key = _idle_event.prepare_wait();
+
+            if (worker.is_finished()) {
+                _idle_event.cancel_wait();
+                return false;
+            }
+
+            // re-check once registered, a producer notifies only after its push
+            if (_has_pending_work()) {
+                _idle_event.cancel_wait();
+                return true;
+            }
+
+            worker.count_park();
+            _idle_event.commit_wait(key);
+        }
+    }
+
+    // destroy the tasks never executed, once every worker is joined
+    // a destroyed twoway task breaks its promise, the continuations of the broken future
+    // can submit new tasks to the pool: they are destroyed as well
+    inline void _drop_queued_tasks() {
+        bool dropped = true;
+        while (dropped) {
+            dropped = false;
+
+            while (_lanes.try_pop()) {
+                _task_done();
+                dropped = true;
+            }
+
+            for (auto& queue : _work_queues) {
+                while (queue->try_pop()) {
+                    _task_done();
+                    dropped = true;
+                }
+            }
+
+            for (auto& worker : _executors) {
+                while (details::task_node* task = worker->pop_local()) {
+                    delete task;
+                    _task_done();
+                    dropped = true;
+                }
+            }
+        }
+    }
+
     std::bitset<32> _flags;
-    concurrent_queue<std::function<void()>> _work_queue;
-    std::vector<std::unique_ptr<details::worker_thread>> _executors;
+    std::vector<std::unique_ptr<work_queue_type>> _work_queues;
+    std::atomic<std::size_t> _next_queue;
+    details::priority_lanes _lanes;
+    std::vector<std::unique_ptr<worker_type>> _executors;
     pthread_key_t _recursive_key;
+
+    static constexpr std::size_t default_spin_budget = 64;
+
+    thread::event_count _idle_event;
+    std::atomic<std::size_t> _spin_budget;
+
+    std::atomic<std::size_t> _pending_tasks;
+    thread::event_count _done_event;
 };
 
 
+///
+/// thread pool executor with the default shared queue
+///
+using thread_pool_executor = basic_thread_pool_executor<concurrent_queue>;
+
+
+namespace details {
+
+template <typename Function>
+inline void bulk_state<Function>::run_ticket() {
+    std::size_t index;
+    while ((index = _next_index.fetch_add(1, std::memory_order_relaxed)) < _size) {
+        try {
+            _func(index);
+        } catch (...) {
+            if (_failed.exchange(true) == false) {
+                _error = std::current_exception();
+            }
+            // stop the distribution of the remaining indices
+            _next_index.store(_size, std::memory_order_relaxed);
+        }
+    }
+
+    if (_running_tickets.fetch_sub(1) != 1) {
+        return;
+    }
+
+    if (_error) {
+        if (_has_future == false) {
+            std::rethrow_exception(_error);
+        }
+        _promise.set_exception(_error);
+    } else {
+        _promise.set_value();
+    }
+}
+
+
+template <typename Pool>
+inline worker_thread<Pool>::worker_thread(Pool& pool, std::size_t id, std::size_t node, std::vector<std::size_t> cpus)
+    : _pool(pool), _id(id), _node(node), _cpus(std::move(cpus)), _rand_state(0x9E3779B97F4A7C15ULL * (id + 1)),
+      _local_tasks(), _help_depth(0), exec(), finished(false) {}
+
+
+template <typename Pool>
+inline worker_thread<Pool>::~worker_thread() {
+    stop();
+    join();
+
+    // drop tasks never executed
+    while (task_node* task = pop_local()) {
+        delete task;
+    }
+}
+
+template <typename Pool>
+inline void worker_thread<Pool>::start() {
+    std::thread runner([this]() { run(); });
+
+    exec.swap(runner);
+}
+
+template <typename Pool>
+inline void worker_thread<Pool>::stop() {
+    finished.store(true);
+}
+
+template <typename Pool>
+inline void worker_thread<Pool>::join() {
+    if (exec.joinable()) {
+        exec.join();
+    }
+}
+
+
+template <typename Pool>
+inline void worker_thread<Pool>::run() {
+    pthread_setspecific(_pool._recursive_key, this);
+    thread::wait_helper::set_current(this);
+    this->begin_recording();
+
+    // best effort: cpus can be forbidden to the process, the worker runs unpinned
+    if (_cpus.empty() == false) {
+        set_thread_affinity(_cpus);
+    }
+
+    // stop taking new work once finished, the pool destroys the tasks left in the queues
+    while (is_finished() == false) {
+        if (_pool._run_next(*this) == false && _pool._wait_for_work(*this) == false) {
+            break;
+        }
+    }
+}
+
+template <typename Pool>
+inline bool worker_thread<Pool>::help() {
+    // bound the stack growth of tasks waiting on tasks waiting on tasks...
+    // beyond it, the worker parks until the other workers complete the result
+    if (_help_depth >= max_help_depth) {
+        return false;
+    }
+
+    _help_depth += 1;
+    const bool found = _pool._run_next(*this);
+    _help_depth -= 1;
+    return found;
+}
+
+} // namespace details
+
+
 } // namespace hadoken
@@ -0,0 +1,323 @@
+/**
+ * Copyright (c) 2018, Adrien Devresse <adrien.devresse@epfl.ch>
+ *
+ * Boost Software License - Version 1.0
+ *
+ * Permission is hereby granted, free of charge, to any person or organization
+ * obtaining a copy of the software and accompanying documentation covered by
+ * this license (the "Software") to use, reproduce, display, distribute,
+ * execute, and transmit the Software, and to prepare derivative works of the
+ * Software, and to permit third-parties to whom the Software is furnished to
+ * do so, all subject to the following:
+ *
+ * The copyright notices in the Software and this entire statement, including
+ * the above license grant, this restriction and the following disclaimer,
+ * must be included in all copies of the Software, in whole or in part, and
+ * all derivative works of the Software, unless such copies or derivative
+ * works are solely in the form of machine-executable object code generated by
+ * a source language processor.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+ * SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+ * FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ *
+ */
+#ifndef _HADOKEN_TIMER_EXECUTOR_HPP_
+#define _HADOKEN_TIMER_EXECUTOR_HPP_
+
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <hadoken/executor/bits/timing_wheel.hpp>
+#include <hadoken/executor/unique_task.hpp>
+
+
+namespace hadoken {
+
+namespace details {
+
+// forward expired tasks to an executor
+class timer_dispatcher {
+  public:
+    virtual ~timer_dispatcher() = default;
+
+    virtual void dispatch(unique_task&& task) = 0;
+};
+
+template <typename Executor>
+class executor_dispatcher : public timer_dispatcher {
+  public:
+    explicit inline executor_dispatcher(Executor& exec) : _exec(exec) {}
+
+    inline void dispatch(unique_task&& task) override { _exec.execute(std::move(task)); }
+
+  private:
+    Executor& _exec;
+};
+
+} // namespace details
+
+
+///
+/// \brief Executor for delayed and periodic tasks
+///
+/// timers are stored in a hierarchical timing wheel: O(1) insertion and cancellation,
+/// millions of pending timers are supported
+///
+/// a single timer thread advances the wheel, and dispatches the expired tasks
+/// to a target executor, e.g. a thread_pool_executor. Without target executor,
+/// the tasks are executed by the timer thread itself and should be short
+///
+/// the target executor has to accept move-only callables
+///
+/// tasks are never executed before their deadline, and at most one resolution
+/// period after in the absence of contention
+///
+class timer_executor {
+  public:
+    using clock = std::chrono::steady_clock;
+
+    ///
+    /// \brief handle of a pending timer, used for cancellation
+    ///
+    class timer_handle {
+      public:
+        inline timer_handle() : _h{0, 0}, _valid(false) {}
+
+      private:
+        friend class timer_executor;
+
+        explicit inline timer_handle(details::timing_wheel::handle h) : _h(h), _valid(true) {}
+
+        details::timing_wheel::handle _h;
+        bool _valid;
+    };
+
+    /// tasks executed by the timer thread
+    explicit inline timer_executor(clock::duration resolution = std::chrono::milliseconds(1));
+
+    /// tasks dispatched to target, which has to outlive the timer_executor
+    template <typename Executor>
+    explicit inline timer_executor(Executor& target, clock::duration resolution = std::chrono::milliseconds(1));
+
+    /// pending timers and tasks are dropped
+    inline ~timer_executor();
+
+    /// execute as soon as possible, by the target executor or by the timer thread, never by the caller
+    template <typename Function>
+    inline void execute(Function&& func) {
+        _post(unique_task(std::forward<Function>(func)));
+    }
+
+    /// execute after a delay
+    template <typename Rep, typename Period, typename Function>
+    inline timer_handle execute_after(const std::chrono::duration<Rep, Period>& delay, Function&& func) {
+        return execute_at(clock::now() + std::chrono::duration_cast<clock::duration>(delay), std::forward<Function>(func));
+    }
+
+    /// execute at a given time
+    template <typename Function>
+    inline timer_handle execute_at(clock::time_point deadline, Function&& func) {
+        return _schedule(deadline, clock::duration(0), unique_task(std::forward<Function>(func)));
+    }
+
+    ///
+    /// \brief execute every period, the first execution happens after one period
+    ///
+    /// executions are aligned on the period grid, an execution missed because
+    /// the timer thread is late is skipped; with a concurrent target executor,
+    /// executions slower than the period can overlap
+    ///
+    template <typename Rep, typename Period, typename Function>
+    inline timer_handle execute_every(const std::chrono::duration<Rep, Period>& period, Function&& func) {
+        const clock::duration p = std::max(std::chrono::duration_cast<clock::duration>(period), _resolution);
+        return _schedule(clock::now() + p, p, unique_task(std::forward<Function>(func)));
+    }
+
+    ///
+    /// \brief cancel a pending timer
+    /// \return false if the timer already expired, for one-shot timers, or was already cancelled
+    ///
+    inline bool cancel(const timer_handle& handle);
+
+    /// number of pending timers, periodic timers included
+    inline std::size_t pending_timers() const;
+
+  private:
+    timer_executor(const timer_executor&) = delete;
+    timer_executor& operator=(const timer_executor&) = delete;
+
+    using tick_type = details::timing_wheel::tick_type;
+
+    inline tick_type _tick_of(clock::time_point tp, bool round_up) const;
+
+    inline clock::time_point _time_of(tick_type tick) const { return _origin + _resolution * tick; }
+
+    inline timer_handle _schedule(clock::time_point deadline, clock::duration period, unique_task task);
+
+    inline void _dispatch(unique_task&& task);
+
+    inline void _post(unique_task&& task);
+
+    inline void _start();
+
+    inline void _run();
+
+    std::unique_ptr<details::timer_dispatcher> _target;
+    const clock::duration _resolution;
+    const clock::time_point _origin;
+
+    mutable std::mutex _lock;
+    std::condition_variable _cond;
+    details::timing_wheel _wheel;
+    // tasks submitted by execute() without target, run by the timer thread
+    std::vector<unique_task> _ready;
+    tick_type _wakeup_tick;
+    bool _finished;
+
+    std::thread _timer_thread;
+};
+
+
+inline timer_executor::timer_executor(clock::duration resolution)
+    : _target(), _resolution(std::max(resolution, clock::duration(1))), _origin(clock::now()), _lock(), _cond(), _wheel(),
+      _ready(), _wakeup_tick(details::timing_wheel::no_event), _finished(false), _timer_thread() {
+    _start();
+}
+
+template <typename Executor>
+inline timer_executor::timer_executor(Executor& target, clock::duration resolution)
+    : _target(new details::executor_dispatcher<Executor>(target)), _resolution(std::max(resolution, clock::duration(1))),
+      _origin(clock::now()), _lock(), _cond(), _wheel(), _ready(), _wakeup_tick(details::timing_wheel::no_event),
+      _finished(false), _timer_thread() {
+    _start();
+}
+
+inline timer_executor::~timer_executor() {
+    {
+        std::lock_guard<std::mutex> l(_lock);
+        _finished = true;
+    }
+    _cond.notify_all();
+    _timer_thread.join();
+}
+
+inline bool timer_executor::cancel(const timer_handle& handle) {
+    if (handle._valid == false) {
+        return false;
+    }
+
+    std::lock_guard<std::mutex> l(_lock);
+    return _wheel.cancel(handle._h);
+}
+
+inline std::size_t timer_executor::pending_timers() const {
+    std::lock_guard<std::mutex> l(_lock);
+    return _wheel.size();
+}
+
+inline timer_executor::tick_type timer_executor::_tick_of(clock::time_point tp, bool round_up) const {
+    if (tp <= _origin) {
+        return 0;
+    }
+    const clock::duration elapsed = tp - _origin;
+    const tick_type ticks = static_cast<tick_type>(elapsed / _resolution);
+    return (round_up && (elapsed % _resolution) != clock::duration(0)) ? (ticks + 1) : (ticks);
+}
+
+inline timer_executor::timer_handle timer_executor::_schedule(clock::time_point deadline, clock::duration period,
+                                                              unique_task task) {
+    // rounded up: never executed before the deadline
+    const tick_type expiry = _tick_of(deadline, true);
+    const tick_type period_ticks = static_cast<tick_type>(period / _resolution);
+
+    bool wake_up = false;
+    details::timing_wheel::handle h;
+    {
+        std::lock_guard<std::mutex> l(_lock);
+        h = _wheel.insert(expiry, std::move(task), period_ticks);
+
+        // the timer thread sleeps beyond the new deadline
+        if (expiry < _wakeup_tick) {
+            _wakeup_tick = expiry;
+            wake_up = true;
+        }
+    }
+
+    if (wake_up) {
+        _cond.notify_one();
+    }
+    return timer_handle(h);
+}
+
+inline void timer_executor::_dispatch(unique_task&& task) {
+    if (_target) {
+        _target->dispatch(std::move(task));
+    } else {
+        task();
+    }
+}
+
+inline void timer_executor::_post(unique_task&& task) {
+    if (_target) {
+        _target->dispatch(std::move(task));
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> l(_lock);
+        _ready.push_back(std::move(task));
+    }
+    _cond.notify_one();
+}
+
+inline void timer_executor::_start() {
+    std::thread runner([this]() { _run(); });
+    _timer_thread.swap(runner);
+}
+
+inline void timer_executor::_run() {
+    std::vector<unique_task> expired;
+
+    std::unique_lock<std::mutex> l(_lock);
+    while (_finished == false) {
+        for (auto& task : _ready) {
+            expired.push_back(std::move(task));
+        }
+        _ready.clear();
+
+        _wheel.advance(_tick_of(clock::now(), false), [&expired](unique_task&& task) { expired.push_back(std::move(task)); });
+
+        if (expired.empty() == false) {
+            // dispatch without the lock, timers can be scheduled from the tasks
+            l.unlock();
+            for (auto& task : expired) {
+                _dispatch(std::move(task));
+            }
+            expired.clear();
+            l.lock();
+            continue;
+        }
+
+        _wakeup_tick = _wheel.next_event();
+        if (_wakeup_tick == details::timing_wheel::no_event) {
+            _cond.wait(l);
+        } else {
+            _cond.wait_until(l, _time_of(_wakeup_tick));
+        }
+    }
+}
+
+
+} // namespace hadoken
+
+#endif // _HADOKEN_TIMER_EXECUTOR_HPP_
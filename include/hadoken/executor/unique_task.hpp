@@ -0,0 +1,253 @@
+/**
+ * Copyright (c) 2018, Adrien Devresse <adrien.devresse@epfl.ch>
+ *
+ * Boost Software License - Version 1.0
+ *
+ * Permission is hereby granted, free of charge, to any person or organization
+ * obtaining a copy of the software and accompanying documentation covered by
+ * this license (the "Software") to use, reproduce, display, distribute,
+ * execute, and transmit the Software, and to prepare derivative works of the
+ * Software, and to permit third-parties to whom the Software is furnished to
+ * do so, all subject to the following:
+ *
+ * The copyright notices in the Software and this entire statement, including
+ * the above license grant, this restriction and the following disclaimer,
+ * must be included in all copies of the Software, in whole or in part, and
+ * all derivative works of the Software, unless such copies or derivative
+ * works are solely in the form of machine-executable object code generated by
+ * a source language processor.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+ * SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+ * FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ *
+ */
+#ifndef _HADOKEN_UNIQUE_TASK_HPP_
+#define _HADOKEN_UNIQUE_TASK_HPP_
+
+#include <cstddef>
+#include <functional>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+
+namespace hadoken {
+
+///
+/// \brief move-only type erased task, callable as void()
+///
+/// replacement of std::function<void()> for executors
+///
+/// - accept move-only callables
+/// - callables of up to small_buffer_size bytes, nothrow move constructible and
+///   not over-aligned are stored inline: no heap allocation
+/// - larger callables are allocated on the heap
+///
+class unique_task {
+  public:
+    static constexpr std::size_t small_buffer_size = 48;
+
+    /// empty task
+    inline unique_task() noexcept : _ops(nullptr) {}
+
+    template <typename Function,
+              typename = typename std::enable_if<!std::is_same<typename std::decay<Function>::type, unique_task>::value>::type>
+    inline unique_task(Function&& func);
+
+    inline unique_task(unique_task&& other) noexcept;
+
+    inline unique_task& operator=(unique_task&& other) noexcept;
+
+    unique_task(const unique_task&) = delete;
+    unique_task& operator=(const unique_task&) = delete;
+
+    inline ~unique_task() { reset(); }
+
+    ///
+    /// \brief execute the task
+    ///
+    /// throw std::bad_function_call if the task is empty
+    ///
+    inline void operator()();
+
+    /// true if the task is not empty
+    inline explicit operator bool() const noexcept { return _ops != nullptr; }
+
+    /// true if the stored callable lives in the small buffer
+    inline bool is_inline() const noexcept { return _ops != nullptr && _ops->is_inline; }
+
+    /// destroy the stored callable, the task becomes empty
+    inline void reset() noexcept;
+
+    inline void swap(unique_task& other) noexcept;
+
+    /// true if a callable of type Function is stored without allocation
+    template <typename Function>
+    static constexpr bool fits_inline() {
+        return sizeof(Function) <= small_buffer_size && alignof(storage_type) % alignof(Function) == 0 &&
+               std::is_nothrow_move_constructible<Function>::value;
+    }
+
+  private:
+    using storage_type = typename std::aligned_storage<small_buffer_size, alignof(std::max_align_t)>::type;
+
+    struct operations {
+        void (*invoke)(storage_type&);
+        void (*move)(storage_type& from, storage_type& to) noexcept;
+        void (*destroy)(storage_type&) noexcept;
+        bool is_inline;
+    };
+
+    template <typename Function>
+    struct inline_operations {
+        static inline void invoke(storage_type& s);
+        static inline void move(storage_type& from, storage_type& to) noexcept;
+        static inline void destroy(storage_type& s) noexcept;
+
+        static const operations table;
+    };
+
+    template <typename Function>
+    struct heap_operations {
+        static inline void invoke(storage_type& s);
+        static inline void move(storage_type& from, storage_type& to) noexcept;
+        static inline void destroy(storage_type& s) noexcept;
+
+        static const operations table;
+    };
+
+    template <typename Function>
+    inline void _store(Function&& func, std::true_type /* inline */);
+
+    template <typename Function>
+    inline void _store(Function&& func, std::false_type /* inline */);
+
+    storage_type _storage;
+    const operations* _ops;
+};
+
+
+inline void swap(unique_task& t1, unique_task& t2) noexcept {
+    t1.swap(t2);
+}
+
+
+// inline storage
+
+template <typename Function>
+const unique_task::operations unique_task::inline_operations<Function>::table = {
+    &unique_task::inline_operations<Function>::invoke, &unique_task::inline_operations<Function>::move,
+    &unique_task::inline_operations<Function>::destroy, true};
+
+template <typename Function>
+inline void unique_task::inline_operations<Function>::invoke(storage_type& s) {
+    (*reinterpret_cast<Function*>(&s))();
+}
+
+template <typename Function>
+inline void unique_task::inline_operations<Function>::move(storage_type& from, storage_type& to) noexcept {
+    Function* f = reinterpret_cast<Function*>(&from);
+    ::new (static_cast<void*>(&to)) Function(std::move(*f));
+    f->~Function();
+}
+
+template <typename Function>
+inline void unique_task::inline_operations<Function>::destroy(storage_type& s) noexcept {
+    reinterpret_cast<Function*>(&s)->~Function();
+}
+
+
+// heap storage, the small buffer holds a pointer to the callable
+
+template <typename Function>
+const unique_task::operations unique_task::heap_operations<Function>::table = {
+    &unique_task::heap_operations<Function>::invoke, &unique_task::heap_operations<Function>::move,
+    &unique_task::heap_operations<Function>::destroy, false};
+
+template <typename Function>
+inline void unique_task::heap_operations<Function>::invoke(storage_type& s) {
+    (**reinterpret_cast<Function**>(&s))();
+}
+
+template <typename Function>
+inline void unique_task::heap_operations<Function>::move(storage_type& from, storage_type& to) noexcept {
+    ::new (static_cast<void*>(&to)) Function*(*reinterpret_cast<Function**>(&from));
+}
+
+template <typename Function>
+inline void unique_task::heap_operations<Function>::destroy(storage_type& s) noexcept {
+    delete *reinterpret_cast<Function**>(&s);
+}
+
+
+template <typename Function, typename>
+inline unique_task::unique_task(Function&& func) : _ops(nullptr) {
+    using function_type = typename std::decay<Function>::type;
+
+    _store(std::forward<Function>(func), std::integral_constant<bool, fits_inline<function_type>()>());
+}
+
+template <typename Function>
+inline void unique_task::_store(Function&& func, std::true_type) {
+    using function_type = typename std::decay<Function>::type;
+
+    ::new (static_cast<void*>(&_storage)) function_type(std::forward<Function>(func));
+    _ops = &inline_operations<function_type>::table;
+}
+
+template <typename Function>
+inline void unique_task::_store(Function&& func, std::false_type) {
+    using function_type = typename std::decay<Function>::type;
+
+    ::new (static_cast<void*>(&_storage)) function_type*(new function_type(std::forward<Function>(func)));
+    _ops = &heap_operations<function_type>::table;
+}
+
+inline unique_task::unique_task(unique_task&& other) noexcept : _ops(other._ops) {
+    if (_ops != nullptr) {
+        _ops->move(other._storage, _storage);
+        other._ops = nullptr;
+    }
+}
+
+inline unique_task& unique_task::operator=(unique_task&& other) noexcept {
+    if (this != &other) {
+        reset();
+        if (other._ops != nullptr) {
+            other._ops->move(other._storage, _storage);
+            _ops = other._ops;
+            other._ops = nullptr;
+        }
+    }
+    return *this;
+}
+
+inline void unique_task::operator()() {
+    if (_ops == nullptr) {
+        throw std::bad_function_call();
+    }
+    _ops->invoke(_storage);
+}
+
+inline void unique_task::reset() noexcept {
+    if (_ops != nullptr) {
+        _ops->destroy(_storage);
+        _ops = nullptr;
+    }
+}
+
+inline void unique_task::swap(unique_task& other) noexcept {
+    unique_task tmp(std::move(other));
+    other = std::move(*this);
+    *this = std::move(tmp);
+}
+
+
+} // namespace hadoken
+
+#endif // _HADOKEN_UNIQUE_TASK_HPP_
@@ -29,6 +29,7 @@
  */
 
 
+#include <array>
 #include <chrono>
 #include <hadoken/string/string_view.hpp>
 
@@ -0,0 +1,240 @@
+/**
+ * Copyright (c) 2019, Adrien Devresse <adrien.devresse@epfl.ch>
+ *
+ * Boost Software License - Version 1.0
+ *
+ * Permission is hereby granted, free of charge, to any person or organization
+ * obtaining a copy of the software and accompanying documentation covered by
+ * this license (the "Software") to use, reproduce, display, distribute,
+ * execute, and transmit the Software, and to prepare derivative works of the
+ * Software, and to permit third-parties to whom the Software is furnished to
+ * do so, all subject to the following:
+ *
+ * The copyright notices in the Software and this entire statement, including
+ * the above license grant, this restriction and the following disclaimer,
+ * must be included in all copies of the Software, in whole or in part, and
+ * all derivative works of the Software, unless such copies or derivative
+ * works are solely in the form of machine-executable object code generated by
+ * a source language processor.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+ * SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+ * FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ *
+ */
+#pragma once
+
+#include "../topology.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <thread>
+
+#include <dirent.h>
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace hadoken {
+
+namespace impl {
+
+inline bool read_first_line(const std::string& filename, std::string& line) {
+    std::ifstream file(filename);
+    return static_cast<bool>(std::getline(file, line));
+}
+
+// cpus usable by the current thread, empty if unknown
+inline std::vector<std::size_t> get_allowed_cpus() {
+    std::vector<std::size_t> cpus;
+#ifdef __linux__
+    cpu_set_t cpu_set;
+    CPU_ZERO(&cpu_set);
+    if (::sched_getaffinity(0, sizeof(cpu_set), &cpu_set) == 0) {
+        for (std::size_t cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+            if (CPU_ISSET(cpu, &cpu_set)) {
+                cpus.push_back(cpu);
+            }
+        }
+    }
+#endif
+    return cpus;
+}
+
+inline std::vector<std::size_t> filter_allowed_cpus(const std::vector<std::size_t>& cpus,
+                                                    const std::vector<std::size_t>& allowed) {
+    if (allowed.empty()) {
+        return cpus;
+    }
+
+    std::vector<std::size_t> res;
+    for (std::size_t cpu : cpus) {
+        if (std::binary_search(allowed.begin(), allowed.end(), cpu)) {
+            res.push_back(cpu);
+        }
+    }
+    return res;
+}
+
+} // namespace impl
+
+
+inline std::vector<std::size_t> parse_cpu_list(const std::string& cpu_list) {
+    std::vector<std::size_t> cpus;
+    std::istringstream input(cpu_list);
+    std::string token;
+
+    while (std::getline(input, token, ',')) {
+        if (token.empty() || token == "\n") {
+            continue;
+        }
+
+        const std::size_t dash = token.find('-');
+        const std::size_t first = std::strtoul(token.c_str(), nullptr, 10);
+        const std::size_t last = (dash == std::string::npos) ? (first) : (std::strtoul(token.c_str() + dash + 1, nullptr, 10));
+
+        for (std::size_t cpu = first; cpu <= last; ++cpu) {
+            cpus.push_back(cpu);
+        }
+    }
+
+    std::sort(cpus.begin(), cpus.end());
+    cpus.erase(std::unique(cpus.begin(), cpus.end()), cpus.end());
+    return cpus;
+}
+
+
+inline std::vector<numa_node> get_numa_nodes() {
+    const std::string node_dir = "/sys/devices/system/node";
+    const std::vector<std::size_t> allowed = impl::get_allowed_cpus();
+
+    std::vector<numa_node> nodes;
+
+    if (DIR* dir = ::opendir(node_dir.c_str())) {
+        while (struct dirent* entry = ::readdir(dir)) {
+            const std::string name(entry->d_name);
+            if (name.size() <= 4 || name.compare(0, 4, "node") != 0 ||
+                name.find_first_not_of("0123456789", 4) != std::string::npos) {
+                continue;
+            }
+
+            std::string cpu_list;
+            if (impl::read_first_line(node_dir + "/" + name + "/cpulist", cpu_list) == false) {
+                continue;
+            }
+
+            numa_node node;
+            node.id = std::strtoul(name.c_str() + 4, nullptr, 10);
+            node.cpus = impl::filter_allowed_cpus(parse_cpu_list(cpu_list), allowed);
+            if (node.cpus.empty() == false) {
+                nodes.push_back(std::move(node));
+            }
+        }
+        ::closedir(dir);
+    }
+
+    if (nodes.empty() == false) {
+        std::sort(nodes.begin(), nodes.end(), [](const numa_node& n1, const numa_node& n2) { return n1.id < n2.id; });
+        return nodes;
+    }
+
+    // no NUMA information: single node
+    numa_node single_node;
+    single_node.id = 0;
+
+    std::string online;
+    if (impl::read_first_line("/sys/devices/system/cpu/online", online)) {
+        single_node.cpus = impl::filter_allowed_cpus(parse_cpu_list(online), allowed);
+    }
+
+    if (single_node.cpus.empty()) {
+        const std::size_t n_cpus = std::max<std::size_t>(1, std::thread::hardware_concurrency());
+        for (std::size_t cpu = 0; cpu < n_cpus; ++cpu) {
+            single_node.cpus.push_back(cpu);
+        }
+    }
+
+    nodes.push_back(std::move(single_node));
+    return nodes;
+}
+
+
+inline std::size_t parse_cache_size(const std::string& cache_size) {
+    char* unit = nullptr;
+    const std::size_t size = std::strtoul(cache_size.c_str(), &unit, 10);
+
+    switch (*unit) {
+    case 'K':
+        return size << 10;
+    case 'M':
+        return size << 20;
+    case 'G':
+        return size << 30;
+    default:
+        return size;
+    }
+}
+
+
+inline std::size_t get_last_level_cache_size() {
+    const std::string cache_dir = "/sys/devices/system/cpu/cpu0/cache";
+
+    std::size_t last_level = 0, last_level_size = 0;
+
+    if (DIR* dir = ::opendir(cache_dir.c_str())) {
+        while (struct dirent* entry = ::readdir(dir)) {
+            const std::string name(entry->d_name);
+            if (name.size() <= 5 || name.compare(0, 5, "index") != 0) {
+                continue;
+            }
+
+            std::string level, type, size;
+            if (impl::read_first_line(cache_dir + "/" + name + "/level", level) == false ||
+                impl::read_first_line(cache_dir + "/" + name + "/type", type) == false ||
+                impl::read_first_line(cache_dir + "/" + name + "/size", size) == false || type == "Instruction") {
+                continue;
+            }
+
+            const std::size_t cache_level = std::strtoul(level.c_str(), nullptr, 10);
+            if (cache_level > last_level) {
+                last_level = cache_level;
+                last_level_size = parse_cache_size(size);
+            }
+        }
+        ::closedir(dir);
+    }
+
+    return last_level_size;
+}
+
+
+inline bool set_thread_affinity(const std::vector<std::size_t>& cpus) {
+#ifdef __linux__
+    if (cpus.empty()) {
+        return false;
+    }
+
+    cpu_set_t cpu_set;
+    CPU_ZERO(&cpu_set);
+    for (std::size_t cpu : cpus) {
+        if (cpu < CPU_SETSIZE) {
+            CPU_SET(cpu, &cpu_set);
+        }
+    }
+    return ::pthread_setaffinity_np(::pthread_self(), sizeof(cpu_set), &cpu_set) == 0;
+#else
+    (void)cpus;
+    return false;
+#endif
+}
+
+
+} // namespace hadoken
@@ -0,0 +1,88 @@
+/**
+ * Copyright (c) 2019, Adrien Devresse <adrien.devresse@epfl.ch>
+ *
+ * Boost Software License - Version 1.0
+ *
+ * Permission is hereby granted, free of charge, to any person or organization
+ * obtaining a copy of the software and accompanying documentation covered by
+ * this license (the "Software") to use, reproduce, display, distribute,
+ * execute, and transmit the Software, and to prepare derivative works of the
+ * Software, and to permit third-parties to whom the Software is furnished to
+ * do so, all subject to the following:
+ *
+ * The copyright notices in the Software and this entire statement, including
+ * the above license grant, this restriction and the following disclaimer,
+ * must be included in all copies of the Software, in whole or in part, and
+ * all derivative works of the Software, unless such copies or derivative
+ * works are solely in the form of machine-executable object code generated by
+ * a source language processor.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+ * SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+ * FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ *
+ */
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+
+
+namespace hadoken {
+
+///
+/// NUMA node of the machine and its cpus
+///
+struct numa_node {
+    std::size_t id;
+    std::vector<std::size_t> cpus;
+};
+
+
+///
+/// return the NUMA nodes of the machine, discovered from /sys/devices/system/node
+///
+/// only the cpus usable by the current thread are reported, nodes without cpu are skipped
+/// a machine without NUMA information is reported as a single node 0 with every online cpu
+///
+inline std::vector<numa_node> get_numa_nodes();
+
+
+///
+/// parse a linux cpu list, e.g. "0-3,8,10-11"
+///
+inline std::vector<std::size_t> parse_cpu_list(const std::string& cpu_list);
+
+
+///
+/// pin the current thread to a set of cpus
+///
+/// return false if the set is empty, if pinning failed, or if not supported on this platform
+///
+inline bool set_thread_affinity(const std::vector<std::size_t>& cpus);
+
+
+///
+/// parse a linux cache size, e.g. "32K" or "8M", in bytes
+///
+inline std::size_t parse_cache_size(const std::string& cache_size);
+
+
+///
+/// return the size in bytes of the last level data cache of the first cpu, discovered from /sys/devices/system/cpu
+///
+/// return 0 if unknown
+///
+inline std::size_t get_last_level_cache_size();
+
+
+} // namespace hadoken
+
+
+#include "impl/topology_impl.hpp"
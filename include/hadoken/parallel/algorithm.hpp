@@ -30,6 +30,10 @@
 #define _HADOKEN_PARALLEL_ALGORITHM_HPP_
 
 #include <algorithm>
+#include <cstddef>
+#include <iterator>
+#include <memory>
+#include <utility>
 
 
 namespace hadoken {
@@ -48,6 +52,10 @@ class sequential_execution_policy {};
 class parallel_execution_policy {};
 
 /// parallel execution allowed, vector execution allowed
+///
+/// fill, transform, count, reduce and the scans use vectorized kernels on contiguous
+/// ranges of arithmetic values, compiled for SSE2, AVX2 and AVX-512 and selected at runtime on x86.
+/// Sums and products are reassociated: floating point results can differ from par in the last bits
 class parallel_vector_execution_policy {};
 
 /// constexpr for sequential execution
@@ -59,16 +67,68 @@ constexpr parallel_execution_policy par{};
 /// constexpr for parallel vector execution
 constexpr parallel_vector_execution_policy par_vec{};
 
+///
+/// distribution of the elements of a range over the tasks of an algorithm
+///
+/// - static_split: one contiguous slice per task
+/// - dynamic: chunks of grain_size elements, claimed by the tasks from a shared counter
+/// - guided: claimed chunks of decreasing size, proportional to the remaining elements
+/// - automatic: claimed chunks sized for a few chunks per task, at least grain_size elements
+///
+/// static_split has the lowest overhead, the other modes balance skewed workloads
+///
+enum class partitioner { static_split, dynamic, guided, automatic };
+
 ///
 /// Extended policies
 ///
+
+///
+/// parallel execution on a given executor, e.g. a pool dedicated to the algorithms
+///
+/// max_workers bounds the number of tasks an algorithm is split into,
+/// 0 for the number of threads of the executor
+///
+/// grain_size is the minimum number of elements processed by a task:
+/// small ranges are split in fewer tasks, or processed inline by the calling thread
+///
+/// the partitioner distributes the elements over the tasks, automatic by default
+///
 template <typename Executor>
 class parallel_shared_exec_policy {
   public:
-    inline parallel_shared_exec_policy(std::shared_ptr<Executor> executor) : _exec(std::move(executor)) {}
+    inline parallel_shared_exec_policy(std::shared_ptr<Executor> executor, std::size_t max_workers = 0,
+                                       std::size_t grain_size = 1, partitioner partition = partitioner::automatic)
+        : _exec(std::move(executor)), _max_workers(max_workers), _grain_size((grain_size == 0) ? (1) : (grain_size)),
+          _partitioner(partition) {}
+
+    inline Executor& executor() const { return *_exec; }
+
+    inline std::size_t max_workers() const { return _max_workers; }
+
+    inline std::size_t grain_size() const { return _grain_size; }
+
+    inline partitioner get_partitioner() const { return _partitioner; }
+
+    inline parallel_shared_exec_policy& set_max_workers(std::size_t max_workers) {
+        _max_workers = max_workers;
+        return *this;
+    }
+
+    inline parallel_shared_exec_policy& set_grain_size(std::size_t grain_size) {
+        _grain_size = (grain_size == 0) ? (1) : (grain_size);
+        return *this;
+    }
+
+    inline parallel_shared_exec_policy& set_partitioner(partitioner partition) {
+        _partitioner = partition;
+        return *this;
+    }
 
   protected:
     std::shared_ptr<Executor> _exec;
+    std::size_t _max_workers, _grain_size;
+    partitioner _partitioner;
 };
 
 ///
@@ -107,6 +167,13 @@ OutputIterator transform(ExecutionPolicy&& policy, InputIterator1 first1, InputI
 template <class ExecutionPolicy, class InputIt, class OutputIt, class UnaryOperation>
 OutputIt transform(ExecutionPolicy&& policy, InputIt first1, InputIt last1, OutputIt d_first, UnaryOperation unary_op);
 
+/// parallel n-ary transform algorithm
+///
+/// d_first[i] = op(first1[i], firsts[i]...) for every i in [0, last1 - first1)
+template <class ExecutionPolicy, class InputIterator1, class OutputIterator, class NaryOperation, class... InputIterators>
+OutputIterator zip_transform(ExecutionPolicy&& policy, InputIterator1 first1, InputIterator1 last1, OutputIterator d_first,
+                             NaryOperation op, InputIterators... firsts);
+
 
 
 /// parallel all_of algorithm
@@ -123,6 +190,137 @@ inline bool none_of(ExecutionPolicy&& policy, InputIterator first, InputIterator
 
 
 
+/// parallel find algorithm
+///
+/// the find algorithms return the leftmost match, the search stops as soon as it is known
+template <class ExecutionPolicy, class InputIterator, class T>
+InputIterator find(ExecutionPolicy&& policy, InputIterator first, InputIterator last, const T& value);
+
+/// parallel find_if algorithm
+template <class ExecutionPolicy, class InputIterator, class UnaryPredicate>
+InputIterator find_if(ExecutionPolicy&& policy, InputIterator first, InputIterator last, UnaryPredicate p);
+
+/// parallel find_if_not algorithm
+template <class ExecutionPolicy, class InputIterator, class UnaryPredicate>
+InputIterator find_if_not(ExecutionPolicy&& policy, InputIterator first, InputIterator last, UnaryPredicate p);
+
+/// parallel find_first_of algorithm
+template <class ExecutionPolicy, class InputIterator, class ForwardIterator>
+InputIterator find_first_of(ExecutionPolicy&& policy, InputIterator first, InputIterator last, ForwardIterator s_first,
+                            ForwardIterator s_last);
+
+/// parallel find_first_of algorithm with binary predicate
+template <class ExecutionPolicy, class InputIterator, class ForwardIterator, class BinaryPredicate>
+InputIterator find_first_of(ExecutionPolicy&& policy, InputIterator first, InputIterator last, ForwardIterator s_first,
+                            ForwardIterator s_last, BinaryPredicate p);
+
+/// parallel adjacent_find algorithm
+template <class ExecutionPolicy, class ForwardIterator>
+ForwardIterator adjacent_find(ExecutionPolicy&& policy, ForwardIterator first, ForwardIterator last);
+
+/// parallel adjacent_find algorithm with binary predicate
+template <class ExecutionPolicy, class ForwardIterator, class BinaryPredicate>
+ForwardIterator adjacent_find(ExecutionPolicy&& policy, ForwardIterator first, ForwardIterator last, BinaryPredicate p);
+
+/// parallel mismatch algorithm
+template <class ExecutionPolicy, class InputIterator1, class InputIterator2>
+std::pair<InputIterator1, InputIterator2> mismatch(ExecutionPolicy&& policy, InputIterator1 first1, InputIterator1 last1,
+                                                   InputIterator2 first2);
+
+/// parallel mismatch algorithm on two ranges
+template <class ExecutionPolicy, class InputIterator1, class InputIterator2>
+std::pair<InputIterator1, InputIterator2> mismatch(ExecutionPolicy&& policy, InputIterator1 first1, InputIterator1 last1,
+                                                   InputIterator2 first2, InputIterator2 last2);
+
+/// parallel mismatch algorithm on two ranges with binary predicate
+template <class ExecutionPolicy, class InputIterator1, class InputIterator2, class BinaryPredicate>
+std::pair<InputIterator1, InputIterator2> mismatch(ExecutionPolicy&& policy, InputIterator1 first1, InputIterator1 last1,
+                                                   InputIterator2 first2, InputIterator2 last2, BinaryPredicate p);
+
+
+
+
+/// parallel copy_if algorithm
+template <class ExecutionPolicy, class InputIterator, class OutputIterator, class UnaryPredicate>
+OutputIterator copy_if(ExecutionPolicy&& policy, InputIterator first, InputIterator last, OutputIterator d_first,
+                       UnaryPredicate p);
+
+/// parallel remove_if algorithm
+template <class ExecutionPolicy, class ForwardIterator, class UnaryPredicate>
+ForwardIterator remove_if(ExecutionPolicy&& policy, ForwardIterator first, ForwardIterator last, UnaryPredicate p);
+
+/// parallel partition algorithm
+///
+/// the parallel partition is stable
+template <class ExecutionPolicy, class ForwardIterator, class UnaryPredicate>
+ForwardIterator partition(ExecutionPolicy&& policy, ForwardIterator first, ForwardIterator last, UnaryPredicate p);
+
+/// parallel stable_partition algorithm
+template <class ExecutionPolicy, class BidirectionalIterator, class UnaryPredicate>
+BidirectionalIterator stable_partition(ExecutionPolicy&& policy, BidirectionalIterator first, BidirectionalIterator last,
+                                       UnaryPredicate p);
+
+
+
+///
+/// merge and set operations
+///
+/// the output is split in parts of equal size on the merge path of the two sorted inputs.
+/// Set operations never split the equivalent elements of the inputs
+
+/// parallel merge algorithm
+template <class ExecutionPolicy, class InputIterator1, class InputIterator2, class OutputIterator>
+OutputIterator merge(ExecutionPolicy&& policy, InputIterator1 first1, InputIterator1 last1, InputIterator2 first2,
+                     InputIterator2 last2, OutputIterator d_first);
+
+/// parallel merge algorithm with comparator
+template <class ExecutionPolicy, class InputIterator1, class InputIterator2, class OutputIterator, class Compare>
+OutputIterator merge(ExecutionPolicy&& policy, InputIterator1 first1, InputIterator1 last1, InputIterator2 first2,
+                     InputIterator2 last2, OutputIterator d_first, Compare comp);
+
+/// parallel inplace_merge algorithm
+///
+/// the range is moved to a buffer, then merged back in parallel
+template <class ExecutionPolicy, class BidirectionalIterator>
+void inplace_merge(ExecutionPolicy&& policy, BidirectionalIterator first, BidirectionalIterator middle,
+                   BidirectionalIterator last);
+
+/// parallel inplace_merge algorithm with comparator
+template <class ExecutionPolicy, class BidirectionalIterator, class Compare>
+void inplace_merge(ExecutionPolicy&& policy, BidirectionalIterator first, BidirectionalIterator middle,
+                   BidirectionalIterator last, Compare comp);
+
+/// parallel set_union algorithm
+template <class ExecutionPolicy, class InputIterator1, class InputIterator2, class OutputIterator>
+OutputIterator set_union(ExecutionPolicy&& policy, InputIterator1 first1, InputIterator1 last1, InputIterator2 first2,
+                         InputIterator2 last2, OutputIterator d_first);
+
+/// parallel set_union algorithm with comparator
+template <class ExecutionPolicy, class InputIterator1, class InputIterator2, class OutputIterator, class Compare>
+OutputIterator set_union(ExecutionPolicy&& policy, InputIterator1 first1, InputIterator1 last1, InputIterator2 first2,
+                         InputIterator2 last2, OutputIterator d_first, Compare comp);
+
+/// parallel set_intersection algorithm
+template <class ExecutionPolicy, class InputIterator1, class InputIterator2, class OutputIterator>
+OutputIterator set_intersection(ExecutionPolicy&& policy, InputIterator1 first1, InputIterator1 last1, InputIterator2 first2,
+                                InputIterator2 last2, OutputIterator d_first);
+
+/// parallel set_intersection algorithm with comparator
+template <class ExecutionPolicy, class InputIterator1, class InputIterator2, class OutputIterator, class Compare>
+OutputIterator set_intersection(ExecutionPolicy&& policy, InputIterator1 first1, InputIterator1 last1, InputIterator2 first2,
+                                InputIterator2 last2, OutputIterator d_first, Compare comp);
+
+/// parallel set_difference algorithm
+template <class ExecutionPolicy, class InputIterator1, class InputIterator2, class OutputIterator>
+OutputIterator set_difference(ExecutionPolicy&& policy, InputIterator1 first1, InputIterator1 last1, InputIterator2 first2,
+                              InputIterator2 last2, OutputIterator d_first);
+
+/// parallel set_difference algorithm with comparator
+template <class ExecutionPolicy, class InputIterator1, class InputIterator2, class OutputIterator, class Compare>
+OutputIterator set_difference(ExecutionPolicy&& policy, InputIterator1 first1, InputIterator1 last1, InputIterator2 first2,
+                              InputIterator2 last2, OutputIterator d_first, Compare comp);
+
+
 
 /// sort algorithm
 template <class ExecutionPolicy, class RandomIt>
@@ -132,10 +330,36 @@ void sort(ExecutionPolicy&& policy, RandomIt first, RandomIt last);
 template <class ExecutionPolicy, class RandomIt, class Compare>
 void sort(ExecutionPolicy&& policy, RandomIt first, RandomIt last, Compare comp);
 
+/// stable_sort algorithm
+///
+/// merge sort: sorted runs are merged by pairs with parallel merges
+template <class ExecutionPolicy, class RandomIt>
+void stable_sort(ExecutionPolicy&& policy, RandomIt first, RandomIt last);
+
+/// stable_sort algorithm with comparator
+template <class ExecutionPolicy, class RandomIt, class Compare>
+void stable_sort(ExecutionPolicy&& policy, RandomIt first, RandomIt last, Compare comp);
+
+/// Extension: radix_sort algorithm
+///
+/// stable LSD radix sort of integral or floating point values
+template <class ExecutionPolicy, class RandomIt>
+void radix_sort(ExecutionPolicy&& policy, RandomIt first, RandomIt last);
+
+/// Extension: radix_sort_by_key algorithm
+///
+/// stable LSD radix sort on the integral or floating point key returned by key_function( value )
+template <class ExecutionPolicy, class RandomIt, class KeyFunction>
+void radix_sort_by_key(ExecutionPolicy&& policy, RandomIt first, RandomIt last, KeyFunction key_function);
+
 
 
 ///
 /// numerics
+///
+/// scans are single pass: the range is processed by tiles of fixed size, scanned in cache,
+/// results are reproducible and the output range can be the input range
+
 /// inclusive scan algorithm
 template <class ExecutionPolicy, class InputIt, class OutputIt>
 OutputIt inclusive_scan(ExecutionPolicy&& policy, InputIt first, InputIt last, OutputIt d_first);
@@ -144,6 +368,65 @@ OutputIt inclusive_scan(ExecutionPolicy&& policy, InputIt first, InputIt last, O
 template <class ExecutionPolicy, class InputIt, class OutputIt, class BinaryOperation>
 OutputIt inclusive_scan(ExecutionPolicy&& policy, InputIt first, InputIt last, OutputIt d_first, BinaryOperation binary_op);
 
+/// inclusive scan algorithm binary op with initial value
+template <class ExecutionPolicy, class InputIt, class OutputIt, class BinaryOperation, class T>
+OutputIt inclusive_scan(ExecutionPolicy&& policy, InputIt first, InputIt last, OutputIt d_first, BinaryOperation binary_op,
+                        T init);
+
+/// exclusive scan algorithm
+template <class ExecutionPolicy, class InputIt, class OutputIt, class T>
+OutputIt exclusive_scan(ExecutionPolicy&& policy, InputIt first, InputIt last, OutputIt d_first, T init);
+
+/// exclusive scan algorithm binary op
+template <class ExecutionPolicy, class InputIt, class OutputIt, class T, class BinaryOperation>
+OutputIt exclusive_scan(ExecutionPolicy&& policy, InputIt first, InputIt last, OutputIt d_first, T init,
+                        BinaryOperation binary_op);
+
+/// transform inclusive scan algorithm
+template <class ExecutionPolicy, class InputIt, class OutputIt, class BinaryOperation, class UnaryOperation>
+OutputIt transform_inclusive_scan(ExecutionPolicy&& policy, InputIt first, InputIt last, OutputIt d_first,
+                                  BinaryOperation binary_op, UnaryOperation unary_op);
+
+/// transform inclusive scan algorithm with initial value
+template <class ExecutionPolicy, class InputIt, class OutputIt, class BinaryOperation, class UnaryOperation, class T>
+OutputIt transform_inclusive_scan(ExecutionPolicy&& policy, InputIt first, InputIt last, OutputIt d_first,
+                                  BinaryOperation binary_op, UnaryOperation unary_op, T init);
+
+/// transform exclusive scan algorithm
+template <class ExecutionPolicy, class InputIt, class OutputIt, class T, class BinaryOperation, class UnaryOperation>
+OutputIt transform_exclusive_scan(ExecutionPolicy&& policy, InputIt first, InputIt last, OutputIt d_first, T init,
+                                  BinaryOperation binary_op, UnaryOperation unary_op);
+
+
+/// reduce algorithm
+///
+/// the range is split in fixed blocks, whose partial results are combined in order:
+/// results are reproducible for a given number of workers
+template <class ExecutionPolicy, class InputIt>
+typename std::iterator_traits<InputIt>::value_type reduce(ExecutionPolicy&& policy, InputIt first, InputIt last);
+
+/// reduce algorithm with initial value
+template <class ExecutionPolicy, class InputIt, class T>
+T reduce(ExecutionPolicy&& policy, InputIt first, InputIt last, T init);
+
+/// reduce algorithm with initial value and binary op
+template <class ExecutionPolicy, class InputIt, class T, class BinaryOperation>
+T reduce(ExecutionPolicy&& policy, InputIt first, InputIt last, T init, BinaryOperation binary_op);
+
+/// transform reduce algorithm, inner product
+template <class ExecutionPolicy, class InputIt1, class InputIt2, class T>
+T transform_reduce(ExecutionPolicy&& policy, InputIt1 first1, InputIt1 last1, InputIt2 first2, T init);
+
+/// transform reduce algorithm, binary transform
+template <class ExecutionPolicy, class InputIt1, class InputIt2, class T, class BinaryOperation1, class BinaryOperation2>
+T transform_reduce(ExecutionPolicy&& policy, InputIt1 first1, InputIt1 last1, InputIt2 first2, T init,
+                   BinaryOperation1 reduce_op, BinaryOperation2 transform_op);
+
+/// transform reduce algorithm, unary transform
+template <class ExecutionPolicy, class InputIt, class T, class BinaryOperation, class UnaryOperation>
+T transform_reduce(ExecutionPolicy&& policy, InputIt first, InputIt last, T init, BinaryOperation reduce_op,
+                   UnaryOperation transform_op);
+
 
 
 /// Extension: for_range_ algorithm
@@ -29,8 +29,13 @@
 #ifndef _HADOKEN_OMP_ALGORITHM_BITS_HPP_
 #define _HADOKEN_OMP_ALGORITHM_BITS_HPP_
 
+#include <algorithm>
+#include <atomic>
 #include <cstdint>
+#include <exception>
+#include <functional>
 #include <iterator>
+#include <memory>
 #include <stdexcept>
 #include <type_traits>
 
@@ -38,12 +43,16 @@
 #include <hadoken/containers/small_vector.hpp>
 #include <hadoken/executor/system_executor.hpp>
 #include <hadoken/parallel/algorithm.hpp>
-#include <hadoken/thread/latch.hpp>
+#include <hadoken/thread/future.hpp>
 #include <hadoken/utility/range.hpp>
 
 #include <hadoken/parallel/bits/parallel_algorithm_generics.hpp>
+#include <hadoken/parallel/bits/parallel_find_generic.hpp>
+#include <hadoken/parallel/bits/parallel_merge_generic.hpp>
 #include <hadoken/parallel/bits/parallel_none_any_all_generic.hpp>
 #include <hadoken/parallel/bits/parallel_numeric_generic.hpp>
+#include <hadoken/parallel/bits/parallel_partition_generic.hpp>
+#include <hadoken/parallel/bits/parallel_radix_sort_generic.hpp>
 #include <hadoken/parallel/bits/parallel_sort_generic.hpp>
 #include <hadoken/parallel/bits/parallel_transform_generic.hpp>
 
@@ -62,49 +71,240 @@ class parallel_vector_execution_policy;
 
 namespace detail {
 
-inline int __get_number_executor() {
+// number of threads used by the basic parallel policies
+inline std::size_t __default_number_executor() {
 #ifndef __HADOKEN_ALGORITHM_ENFORCE_SERIAL
-    // TODO : should be configurable parameter, extracted from execution_policy
-    return std::thread::hardware_concurrency();
+    return std::max<std::size_t>(1, std::thread::hardware_concurrency());
 #else
     return 1;
 #endif
 }
 
-template <typename Function>
-inline void __execute_grid(int num_executor, Function fun) {
-#ifndef __HADOKEN_ALGORITHM_ENFORCE_SERIAL
+// number of threads of an executor providing get_thread_count()
+template <typename Executor>
+inline auto __executor_concurrency(const Executor& exec, int) -> decltype(std::size_t(exec.get_thread_count())) {
+    return std::max<std::size_t>(1, exec.get_thread_count());
+}
 
-    system_executor sys_exec;
-    std::vector<std::future<void>> futures;
+template <typename Executor>
+inline std::size_t __executor_concurrency(const Executor&, long) {
+    return __default_number_executor();
+}
 
+// number of tasks used to process n_elems elements with a policy
+template <typename ExecPolicy>
+inline std::size_t __grid_size(const ExecPolicy& policy, std::size_t n_elems) {
+    (void)policy;
+    return std::max<std::size_t>(1, std::min(n_elems, __default_number_executor()));
+}
 
+template <typename Executor>
+inline std::size_t __grid_size(const parallel_shared_exec_policy<Executor>& policy, std::size_t n_elems) {
+    const std::size_t max_workers =
+        (policy.max_workers() != 0) ? (policy.max_workers()) : (__executor_concurrency(policy.executor(), 0));
+    return std::max<std::size_t>(1, std::min(max_workers, n_elems / policy.grain_size()));
+}
 
-    for (int id = 0; id < num_executor; ++id) {
-        futures.emplace_back(std::move(sys_exec.twoway_execute([id, num_executor, &fun] { return fun(id, num_executor); })));
+
+// partitioner and grain size of a policy
+template <typename ExecPolicy>
+inline partitioner __partitioner_of(const ExecPolicy&) {
+    return partitioner::automatic;
+}
+
+template <typename Executor>
+inline partitioner __partitioner_of(const parallel_shared_exec_policy<Executor>& policy) {
+    return policy.get_partitioner();
+}
+
+template <typename ExecPolicy>
+inline std::size_t __grain_size_of(const ExecPolicy&) {
+    return 1;
+}
+
+template <typename Executor>
+inline std::size_t __grain_size_of(const parallel_shared_exec_policy<Executor>& policy) {
+    return policy.grain_size();
+}
+
+
+// distribution of the indexes [0, n_elems) in chunks claimed concurrently by the tasks of a grid
+// for the dynamic, guided and automatic partitioners
+class __chunk_scheduler {
+  public:
+    inline __chunk_scheduler(std::size_t n_elems, std::size_t n_tasks, std::size_t grain, partitioner mode)
+        : _next(0), _n_elems(n_elems), _n_tasks(std::max<std::size_t>(1, n_tasks)), _grain(std::max<std::size_t>(1, grain)),
+          _chunk(_grain), _mode(mode) {
+        if (_mode == partitioner::automatic) {
+            // a few chunks per task: enough to balance, few enough to keep the counter cold
+            _chunk = std::max(_grain, _n_elems / (_n_tasks * 8));
+        }
     }
 
-    for (auto& f : futures) {
-        f.get();
+    /// claim the next chunk [first, last), return false when the range is exhausted
+    inline bool next(std::size_t& first, std::size_t& last) {
+        if (_mode == partitioner::guided) {
+            std::size_t current = _next.load(std::memory_order_relaxed);
+            while (current < _n_elems) {
+                const std::size_t chunk = std::max(_grain, (_n_elems - current) / (_n_tasks * 2));
+                const std::size_t end = std::min(_n_elems, current + chunk);
+                if (_next.compare_exchange_weak(current, end, std::memory_order_relaxed)) {
+                    first = current;
+                    last = end;
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        if (_next.load(std::memory_order_relaxed) >= _n_elems) {
+            return false;
+        }
+
+        first = _next.fetch_add(_chunk, std::memory_order_relaxed);
+        if (first >= _n_elems) {
+            return false;
+        }
+        last = std::min(_n_elems, first + _chunk);
+        return true;
+    }
+
+  private:
+    std::atomic<std::size_t> _next;
+    std::size_t _n_elems, _n_tasks, _grain, _chunk;
+    partitioner _mode;
+};
+
+
+// one submission for the tasks [1, n) when the executor supports it
+template <typename Executor, typename Function>
+inline auto __bulk_submit(Executor& exec, std::size_t n, Function& fun, int)
+    -> decltype(exec.bulk_twoway_execute(n, fun)) {
+    return exec.bulk_twoway_execute(n - 1, [&fun](std::size_t id) { fun(id + 1); });
+}
+
+// otherwise one task per index, the first exception is reported by the returned future
+template <typename Executor, typename Function>
+inline hadoken::thread::future<void> __bulk_submit(Executor& exec, std::size_t n, Function& fun, long) {
+    struct bulk_state {
+        bulk_state(std::size_t n_tasks) : remaining(n_tasks), failed(false) {}
+
+        std::atomic<std::size_t> remaining;
+        std::atomic<bool> failed;
+        std::exception_ptr error;
+        hadoken::thread::promise<void> done;
+    };
+
+    std::shared_ptr<bulk_state> state = std::make_shared<bulk_state>(n - 1);
+    hadoken::thread::future<void> res = state->done.get_future();
+
+    for (std::size_t id = 1; id < n; ++id) {
+        exec.execute([&fun, state, id]() {
+            try {
+                fun(id);
+            } catch (...) {
+                if (state->failed.exchange(true) == false) {
+                    state->error = std::current_exception();
+                }
+            }
+            if (state->remaining.fetch_sub(1) == 1) {
+                if (state->error) {
+                    state->done.set_exception(state->error);
+                } else {
+                    state->done.set_value();
+                }
+            }
+        });
     }
+    return res;
+}
 
+template <typename Executor, typename Function>
+inline void __execute_grid_on(Executor& exec, int num_executor, Function& fun) {
+#ifndef __HADOKEN_ALGORITHM_ENFORCE_SERIAL
+    // a single task is executed by the calling thread
+    if (num_executor <= 1) {
+        fun(0, 1);
+        return;
+    }
+
+    // the calling thread executes the first task while the others are in flight
+    auto grid_task = [num_executor, &fun](std::size_t id) { fun(static_cast<int>(id), num_executor); };
+    auto others = __bulk_submit(exec, static_cast<std::size_t>(num_executor), grid_task, 0);
+
+    std::exception_ptr error;
+    try {
+        grid_task(0);
+    } catch (...) {
+        error = std::current_exception();
+    }
+
+    others.wait();
+    if (error) {
+        std::rethrow_exception(error);
+    }
+    others.get();
 #else
+    (void)exec;
     for (int id = 0; id < num_executor; ++id) {
         fun(id, num_executor);
     }
 #endif
 }
 
+// execute fun(id, num_executor) for every id in [0, num_executor) on the executor of the policy
+template <typename ExecPolicy, typename Function>
+inline void __execute_grid(const ExecPolicy& policy, int num_executor, Function fun) {
+    (void)policy;
+    system_executor sys_exec;
+    __execute_grid_on(sys_exec, num_executor, fun);
+}
+
+template <typename Executor, typename Function>
+inline void __execute_grid(const parallel_shared_exec_policy<Executor>& policy, int num_executor, Function fun) {
+    __execute_grid_on(policy.executor(), num_executor, fun);
+}
+
 /// for_each algorithm
-template <typename Iterator, typename Function>
-inline void _omp_parallel_for_range(Iterator begin_it, Iterator end_it, Function fun) {
-    range<Iterator> global_range(begin_it, end_it);
+template <typename ExecPolicy, typename Iterator, typename Function>
+inline void _omp_parallel_for_range(const ExecPolicy& policy, Iterator begin_it, Iterator end_it, Function fun) {
+    using iterator_category = typename std::iterator_traits<Iterator>::iterator_category;
 
-    const int num_exec = __get_number_executor();
+    const std::size_t n_elems = static_cast<std::size_t>(std::distance(begin_it, end_it));
+    const int num_exec = static_cast<int>(__grid_size(policy, n_elems));
+
+    // serial cutoff: small ranges never leave the calling thread
+    if (num_exec <= 1) {
+        fun(begin_it, end_it);
+        return;
+    }
 
-    __execute_grid(num_exec, [&](int id, int num_executor) {
-        range<Iterator> my_range = take_splice(global_range, id, num_executor);
-        fun(my_range.begin(), my_range.end());
+    // chunks are only claimed on random access ranges, where positioning is cheap
+    const partitioner mode = std::is_base_of<std::random_access_iterator_tag, iterator_category>::value
+                                 ? (__partitioner_of(policy))
+                                 : (partitioner::static_split);
+
+    if (mode == partitioner::static_split) {
+        range<Iterator> global_range(begin_it, end_it);
+
+        __execute_grid(policy, num_exec, [&](int id, int num_executor) {
+            range<Iterator> my_range = take_splice(global_range, id, num_executor);
+            fun(my_range.begin(), my_range.end());
+        });
+        return;
+    }
+
+    __chunk_scheduler scheduler(n_elems, static_cast<std::size_t>(num_exec), __grain_size_of(policy), mode);
+
+    __execute_grid(policy, num_exec, [&](int, int) {
+        std::size_t first, last;
+        while (scheduler.next(first, last)) {
+            Iterator chunk_begin = begin_it, chunk_end;
+            std::advance(chunk_begin, first);
+            chunk_end = chunk_begin;
+            std::advance(chunk_end, last - first);
+            fun(chunk_begin, chunk_end);
+        }
     });
 }
 
@@ -116,7 +316,7 @@ inline void _omp_parallel_for_range(Iterator begin_it, Iterator end_it, Function
 template <typename ExecPolicy, typename Iterator, typename RangeFunction>
 inline void for_range(ExecPolicy&& policy, Iterator begin_it, Iterator end_it, RangeFunction fun) {
     if (detail::is_parallel_policy(policy)) {
-        detail::_omp_parallel_for_range(begin_it, end_it, fun);
+        detail::_omp_parallel_for_range(policy, begin_it, end_it, fun);
         return;
     }
 
@@ -135,22 +335,15 @@ typename std::iterator_traits<InputIterator>::difference_type count_if(Execution
         "parallel::count requires random_access_iterator");
 
     if (detail::is_parallel_policy(policy)) {
-
-        const std::size_t nelems = std::distance(first, last);
-        std::atomic<uint64_t> counter(0);
-
-        const int number_executor = detail::__get_number_executor();
-
-        detail::__execute_grid(number_executor, [&](int id, int number_executor) {
-            std::size_t nelem_per_slice = nelems / number_executor;
-
-            InputIterator my_begin = first + (id * nelem_per_slice);
-            InputIterator my_end = (((id + 1) == number_executor) ? (last) : (my_begin + nelem_per_slice));
-
-            counter += std::count_if(my_begin, my_end, p);
-        });
-
-        return counter_type(counter.load());
+        // per block partial counts, no shared counter
+        auto is_match = [&p](typename std::iterator_traits<InputIterator>::reference v) -> counter_type {
+            return (p(v)) ? (1) : (0);
+        };
+        std::plus<counter_type> sum;
+
+        return detail::_internal_transform_reduce(
+            policy, detail::__unary_cursor<InputIterator, decltype(is_match)>{first, &is_match},
+            static_cast<std::size_t>(std::distance(first, last)), counter_type(0), sum);
     } else {
         return std::count_if(first, last, p);
     }
@@ -34,6 +34,7 @@
 
 
 #include "parallel_generic_utils.hpp"
+#include "parallel_simd_generic.hpp"
 
 
 namespace hadoken {
@@ -55,14 +56,34 @@ inline void for_each(ExecPolicy&& policy, Iterator begin_it, Iterator end_it, Fu
 }
 
 
-// reimplement fill using for_each
+namespace detail {
+
+// vectorized fill of every slice
 template <typename ExecutionPolicy, class ForwardIterator, class T>
-void fill(ExecutionPolicy&& policy, ForwardIterator first, ForwardIterator last, const T& val) {
+void _internal_fill(ExecutionPolicy&& policy, ForwardIterator first, ForwardIterator last, const T& val, std::true_type) {
+    for_range(std::forward<ExecutionPolicy>(policy), first, last, [&val](ForwardIterator sub_begin, ForwardIterator sub_end) {
+        __simd_fill(sub_begin, static_cast<std::size_t>(std::distance(sub_begin, sub_end)), val);
+    });
+}
+
+template <typename ExecutionPolicy, class ForwardIterator, class T>
+void _internal_fill(ExecutionPolicy&& policy, ForwardIterator first, ForwardIterator last, const T& val, std::false_type) {
     using value_type = typename std::iterator_traits<ForwardIterator>::value_type;
 
     ::hadoken::parallel::for_each(std::forward<ExecutionPolicy>(policy), first, last, [&val](value_type& elem) { elem = val; });
 }
 
+} // namespace detail
+
+
+// reimplement fill using for_each, vectorized with par_vec
+template <typename ExecutionPolicy, class ForwardIterator, class T>
+void fill(ExecutionPolicy&& policy, ForwardIterator first, ForwardIterator last, const T& val) {
+    detail::_internal_fill(std::forward<ExecutionPolicy>(policy), first, last, val,
+                           std::integral_constant<bool, detail::__is_vector_policy<ExecutionPolicy>::value &&
+                                                            detail::__is_simd_iterator<ForwardIterator>::value>());
+}
+
 
 //  reimplement fill_n using fill
 template <typename ExecutionPolicy, class ForwardIterator, class Size, class T>
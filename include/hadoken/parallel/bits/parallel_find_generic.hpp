@@ -0,0 +1,284 @@
+/**
+ * Copyright (c) 2016, Adrien Devresse <adrien.devresse@epfl.ch>
+ *
+ * Boost Software License - Version 1.0
+ *
+ * Permission is hereby granted, free of charge, to any person or organization
+ * obtaining a copy of the software and accompanying documentation covered by
+ * this license (the "Software") to use, reproduce, display, distribute,
+ * execute, and transmit the Software, and to prepare derivative works of the
+ * Software, and to permit third-parties to whom the Software is furnished to
+ * do so, all subject to the following:
+ *
+ * The copyright notices in the Software and this entire statement, including
+ * the above license grant, this restriction and the following disclaimer,
+ * must be included in all copies of the Software, in whole or in part, and
+ * all derivative works of the Software, unless such copies or derivative
+ * works are solely in the form of machine-executable object code generated by
+ * a source language processor.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+ * SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+ * FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ *
+ */
+#ifndef PARALLEL_FIND_GENERIC_HPP
+#define PARALLEL_FIND_GENERIC_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <functional>
+#include <iterator>
+#include <type_traits>
+#include <utility>
+
+#include <hadoken/parallel/algorithm.hpp>
+
+
+#include "parallel_generic_utils.hpp"
+
+
+namespace hadoken {
+
+
+namespace parallel {
+
+
+namespace detail {
+
+// elements searched between two checks of the shared result
+constexpr std::size_t __search_block_size = 2048;
+
+
+template <typename Iterator>
+struct __is_random_access
+    : std::is_base_of<std::random_access_iterator_tag, typename std::iterator_traits<Iterator>::iterator_category> {};
+
+
+// index of a match in [0, n_elems), n_elems if there is none
+//
+// find_in_block(begin, end) returns the index of the first match in [begin, end), or end.
+// Blocks are claimed in order by the tasks, the matches are merged in an atomic minimum:
+// - leftmost: the first match is returned, blocks after a match are never searched
+// - otherwise any match is returned, all the tasks stop at their next block after a match
+template <class ExecutionPolicy, class BlockFind>
+std::size_t _internal_find_index(const ExecutionPolicy& policy, std::size_t n_elems, BlockFind find_in_block,
+                                 bool leftmost) {
+    const std::size_t n_blocks = (n_elems + __search_block_size - 1) / __search_block_size;
+    const std::size_t num_tasks = std::min(__num_tasks(policy, n_elems), n_blocks);
+
+    if (num_tasks <= 1) {
+        return find_in_block(std::size_t(0), n_elems);
+    }
+
+    std::atomic<std::size_t> next_block(0), result(n_elems);
+
+    __execute_grid(policy, static_cast<int>(num_tasks), [&](int, int) {
+        std::size_t block;
+        while ((block = next_block.fetch_add(1, std::memory_order_relaxed)) < n_blocks) {
+            const std::size_t begin = block * __search_block_size;
+            const std::size_t end = std::min(n_elems, begin + __search_block_size);
+
+            const std::size_t current = result.load(std::memory_order_relaxed);
+            if (current <= begin || (leftmost == false && current != n_elems)) {
+                return;
+            }
+
+            const std::size_t found = find_in_block(begin, end);
+            if (found != end) {
+                std::size_t best = result.load(std::memory_order_relaxed);
+                while (found < best && result.compare_exchange_weak(best, found, std::memory_order_relaxed) == false) {
+                }
+                // the next blocks of this task are after the match
+                return;
+            }
+        }
+    });
+
+    return result.load();
+}
+
+
+// true if pred matches an element of [first, last), parallel early exit search
+template <class ExecutionPolicy, class Iterator, class UnaryPredicate>
+bool _internal_any_match(const ExecutionPolicy& policy, Iterator first, Iterator last, UnaryPredicate& p) {
+    const std::size_t n_elems = static_cast<std::size_t>(std::distance(first, last));
+
+    return _internal_find_index(policy, n_elems,
+                                [&](std::size_t begin, std::size_t end) {
+                                    return static_cast<std::size_t>(std::distance(
+                                        first, std::find_if(get_end_iterator(first, begin), get_end_iterator(first, end), p)));
+                                },
+                                false) != n_elems;
+}
+
+} // namespace detail
+
+
+
+/// parallel find_if algorithm
+template <class ExecutionPolicy, class InputIterator, class UnaryPredicate>
+InputIterator find_if(ExecutionPolicy&& policy, InputIterator first, InputIterator last, UnaryPredicate p) {
+    if (detail::is_parallel_policy(policy) && detail::__is_random_access<InputIterator>::value) {
+        const std::size_t n_elems = static_cast<std::size_t>(std::distance(first, last));
+
+        return detail::get_end_iterator(
+            first, detail::_internal_find_index(policy, n_elems,
+                                                [&](std::size_t begin, std::size_t end) {
+                                                    return static_cast<std::size_t>(std::distance(
+                                                        first, std::find_if(detail::get_end_iterator(first, begin),
+                                                                            detail::get_end_iterator(first, end), p)));
+                                                },
+                                                true));
+    }
+    return std::find_if(first, last, p);
+}
+
+/// parallel find_if_not algorithm
+template <class ExecutionPolicy, class InputIterator, class UnaryPredicate>
+InputIterator find_if_not(ExecutionPolicy&& policy, InputIterator first, InputIterator last, UnaryPredicate p) {
+    using reference = typename std::iterator_traits<InputIterator>::reference;
+
+    return hadoken::parallel::find_if(std::forward<ExecutionPolicy>(policy), first, last,
+                                      [&p](reference v) { return !p(v); });
+}
+
+/// parallel find algorithm
+template <class ExecutionPolicy, class InputIterator, class T>
+InputIterator find(ExecutionPolicy&& policy, InputIterator first, InputIterator last, const T& value) {
+    using reference = typename std::iterator_traits<InputIterator>::reference;
+
+    return hadoken::parallel::find_if(std::forward<ExecutionPolicy>(policy), first, last,
+                                      [&value](reference v) { return v == value; });
+}
+
+
+/// parallel find_first_of algorithm with binary predicate
+template <class ExecutionPolicy, class InputIterator, class ForwardIterator, class BinaryPredicate>
+InputIterator find_first_of(ExecutionPolicy&& policy, InputIterator first, InputIterator last, ForwardIterator s_first,
+                            ForwardIterator s_last, BinaryPredicate p) {
+    using reference = typename std::iterator_traits<InputIterator>::reference;
+    using s_reference = typename std::iterator_traits<ForwardIterator>::reference;
+
+    return hadoken::parallel::find_if(std::forward<ExecutionPolicy>(policy), first, last, [&](reference v) {
+        return std::any_of(s_first, s_last, [&](s_reference s) { return p(v, s); });
+    });
+}
+
+/// parallel find_first_of algorithm
+template <class ExecutionPolicy, class InputIterator, class ForwardIterator>
+InputIterator find_first_of(ExecutionPolicy&& policy, InputIterator first, InputIterator last, ForwardIterator s_first,
+                            ForwardIterator s_last) {
+    using reference = typename std::iterator_traits<InputIterator>::reference;
+    using s_reference = typename std::iterator_traits<ForwardIterator>::reference;
+
+    return hadoken::parallel::find_first_of(std::forward<ExecutionPolicy>(policy), first, last, s_first, s_last,
+                                            [](reference v, s_reference s) { return v == s; });
+}
+
+
+/// parallel adjacent_find algorithm with binary predicate
+template <class ExecutionPolicy, class ForwardIterator, class BinaryPredicate>
+ForwardIterator adjacent_find(ExecutionPolicy&& policy, ForwardIterator first, ForwardIterator last, BinaryPredicate p) {
+    const std::size_t n_elems = (detail::is_parallel_policy(policy) && detail::__is_random_access<ForwardIterator>::value)
+                                    ? (static_cast<std::size_t>(std::distance(first, last)))
+                                    : (0);
+
+    // n_elems is only computed with random access, the sequential path never walks the range twice
+    if (n_elems > 1) {
+        // search of the first i in [0, n_elems - 1) with p(first[i], first[i + 1])
+        const std::size_t n_pairs = n_elems - 1;
+
+        const std::size_t found = detail::_internal_find_index(policy, n_pairs,
+                                                               [&](std::size_t begin, std::size_t end) {
+                                                                   ForwardIterator block_first =
+                                                                       detail::get_end_iterator(first, begin);
+                                                                   ForwardIterator block_last =
+                                                                       detail::get_end_iterator(first, end + 1);
+                                                                   ForwardIterator res =
+                                                                       std::adjacent_find(block_first, block_last, p);
+                                                                   return (res == block_last)
+                                                                              ? (end)
+                                                                              : (begin + static_cast<std::size_t>(
+                                                                                             std::distance(block_first, res)));
+                                                               },
+                                                               true);
+        return (found == n_pairs) ? (last) : (detail::get_end_iterator(first, found));
+    }
+    return std::adjacent_find(first, last, p);
+}
+
+/// parallel adjacent_find algorithm
+template <class ExecutionPolicy, class ForwardIterator>
+ForwardIterator adjacent_find(ExecutionPolicy&& policy, ForwardIterator first, ForwardIterator last) {
+    using reference = typename std::iterator_traits<ForwardIterator>::reference;
+
+    return hadoken::parallel::adjacent_find(std::forward<ExecutionPolicy>(policy), first, last,
+                                            [](reference a, reference b) { return a == b; });
+}
+
+
+/// parallel mismatch algorithm with binary predicate, on [first1, last1) and [first2, last2)
+template <class ExecutionPolicy, class InputIterator1, class InputIterator2, class BinaryPredicate>
+std::pair<InputIterator1, InputIterator2> mismatch(ExecutionPolicy&& policy, InputIterator1 first1, InputIterator1 last1,
+                                                   InputIterator2 first2, InputIterator2 last2, BinaryPredicate p) {
+    if (detail::is_parallel_policy(policy) && detail::__is_random_access<InputIterator1>::value &&
+        detail::__is_random_access<InputIterator2>::value) {
+        const std::size_t n_elems = std::min(static_cast<std::size_t>(std::distance(first1, last1)),
+                                             static_cast<std::size_t>(std::distance(first2, last2)));
+
+        const std::size_t found = detail::_internal_find_index(policy, n_elems,
+                                                               [&](std::size_t begin, std::size_t end) {
+                                                                   auto res = std::mismatch(
+                                                                       detail::get_end_iterator(first1, begin),
+                                                                       detail::get_end_iterator(first1, end),
+                                                                       detail::get_end_iterator(first2, begin), p);
+                                                                   return static_cast<std::size_t>(
+                                                                       std::distance(first1, res.first));
+                                                               },
+                                                               true);
+        return std::make_pair(detail::get_end_iterator(first1, found), detail::get_end_iterator(first2, found));
+    }
+
+    // sequential, bounded by both ranges
+    while (first1 != last1 && first2 != last2 && p(*first1, *first2)) {
+        ++first1, ++first2;
+    }
+    return std::make_pair(first1, first2);
+}
+
+/// parallel mismatch algorithm, on [first1, last1) and [first2, last2)
+template <class ExecutionPolicy, class InputIterator1, class InputIterator2>
+std::pair<InputIterator1, InputIterator2> mismatch(ExecutionPolicy&& policy, InputIterator1 first1, InputIterator1 last1,
+                                                   InputIterator2 first2, InputIterator2 last2) {
+    using reference1 = typename std::iterator_traits<InputIterator1>::reference;
+    using reference2 = typename std::iterator_traits<InputIterator2>::reference;
+
+    return hadoken::parallel::mismatch(std::forward<ExecutionPolicy>(policy), first1, last1, first2, last2,
+                                       [](reference1 a, reference2 b) { return a == b; });
+}
+
+/// parallel mismatch algorithm, [first2, first2 + ( last1 - first1 ) ) must be valid
+template <class ExecutionPolicy, class InputIterator1, class InputIterator2>
+std::pair<InputIterator1, InputIterator2> mismatch(ExecutionPolicy&& policy, InputIterator1 first1, InputIterator1 last1,
+                                                   InputIterator2 first2) {
+    if (detail::is_parallel_policy(policy) && detail::__is_random_access<InputIterator1>::value &&
+        detail::__is_random_access<InputIterator2>::value) {
+        return hadoken::parallel::mismatch(std::forward<ExecutionPolicy>(policy), first1, last1, first2,
+                                           detail::get_end_iterator(first2, std::distance(first1, last1)));
+    }
+    // single pass input iterators can not be walked to compute the bound
+    return std::mismatch(first1, last1, first2);
+}
+
+
+} // namespace parallel
+
+} // namespace hadoken
+
+#endif // PARALLEL_FIND_GENERIC_HPP
@@ -30,6 +30,8 @@
 #define PARALLEL_GENERIC_UTILS_HPP
 
 #include <algorithm>
+#include <atomic>
+#include <cstddef>
 
 
 #include <hadoken/parallel/algorithm.hpp>
@@ -49,6 +51,24 @@ inline Iterator get_end_iterator(Iterator first, Size n) {
     return first;
 }
 
+// first element of the block id when n elements are split in num_blocks blocks
+inline std::size_t __block_begin(std::size_t n, std::size_t num_blocks, std::size_t id) {
+    return static_cast<std::size_t>((static_cast<unsigned long long>(n) * id) / num_blocks);
+}
+
+
+// d_first[i] = op(firsts[i]...) for the n elements of a slice
+template <typename OutputIterator, typename Operation, typename... InputIterators>
+inline OutputIterator __transform_slice(OutputIterator d_first, std::size_t n, Operation& op, InputIterators... firsts) {
+    for (std::size_t i = 0; i < n; ++i, ++d_first) {
+        *d_first = op(*firsts...);
+        const int increments[] = {0, ((void)++firsts, 0)...};
+        (void)increments;
+    }
+    return d_first;
+}
+
+
 // determine if a policy is parallel or sequential
 template <typename ExecPolicy>
 inline bool is_parallel_policy(const ExecPolicy& policy) {
@@ -60,6 +80,65 @@ inline bool is_parallel_policy(const ExecPolicy& policy) {
     return false;
 }
 
+template <typename Executor>
+inline bool is_parallel_policy(const parallel_shared_exec_policy<Executor>& policy) {
+    (void)policy;
+    return true;
+}
+
+
+// task grid interface, implemented by the threading backend
+
+// number of tasks used to process n_elems elements with a policy
+template <typename ExecPolicy>
+inline std::size_t __grid_size(const ExecPolicy& policy, std::size_t n_elems);
+
+template <typename Executor>
+inline std::size_t __grid_size(const parallel_shared_exec_policy<Executor>& policy, std::size_t n_elems);
+
+// execute fun(id, num_executor) for every id in [0, num_executor) on the executor of the policy
+template <typename ExecPolicy, typename Function>
+inline void __execute_grid(const ExecPolicy& policy, int num_executor, Function fun);
+
+template <typename Executor, typename Function>
+inline void __execute_grid(const parallel_shared_exec_policy<Executor>& policy, int num_executor, Function fun);
+
+
+// blocks per task of the algorithms with a deterministic decomposition ( reductions, scans )
+constexpr std::size_t __blocks_per_task = 4;
+
+// number of tasks of a policy for n_elems elements, 1 for the sequential policies
+template <typename ExecPolicy>
+inline std::size_t __num_tasks(const ExecPolicy& policy, std::size_t n_elems) {
+    return (is_parallel_policy(policy)) ? (std::max<std::size_t>(1, __grid_size(policy, n_elems))) : (1);
+}
+
+// number of fixed blocks used to split n_elems elements over num_tasks tasks
+inline std::size_t __num_blocks(std::size_t n_elems, std::size_t num_tasks) {
+    return (num_tasks <= 1) ? (std::min<std::size_t>(n_elems, 1)) : (std::min(n_elems, num_tasks * __blocks_per_task));
+}
+
+// execute fun(block_id) for every block_id in [0, n_blocks), blocks are claimed dynamically by num_tasks tasks
+//
+// the decomposition in blocks only depends on the number of tasks, not on the scheduling
+template <typename ExecPolicy, typename Function>
+inline void __for_each_block(const ExecPolicy& policy, std::size_t num_tasks, std::size_t n_blocks, Function fun) {
+    if (num_tasks <= 1 || n_blocks <= 1) {
+        for (std::size_t block = 0; block < n_blocks; ++block) {
+            fun(block);
+        }
+        return;
+    }
+
+    std::atomic<std::size_t> next_block(0);
+    __execute_grid(policy, static_cast<int>(std::min(num_tasks, n_blocks)), [&](int, int) {
+        std::size_t block;
+        while ((block = next_block.fetch_add(1, std::memory_order_relaxed)) < n_blocks) {
+            fun(block);
+        }
+    });
+}
+
 
 
 
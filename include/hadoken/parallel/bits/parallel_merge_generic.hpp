@@ -0,0 +1,524 @@
+/**
+ * Copyright (c) 2016, Adrien Devresse <adrien.devresse@epfl.ch>
+ *
+ * Boost Software License - Version 1.0
+ *
+ * Permission is hereby granted, free of charge, to any person or organization
+ * obtaining a copy of the software and accompanying documentation covered by
+ * this license (the "Software") to use, reproduce, display, distribute,
+ * execute, and transmit the Software, and to prepare derivative works of the
+ * Software, and to permit third-parties to whom the Software is furnished to
+ * do so, all subject to the following:
+ *
+ * The copyright notices in the Software and this entire statement, including
+ * the above license grant, this restriction and the following disclaimer,
+ * must be included in all copies of the Software, in whole or in part, and
+ * all derivative works of the Software, unless such copies or derivative
+ * works are solely in the form of machine-executable object code generated by
+ * a source language processor.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+ * SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+ * FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ *
+ */
+#ifndef PARALLEL_MERGE_GENERIC_HPP
+#define PARALLEL_MERGE_GENERIC_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <iterator>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <hadoken/parallel/algorithm.hpp>
+
+
+#include "parallel_find_generic.hpp"
+#include "parallel_generic_utils.hpp"
+#include "parallel_numeric_generic.hpp"
+
+
+namespace hadoken {
+
+
+namespace parallel {
+
+
+namespace detail {
+
+// minimum number of output elements merged by a block
+constexpr std::size_t __merge_min_block = 4096;
+
+// number of merge path diagonals processed by a tile of a set operation
+constexpr std::size_t __set_tile_size = 16384;
+
+
+// merge path co-rank: number of elements of [a, a + m) among the k first elements
+// of the stable merge of [a, a + m) and [b, b + n), the k - i others come from b
+//
+// equal elements of a are taken before the ones of b, like std::merge
+template <class RandomIt1, class RandomIt2, class Compare>
+std::size_t __merge_path_corank(RandomIt1 a, std::size_t m, RandomIt2 b, std::size_t n, std::size_t k, Compare& comp) {
+    std::size_t lo = (k > n) ? (k - n) : (0), hi = std::min(k, m);
+    while (lo < hi) {
+        const std::size_t i = lo + (hi - lo) / 2, j = k - i;
+        if (comp(b[j - 1], a[i]) == false) {
+            lo = i + 1;
+        } else {
+            hi = i;
+        }
+    }
+    return lo;
+}
+
+template <class InputIt1, class InputIt2, class OutputIt, class Compare>
+OutputIt __merge_range(InputIt1 first1, InputIt1 last1, InputIt2 first2, InputIt2 last2, OutputIt d_first, Compare& comp,
+                       std::false_type /* move */) {
+    return std::merge(first1, last1, first2, last2, d_first, comp);
+}
+
+// std::merge that moves the elements to the output, comp only gets lvalues
+template <class InputIt1, class InputIt2, class OutputIt, class Compare>
+OutputIt __merge_range(InputIt1 first1, InputIt1 last1, InputIt2 first2, InputIt2 last2, OutputIt d_first, Compare& comp,
+                       std::true_type /* move */) {
+    for (; first1 != last1 && first2 != last2; ++d_first) {
+        if (comp(*first2, *first1)) {
+            *d_first = std::move(*first2);
+            ++first2;
+        } else {
+            *d_first = std::move(*first1);
+            ++first1;
+        }
+    }
+    return std::move(first2, last2, std::move(first1, last1, d_first));
+}
+
+// merge the output elements [k_begin, k_end) of the merge of a and b to d_first + k_begin,
+// i_begin and i_end are the co-ranks of k_begin and k_end
+template <class RandomIt1, class RandomIt2, class RandomOutputIt, class Compare, class Move>
+void __merge_block(RandomIt1 a, RandomIt2 b, RandomOutputIt d_first, std::size_t k_begin, std::size_t i_begin,
+                   std::size_t k_end, std::size_t i_end, Compare& comp, Move move) {
+    __merge_range(a + i_begin, a + i_end, b + (k_begin - i_begin), b + (k_end - i_end), d_first + k_begin, comp, move);
+}
+
+
+// parallel merge: the output is split in blocks of equal size, every block
+// merges the inputs between the merge path co-ranks of its boundaries
+//
+// the co-ranks are all computed before the merge: no element is moved while a search reads it
+template <class ExecutionPolicy, class RandomIt1, class RandomIt2, class RandomOutputIt, class Compare, class Move>
+RandomOutputIt _internal_merge(const ExecutionPolicy& policy, RandomIt1 a, std::size_t m, RandomIt2 b, std::size_t n,
+                               RandomOutputIt d_first, Compare& comp, Move move) {
+    const std::size_t n_elems = m + n;
+    const std::size_t num_tasks = __num_tasks(policy, n_elems);
+    const std::size_t n_blocks = std::min(__num_blocks(n_elems, num_tasks), n_elems / __merge_min_block);
+
+    if (num_tasks <= 1 || n_blocks <= 1) {
+        return __merge_range(a, a + m, b, b + n, d_first, comp, move);
+    }
+
+    std::vector<std::size_t> coranks(n_blocks + 1);
+    for (std::size_t block = 0; block <= n_blocks; ++block) {
+        coranks[block] = __merge_path_corank(a, m, b, n, __block_begin(n_elems, n_blocks, block), comp);
+    }
+
+    __for_each_block(policy, num_tasks, n_blocks, [&](std::size_t block) {
+        __merge_block(a, b, d_first, __block_begin(n_elems, n_blocks, block), coranks[block],
+                      __block_begin(n_elems, n_blocks, block + 1), coranks[block + 1], comp, move);
+    });
+    return d_first + n_elems;
+}
+
+
+template <class ExecutionPolicy, class RandomIt1, class RandomIt2, class RandomOutputIt, class Compare>
+RandomOutputIt _internal_merge_dispatch(const ExecutionPolicy& policy, RandomIt1 first1, RandomIt1 last1, RandomIt2 first2,
+                                        RandomIt2 last2, RandomOutputIt d_first, Compare& comp, std::true_type) {
+    return _internal_merge(policy, first1, static_cast<std::size_t>(std::distance(first1, last1)), first2,
+                           static_cast<std::size_t>(std::distance(first2, last2)), d_first, comp, std::false_type());
+}
+
+// co-ranks require random access on the inputs and on the output
+template <class ExecutionPolicy, class InputIt1, class InputIt2, class OutputIt, class Compare>
+OutputIt _internal_merge_dispatch(const ExecutionPolicy&, InputIt1 first1, InputIt1 last1, InputIt2 first2, InputIt2 last2,
+                                  OutputIt d_first, Compare& comp, std::false_type) {
+    return std::merge(first1, last1, first2, last2, d_first, comp);
+}
+
+
+// merge in place through a buffer built by moving the range: requires random access and movable values
+template <class RandomIt>
+struct __is_buffer_mergeable
+    : std::integral_constant<bool, __is_random_access<RandomIt>::value &&
+                                       std::is_move_constructible<typename std::iterator_traits<RandomIt>::value_type>::value &&
+                                       std::is_move_assignable<typename std::iterator_traits<RandomIt>::value_type>::value> {};
+
+
+template <class ExecutionPolicy, class RandomIt, class Compare>
+void _internal_inplace_merge_dispatch(const ExecutionPolicy& policy, RandomIt first, RandomIt middle, RandomIt last,
+                                      Compare& comp, std::true_type) {
+    using value_type = typename std::iterator_traits<RandomIt>::value_type;
+
+    const std::size_t m = static_cast<std::size_t>(std::distance(first, middle));
+    const std::size_t n_elems = static_cast<std::size_t>(std::distance(first, last));
+
+    if (__num_tasks(policy, n_elems) <= 1 || n_elems < 2 * __merge_min_block) {
+        std::inplace_merge(first, middle, last, comp);
+        return;
+    }
+
+    std::vector<value_type> buffer;
+    try {
+        buffer.reserve(n_elems);
+    } catch (std::bad_alloc&) {
+        std::inplace_merge(first, middle, last, comp);
+        return;
+    }
+    buffer.assign(std::make_move_iterator(first), std::make_move_iterator(last));
+
+    _internal_merge(policy, buffer.begin(), m, buffer.begin() + m, n_elems - m, first, comp, std::true_type());
+}
+
+template <class ExecutionPolicy, class BidirIt, class Compare>
+void _internal_inplace_merge_dispatch(const ExecutionPolicy&, BidirIt first, BidirIt middle, BidirIt last, Compare& comp,
+                                      std::false_type) {
+    std::inplace_merge(first, middle, last, comp);
+}
+
+
+// output iterator that only counts the elements written
+struct __counting_output_iterator {
+    using iterator_category = std::output_iterator_tag;
+    using value_type = void;
+    using difference_type = std::ptrdiff_t;
+    using pointer = void;
+    using reference = void;
+
+    __counting_output_iterator& operator*() { return *this; }
+    __counting_output_iterator& operator++() { return *this; }
+    __counting_output_iterator& operator++(int) { return *this; }
+
+    template <class T>
+    __counting_output_iterator& operator=(const T&) {
+        count += 1;
+        return *this;
+    }
+
+    std::size_t count;
+};
+
+
+// the sequential set operations
+struct __set_union_op {
+    template <class InputIt1, class InputIt2, class OutputIt, class Compare>
+    OutputIt operator()(InputIt1 first1, InputIt1 last1, InputIt2 first2, InputIt2 last2, OutputIt d_first,
+                        Compare& comp) const {
+        return std::set_union(first1, last1, first2, last2, d_first, comp);
+    }
+};
+
+struct __set_intersection_op {
+    template <class InputIt1, class InputIt2, class OutputIt, class Compare>
+    OutputIt operator()(InputIt1 first1, InputIt1 last1, InputIt2 first2, InputIt2 last2, OutputIt d_first,
+                        Compare& comp) const {
+        return std::set_intersection(first1, last1, first2, last2, d_first, comp);
+    }
+};
+
+struct __set_difference_op {
+    template <class InputIt1, class InputIt2, class OutputIt, class Compare>
+    OutputIt operator()(InputIt1 first1, InputIt1 last1, InputIt2 first2, InputIt2 last2, OutputIt d_first,
+                        Compare& comp) const {
+        return std::set_difference(first1, last1, first2, last2, d_first, comp);
+    }
+};
+
+
+// split of the inputs of a set operation at the diagonal k of their merge
+//
+// the split is moved back to the first element equivalent to the k-th element of the merge:
+// the equivalent elements of both inputs always end up in the same tile
+template <class RandomIt1, class RandomIt2, class Compare>
+std::pair<std::size_t, std::size_t> __set_split(RandomIt1 a, std::size_t m, RandomIt2 b, std::size_t n, std::size_t k,
+                                                Compare& comp) {
+    if (k >= m + n) {
+        return std::make_pair(m, n);
+    }
+
+    const std::size_t i = __merge_path_corank(a, m, b, n, k, comp), j = k - i;
+
+    if (j == n || (i < m && comp(b[j], a[i]) == false)) {
+        return std::make_pair(static_cast<std::size_t>(std::lower_bound(a, a + i, a[i], comp) - a), j);
+    }
+    return std::make_pair(static_cast<std::size_t>(std::lower_bound(a, a + i, b[j], comp) - a),
+                          static_cast<std::size_t>(std::lower_bound(b, b + j, b[j], comp) - b));
+}
+
+
+// parallel set operation in a single pass over the tiles of the merge path
+//
+// every tile applies the sequential operation to its split of the inputs, counts its output,
+// gets its output offset from the chain of tile prefixes, then writes its output
+template <class ExecutionPolicy, class RandomIt1, class RandomIt2, class RandomOutputIt, class Compare, class SetOperation>
+RandomOutputIt _internal_set_operation(const ExecutionPolicy& policy, RandomIt1 a, std::size_t m, RandomIt2 b, std::size_t n,
+                                       RandomOutputIt d_first, Compare& comp, SetOperation set_op) {
+    const std::size_t zero = 0;
+    std::plus<std::size_t> sum;
+
+    const std::size_t n_written = _internal_chained_tiles(
+        policy, m + n, __set_tile_size, &zero, zero, sum,
+        [&](std::size_t begin, std::size_t end, __tile_chain<std::size_t, std::plus<std::size_t>>& chain) {
+            const std::pair<std::size_t, std::size_t> split_begin = __set_split(a, m, b, n, begin, comp);
+            const std::pair<std::size_t, std::size_t> split_end = __set_split(a, m, b, n, end, comp);
+
+            RandomIt1 a_first = a + split_begin.first, a_last = a + split_end.first;
+            RandomIt2 b_first = b + split_begin.second, b_last = b + split_end.second;
+
+            const std::size_t count = set_op(a_first, a_last, b_first, b_last, __counting_output_iterator{0}, comp).count;
+            const std::size_t offset = *chain(count);
+
+            set_op(a_first, a_last, b_first, b_last, d_first + offset, comp);
+        });
+
+    return d_first + n_written;
+}
+
+
+template <class ExecutionPolicy, class RandomIt1, class RandomIt2, class RandomOutputIt, class Compare, class SetOperation>
+RandomOutputIt _internal_set_operation_dispatch(const ExecutionPolicy& policy, RandomIt1 first1, RandomIt1 last1,
+                                                RandomIt2 first2, RandomIt2 last2, RandomOutputIt d_first, Compare& comp,
+                                                SetOperation set_op, std::true_type) {
+    return _internal_set_operation(policy, first1, static_cast<std::size_t>(std::distance(first1, last1)), first2,
+                                   static_cast<std::size_t>(std::distance(first2, last2)), d_first, comp, set_op);
+}
+
+template <class ExecutionPolicy, class InputIt1, class InputIt2, class OutputIt, class Compare, class SetOperation>
+OutputIt _internal_set_operation_dispatch(const ExecutionPolicy&, InputIt1 first1, InputIt1 last1, InputIt2 first2,
+                                          InputIt2 last2, OutputIt d_first, Compare& comp, SetOperation set_op,
+                                          std::false_type) {
+    return set_op(first1, last1, first2, last2, d_first, comp);
+}
+
+template <class InputIt1, class InputIt2, class OutputIt>
+struct __is_random_access_set_operation
+    : std::integral_constant<bool, __is_random_access<InputIt1>::value && __is_random_access<InputIt2>::value &&
+                                       __is_random_access<OutputIt>::value> {};
+
+
+// one round of the merge sort: the runs [id * width, (id + 1) * width) of src are merged by pairs to dst
+//
+// all the merges of the round share the same decomposition of the output in blocks of equal size.
+// The co-rank of every block boundary, in the pair of runs that contains it, is computed before the merges
+template <class ExecutionPolicy, class RandomIt, class RandomOutputIt, class Compare>
+void __merge_round(const ExecutionPolicy& policy, RandomIt src, RandomOutputIt dst, std::size_t n, std::size_t num_runs,
+                   std::size_t width, std::size_t num_tasks, Compare& comp) {
+    const std::size_t n_blocks = __num_blocks(n, num_tasks);
+
+    // [begin, middle) and [middle, end) are the runs merged by the pair starting at run
+    auto pair_begin = [&](std::size_t run) { return __block_begin(n, num_runs, run); };
+    auto pair_middle = [&](std::size_t run) { return __block_begin(n, num_runs, std::min(num_runs, run + width)); };
+    auto pair_end = [&](std::size_t run) { return __block_begin(n, num_runs, std::min(num_runs, run + 2 * width)); };
+
+    std::vector<std::size_t> coranks(n_blocks + 1);
+    for (std::size_t block = 0, run = 0; block <= n_blocks; ++block) {
+        const std::size_t k = __block_begin(n, n_blocks, block);
+        while (run + 2 * width < num_runs && pair_end(run) <= k) {
+            run += 2 * width;
+        }
+        const std::size_t begin = pair_begin(run), middle = pair_middle(run), end = pair_end(run);
+        coranks[block] = __merge_path_corank(src + begin, middle - begin, src + middle, end - middle, k - begin, comp);
+    }
+
+    __for_each_block(policy, num_tasks, n_blocks, [&](std::size_t block) {
+        const std::size_t block_begin = __block_begin(n, n_blocks, block), block_end = __block_begin(n, n_blocks, block + 1);
+
+        for (std::size_t run = 0; run < num_runs; run += 2 * width) {
+            const std::size_t begin = pair_begin(run), middle = pair_middle(run), end = pair_end(run);
+
+            if (end <= block_begin || begin >= block_end) {
+                continue;
+            }
+
+            // a block boundary inside the pair uses its co-rank, the pair boundaries are trivial
+            const std::size_t k_begin = std::max(block_begin, begin) - begin, k_end = std::min(block_end, end) - begin;
+            const std::size_t i_begin = (begin >= block_begin) ? (0) : (coranks[block]);
+            const std::size_t i_end = (end <= block_end) ? (middle - begin) : (coranks[block + 1]);
+
+            __merge_block(src + begin, src + middle, dst + begin, k_begin, i_begin, k_end, i_end, comp, std::true_type());
+        }
+    });
+}
+
+template <class RandomIt, class Compare>
+void __sort_run(RandomIt first, RandomIt last, Compare& comp, std::true_type /* stable */) {
+    std::stable_sort(first, last, comp);
+}
+
+template <class RandomIt, class Compare>
+void __sort_run(RandomIt first, RandomIt last, Compare& comp, std::false_type /* stable */) {
+    std::sort(first, last, comp);
+}
+
+
+// merge sort: num_tasks runs are sorted, then merged by pairs with parallel merges,
+// back and forth between the range and a buffer built by moving the range
+//
+// stable if the runs are sorted with a stable sort. The buffer is empty, with a capacity of n elements
+template <bool Stable, class ExecutionPolicy, class RandomIt, class Compare>
+void _internal_merge_sort(const ExecutionPolicy& policy, RandomIt first, std::size_t n, std::size_t num_tasks,
+                          Compare& comp, std::vector<typename std::iterator_traits<RandomIt>::value_type>& buffer) {
+    using value_type = typename std::iterator_traits<RandomIt>::value_type;
+    using iterator = typename std::vector<value_type>::iterator;
+
+    buffer.assign(std::make_move_iterator(first), std::make_move_iterator(first + n));
+
+    __execute_grid(policy, static_cast<int>(num_tasks), [&](int id, int) {
+        __sort_run(buffer.begin() + __block_begin(n, num_tasks, id), buffer.begin() + __block_begin(n, num_tasks, id + 1),
+                   comp, std::integral_constant<bool, Stable>());
+    });
+
+    bool in_buffer = true;
+    for (std::size_t width = 1; width < num_tasks; width *= 2, in_buffer = !in_buffer) {
+        if (in_buffer) {
+            __merge_round(policy, buffer.begin(), first, n, num_tasks, width, num_tasks, comp);
+        } else {
+            __merge_round(policy, first, buffer.begin(), n, num_tasks, width, num_tasks, comp);
+        }
+    }
+
+    if (in_buffer) {
+        const std::size_t n_blocks = __num_blocks(n, num_tasks);
+        __for_each_block(policy, num_tasks, n_blocks, [&](std::size_t block) {
+            iterator block_first = buffer.begin() + __block_begin(n, n_blocks, block);
+            std::move(block_first, buffer.begin() + __block_begin(n, n_blocks, block + 1),
+                      first + __block_begin(n, n_blocks, block));
+        });
+    }
+}
+
+} // namespace detail
+
+
+
+/// parallel merge algorithm
+template <class ExecutionPolicy, class InputIterator1, class InputIterator2, class OutputIterator>
+OutputIterator merge(ExecutionPolicy&& policy, InputIterator1 first1, InputIterator1 last1, InputIterator2 first2,
+                     InputIterator2 last2, OutputIterator d_first) {
+    using value_type = typename std::iterator_traits<InputIterator1>::value_type;
+
+    return hadoken::parallel::merge(std::forward<ExecutionPolicy>(policy), first1, last1, first2, last2, d_first,
+                                    std::less<value_type>());
+}
+
+/// parallel merge algorithm with comparator
+template <class ExecutionPolicy, class InputIterator1, class InputIterator2, class OutputIterator, class Compare>
+OutputIterator merge(ExecutionPolicy&& policy, InputIterator1 first1, InputIterator1 last1, InputIterator2 first2,
+                     InputIterator2 last2, OutputIterator d_first, Compare comp) {
+    if (detail::is_parallel_policy(policy)) {
+        return detail::_internal_merge_dispatch(
+            policy, first1, last1, first2, last2, d_first, comp,
+            detail::__is_random_access_set_operation<InputIterator1, InputIterator2, OutputIterator>());
+    }
+    return std::merge(first1, last1, first2, last2, d_first, comp);
+}
+
+/// parallel inplace_merge algorithm
+template <class ExecutionPolicy, class BidirectionalIterator>
+void inplace_merge(ExecutionPolicy&& policy, BidirectionalIterator first, BidirectionalIterator middle,
+                   BidirectionalIterator last) {
+    using value_type = typename std::iterator_traits<BidirectionalIterator>::value_type;
+
+    hadoken::parallel::inplace_merge(std::forward<ExecutionPolicy>(policy), first, middle, last, std::less<value_type>());
+}
+
+/// parallel inplace_merge algorithm with comparator
+template <class ExecutionPolicy, class BidirectionalIterator, class Compare>
+void inplace_merge(ExecutionPolicy&& policy, BidirectionalIterator first, BidirectionalIterator middle,
+                   BidirectionalIterator last, Compare comp) {
+    if (detail::is_parallel_policy(policy)) {
+        detail::_internal_inplace_merge_dispatch(policy, first, middle, last, comp,
+                                                 detail::__is_buffer_mergeable<BidirectionalIterator>());
+        return;
+    }
+    std::inplace_merge(first, middle, last, comp);
+}
+
+/// parallel set_union algorithm
+template <class ExecutionPolicy, class InputIterator1, class InputIterator2, class OutputIterator>
+OutputIterator set_union(ExecutionPolicy&& policy, InputIterator1 first1, InputIterator1 last1, InputIterator2 first2,
+                         InputIterator2 last2, OutputIterator d_first) {
+    using value_type = typename std::iterator_traits<InputIterator1>::value_type;
+
+    return hadoken::parallel::set_union(std::forward<ExecutionPolicy>(policy), first1, last1, first2, last2, d_first,
+                                        std::less<value_type>());
+}
+
+/// parallel set_union algorithm with comparator
+template <class ExecutionPolicy, class InputIterator1, class InputIterator2, class OutputIterator, class Compare>
+OutputIterator set_union(ExecutionPolicy&& policy, InputIterator1 first1, InputIterator1 last1, InputIterator2 first2,
+                         InputIterator2 last2, OutputIterator d_first, Compare comp) {
+    if (detail::is_parallel_policy(policy)) {
+        return detail::_internal_set_operation_dispatch(
+            policy, first1, last1, first2, last2, d_first, comp, detail::__set_union_op(),
+            detail::__is_random_access_set_operation<InputIterator1, InputIterator2, OutputIterator>());
+    }
+    return std::set_union(first1, last1, first2, last2, d_first, comp);
+}
+
+/// parallel set_intersection algorithm
+template <class ExecutionPolicy, class InputIterator1, class InputIterator2, class OutputIterator>
+OutputIterator set_intersection(ExecutionPolicy&& policy, InputIterator1 first1, InputIterator1 last1, InputIterator2 first2,
+                                InputIterator2 last2, OutputIterator d_first) {
+    using value_type = typename std::iterator_traits<InputIterator1>::value_type;
+
+    return hadoken::parallel::set_intersection(std::forward<ExecutionPolicy>(policy), first1, last1, first2, last2, d_first,
+                                               std::less<value_type>());
+}
+
+/// parallel set_intersection algorithm with comparator
+template <class ExecutionPolicy, class InputIterator1, class InputIterator2, class OutputIterator, class Compare>
+OutputIterator set_intersection(ExecutionPolicy&& policy, InputIterator1 first1, InputIterator1 last1, InputIterator2 first2,
+                                InputIterator2 last2, OutputIterator d_first, Compare comp) {
+    if (detail::is_parallel_policy(policy)) {
+        return detail::_internal_set_operation_dispatch(
+            policy, first1, last1, first2, last2, d_first, comp, detail::__set_intersection_op(),
+            detail::__is_random_access_set_operation<InputIterator1, InputIterator2, OutputIterator>());
+    }
+    return std::set_intersection(first1, last1, first2, last2, d_first, comp);
+}
+
+/// parallel set_difference algorithm
+template <class ExecutionPolicy, class InputIterator1, class InputIterator2, class OutputIterator>
+OutputIterator set_difference(ExecutionPolicy&& policy, InputIterator1 first1, InputIterator1 last1, InputIterator2 first2,
+                              InputIterator2 last2, OutputIterator d_first) {
+    using value_type = typename std::iterator_traits<InputIterator1>::value_type;
+
+    return hadoken::parallel::set_difference(std::forward<ExecutionPolicy>(policy), first1, last1, first2, last2, d_first,
+                                             std::less<value_type>());
+}
+
+/// parallel set_difference algorithm with comparator
+template <class ExecutionPolicy, class InputIterator1, class InputIterator2, class OutputIterator, class Compare>
+OutputIterator set_difference(ExecutionPolicy&& policy, InputIterator1 first1, InputIterator1 last1, InputIterator2 first2,
+                              InputIterator2 last2, OutputIterator d_first, Compare comp) {
+    if (detail::is_parallel_policy(policy)) {
+        return detail::_internal_set_operation_dispatch(
+            policy, first1, last1, first2, last2, d_first, comp, detail::__set_difference_op(),
+            detail::__is_random_access_set_operation<InputIterator1, InputIterator2, OutputIterator>());
+    }
+    return std::set_difference(first1, last1, first2, last2, d_first, comp);
+}
+
+
+} // namespace parallel
+
+} // namespace hadoken
+
+#endif // PARALLEL_MERGE_GENERIC_HPP
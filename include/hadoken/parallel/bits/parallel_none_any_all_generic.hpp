@@ -31,9 +31,11 @@
 
 #include <algorithm>
 #include <atomic>
+#include <iterator>
 #include <hadoken/parallel/algorithm.hpp>
 
 
+#include "parallel_find_generic.hpp"
 #include "parallel_generic_utils.hpp"
 
 
@@ -43,24 +45,16 @@ namespace hadoken {
 namespace parallel {
 
 
-namespace detail {} // namespace detail
+// all_of, any_of and none_of stop as soon as the answer is known: see _internal_find_index
 
 
 template <class ExecutionPolicy, class InputIterator, class UnaryPredicate>
 inline bool all_of(ExecutionPolicy&& policy, InputIterator first, InputIterator last, UnaryPredicate p) {
+    using reference = typename std::iterator_traits<InputIterator>::reference;
 
-    if (detail::is_parallel_policy(policy)) {
-        std::atomic<bool> res(true);
-
-        hadoken::parallel::for_range(std::forward<ExecutionPolicy>(policy), first, last,
-                                     [&res, &p](InputIterator local_first, InputIterator local_end) {
-                                         const bool local_res = std::all_of(local_first, local_end, p);
-
-                                         if (local_res == false) {
-                                             res.store(false);
-                                         }
-                                     });
-        return res.load();
+    if (detail::is_parallel_policy(policy) && detail::__is_random_access<InputIterator>::value) {
+        auto not_p = [&p](reference v) { return !p(v); };
+        return detail::_internal_any_match(policy, first, last, not_p) == false;
     } else {
         return std::all_of(first, last, p);
     }
@@ -70,18 +64,8 @@ inline bool all_of(ExecutionPolicy&& policy, InputIterator first, InputIterator
 template <class ExecutionPolicy, class InputIterator, class UnaryPredicate>
 inline bool any_of(ExecutionPolicy&& policy, InputIterator first, InputIterator last, UnaryPredicate p) {
 
-    if (detail::is_parallel_policy(policy)) {
-        std::atomic<bool> res(false);
-
-        hadoken::parallel::for_range(std::forward<ExecutionPolicy>(policy), first, last,
-                                     [&res, &p](InputIterator local_first, InputIterator local_end) {
-                                         const bool local_res = std::any_of(local_first, local_end, p);
-
-                                         if (local_res == true) {
-                                             res.store(true);
-                                         }
-                                     });
-        return res.load();
+    if (detail::is_parallel_policy(policy) && detail::__is_random_access<InputIterator>::value) {
+        return detail::_internal_any_match(policy, first, last, p);
     } else {
         return std::any_of(first, last, p);
     }
@@ -93,18 +77,8 @@ inline bool any_of(ExecutionPolicy&& policy, InputIterator first, InputIterator
 template <class ExecutionPolicy, class InputIterator, class UnaryPredicate>
 inline bool none_of(ExecutionPolicy&& policy, InputIterator first, InputIterator last, UnaryPredicate p) {
 
-    if (detail::is_parallel_policy(policy)) {
-        std::atomic<bool> res(true);
-
-        hadoken::parallel::for_range(std::forward<ExecutionPolicy>(policy), first, last,
-                                     [&res, &p](InputIterator local_first, InputIterator local_end) {
-                                         const bool local_res = std::none_of(local_first, local_end, p);
-
-                                         if (local_res == false) {
-                                             res.store(false);
-                                         }
-                                     });
-        return res.load();
+    if (detail::is_parallel_policy(policy) && detail::__is_random_access<InputIterator>::value) {
+        return detail::_internal_any_match(policy, first, last, p) == false;
     } else {
         return std::none_of(first, last, p);
     }
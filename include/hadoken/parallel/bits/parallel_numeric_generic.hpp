@@ -32,13 +32,19 @@
 #include <algorithm>
 #include <atomic>
 #include <cmath>
-#include <mutex>
+#include <functional>
+#include <iterator>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
 
 
-#include <hadoken/thread/spinlock.hpp>
 
 #include "parallel_generic_utils.hpp"
+#include "parallel_simd_generic.hpp"
 #include <hadoken/parallel/algorithm.hpp>
+#include <hadoken/thread/future.hpp>
 
 
 namespace hadoken {
@@ -49,73 +55,343 @@ namespace parallel {
 
 namespace detail {
 
-template <class ExecutionPolicy, class InputIt, class OutputIt, class BinaryOperation>
-OutputIt _internal_inclusive_scan(ExecutionPolicy&& policy, InputIt first, InputIt last, OutputIt d_first,
-                                  BinaryOperation binary_op) {
-    (void)(policy);
-    using value_type = typename std::iterator_traits<OutputIt>::value_type;
-    using tuple_it_val = std::tuple<OutputIt, value_type>;
-
-    std::size_t n_elems = std::distance(first, last);
-    OutputIt d_end = d_first;
-    std::advance(d_end, n_elems);
-
-    if (n_elems == 0) {
-        return d_first;
+// partial result of a block, padded to keep the partials of concurrent tasks on distinct cache lines
+template <typename T>
+struct __padded_partial {
+    __padded_partial(const T& v) : value(v) {}
+
+    T value;
+    char _pad[64];
+};
+
+
+// cursors on the transformed elements of the reductions and scans
+template <class InputIt>
+struct __deref_cursor {
+    InputIt it;
+
+    auto operator*() const -> decltype(*it) { return *it; }
+    void operator++() { ++it; }
+    __deref_cursor advanced(std::size_t n) const { return __deref_cursor{get_end_iterator(it, n)}; }
+};
+
+template <class InputIt, class UnaryOperation>
+struct __unary_cursor {
+    InputIt it;
+    UnaryOperation* op;
+
+    auto operator*() const -> decltype((*op)(*it)) { return (*op)(*it); }
+    void operator++() { ++it; }
+    __unary_cursor advanced(std::size_t n) const { return __unary_cursor{get_end_iterator(it, n), op}; }
+};
+
+template <class InputIt1, class InputIt2, class BinaryOperation>
+struct __binary_cursor {
+    InputIt1 it1;
+    InputIt2 it2;
+    BinaryOperation* op;
+
+    auto operator*() const -> decltype((*op)(*it1, *it2)) { return (*op)(*it1, *it2); }
+    void operator++() { ++it1, ++it2; }
+    __binary_cursor advanced(std::size_t n) const {
+        return __binary_cursor{get_end_iterator(it1, n), get_end_iterator(it2, n), op};
     }
+};
+
 
+// fold of the n_elems > 0 transformed elements of a block
+template <typename T, class Cursor, class BinaryOperation>
+T __fold_block(Cursor c, std::size_t n_elems, BinaryOperation& binary_op) {
+    T acc = *c;
+    for (std::size_t i = 1; i < n_elems; ++i) {
+        ++c;
+        acc = binary_op(acc, *c);
+    }
+    return acc;
+}
 
-    std::vector<tuple_it_val> limits_vec;
-    hadoken::thread::spin_lock _limit_lock;
-    limits_vec.reserve(64);
 
-    // first local inclusive scan
-    for_range(policy, first, last, [&](InputIt local_first, InputIt local_last) {
-        std::size_t distance_from_first = std::distance(first, local_first);
-        std::size_t local_n_elems = std::distance(local_first, local_last);
+// folds of contiguous arithmetic values with par_vec are vectorized, for sums and products
+template <class ExecutionPolicy, class Cursor, class T, class BinaryOperation>
+struct __is_simd_fold : std::false_type {};
 
-        OutputIt local_d_first = d_first;
-        std::advance(local_d_first, distance_from_first);
+template <class ExecutionPolicy, class InputIt, class T, class BinaryOperation>
+struct __is_simd_fold<ExecutionPolicy, __deref_cursor<InputIt>, T, BinaryOperation>
+    : std::integral_constant<bool, __is_vector_policy<ExecutionPolicy>::value && __is_simd_iterator<InputIt>::value &&
+                                       __is_simd_reduction<T, BinaryOperation>::value> {};
 
-        std::partial_sum(local_first, local_last, local_d_first, binary_op);
+template <class ExecutionPolicy, class InputIt, class UnaryOperation, class T, class BinaryOperation>
+struct __is_simd_fold<ExecutionPolicy, __unary_cursor<InputIt, UnaryOperation>, T, BinaryOperation>
+    : std::integral_constant<bool, __is_vector_policy<ExecutionPolicy>::value && __is_simd_iterator<InputIt>::value &&
+                                       __is_simd_reduction<T, BinaryOperation>::value> {};
 
-        OutputIt d_local_end;
-        std::advance(local_d_first, local_n_elems - 1);
-        d_local_end = local_d_first;
-        std::advance(d_local_end, 1);
+template <typename T, class InputIt, class BinaryOperation>
+T __fold_block(__deref_cursor<InputIt> c, std::size_t n_elems, BinaryOperation& binary_op, std::true_type) {
+    __simd_identity identity;
+    return __simd_fold<T>(c.it, n_elems, identity, binary_op);
+}
 
-        {
-            std::lock_guard<hadoken::thread::spin_lock> _l(_limit_lock);
-            limits_vec.push_back(std::make_tuple(d_local_end, *local_d_first));
-        }
+template <typename T, class InputIt, class UnaryOperation, class BinaryOperation>
+T __fold_block(__unary_cursor<InputIt, UnaryOperation> c, std::size_t n_elems, BinaryOperation& binary_op, std::true_type) {
+    return __simd_fold<T>(c.it, n_elems, *c.op, binary_op);
+}
+
+template <typename T, class Cursor, class BinaryOperation>
+T __fold_block(Cursor c, std::size_t n_elems, BinaryOperation& binary_op, std::false_type) {
+    return __fold_block<T>(c, n_elems, binary_op);
+}
+
+// fold of the n_elems > 0 transformed elements of a block, with the kernels of the policy
+template <typename T, class ExecutionPolicy, class Cursor, class BinaryOperation>
+T __policy_fold_block(const ExecutionPolicy&, Cursor c, std::size_t n_elems, BinaryOperation& binary_op) {
+    return __fold_block<T>(c, n_elems, binary_op, __is_simd_fold<ExecutionPolicy, Cursor, T, BinaryOperation>());
+}
+
+
+// deterministic parallel reduction of the n_elems elements of a cursor
+//
+// every fixed block computes a partial, the partials are combined with init in block order:
+// the result is reproducible for a given number of tasks, including floating point sums
+template <class ExecutionPolicy, class Cursor, class T, class BinaryOperation>
+T _internal_transform_reduce(const ExecutionPolicy& policy, Cursor first, std::size_t n_elems, T init,
+                             BinaryOperation& binary_op) {
+    const std::size_t num_tasks = __num_tasks(policy, n_elems);
+    const std::size_t n_blocks = __num_blocks(n_elems, num_tasks);
+
+    if (n_blocks == 0) {
+        return init;
+    }
+
+    if (n_blocks == 1) {
+        return binary_op(init, __policy_fold_block<T>(policy, first, n_elems, binary_op));
+    }
+
+    std::vector<__padded_partial<T>> partials(n_blocks, __padded_partial<T>(init));
+
+    __for_each_block(policy, num_tasks, n_blocks, [&](std::size_t block) {
+        const std::size_t begin = __block_begin(n_elems, n_blocks, block), end = __block_begin(n_elems, n_blocks, block + 1);
+        partials[block].value = __policy_fold_block<T>(policy, first.advanced(begin), end - begin, binary_op);
     });
 
-    std::sort(limits_vec.begin(), limits_vec.end(),
-              [](const tuple_it_val& v1, const tuple_it_val& v2) { return std::get<0>(v1) < std::get<0>(v2); });
+    T res = init;
+    for (const auto& partial : partials) {
+        res = binary_op(res, partial.value);
+    }
+    return res;
+}
 
 
-    // post sum of each chunk partial sum
-    for_range(policy, d_first, d_end, [&](InputIt local_first, InputIt local_last) {
-        if (local_first < std::get<0>(limits_vec[0]))
-            return;
+// elements of a scan tile: tiles are scanned twice, the second time from the cache
+template <typename T>
+constexpr std::size_t __scan_tile_size() {
+    return (sizeof(T) >= 64) ? (1024) : (65536 / sizeof(T));
+}
 
-        value_type val = std::get<1>(limits_vec[0]);
+// scan tile state, published by the task of the tile for the task of the next tile
+template <typename T>
+struct __scan_tile_state {
+    __scan_tile_state(const T& v) : prefix(v), ready(false) {}
+    __scan_tile_state(const __scan_tile_state& other) : prefix(other.prefix), ready(other.ready.load()) {}
 
-        auto limit_it = limits_vec.begin();
-        std::advance(limit_it, 1);
+    T prefix;
+    std::atomic<bool> ready;
+    char _pad[64];
+};
 
 
-        while (local_first < local_last) {
-            while (local_first >= std::get<0>(*limit_it) && limit_it < limits_vec.end()) {
-                val = binary_op(val, std::get<1>(*limit_it));
-                limit_it++;
+// sequential scan of n elements from a cursor, carry is the combination of the elements before, if any
+template <bool Inclusive, class Cursor, class OutputIt, class T, class BinaryOperation>
+OutputIt __scan_block(Cursor c, std::size_t n, OutputIt out, const T* carry, BinaryOperation& binary_op) {
+    if (n == 0) {
+        return out;
+    }
+
+    std::size_t i = 0;
+    T acc = (carry != nullptr) ? (*carry) : (T(*c));
+
+    if (carry == nullptr) {
+        // first element of a scan without initial value
+        *out = acc;
+        ++c, ++out, ++i;
+    }
+
+    for (; i < n; ++i, ++c, ++out) {
+        T v = *c;
+        if (Inclusive) {
+            acc = binary_op(acc, v);
+            *out = acc;
+        } else {
+            *out = acc;
+            acc = binary_op(acc, v);
+        }
+    }
+    return out;
+}
+
+
+// thrown to the tasks waiting for the prefix of a tile whose processing failed
+struct __tile_chain_aborted {};
+
+// number of chained tiles being processed by the current thread, nested by help-while-waiting
+inline std::size_t& __active_tiles() noexcept {
+    static thread_local std::size_t depth = 0;
+    return depth;
+}
+
+struct __active_tile_scope {
+    inline __active_tile_scope() noexcept { __active_tiles() += 1; }
+    inline ~__active_tile_scope() { __active_tiles() -= 1; }
+};
+
+
+// link of a tile in the chain of prefixes, see _internal_chained_tiles
+template <class T, class BinaryOperation>
+class __tile_chain {
+  public:
+    __tile_chain(std::vector<__scan_tile_state<T>>& tiles, std::size_t tile, const T* init, BinaryOperation& binary_op,
+                 const std::atomic<bool>& aborted)
+        : _tiles(tiles), _tile(tile), _init(init), _binary_op(binary_op), _aborted(aborted) {}
+
+    // publish the aggregate of the tile, return the prefix of the previous tiles
+    const T* operator()(const T& aggregate) {
+        const T* carry = _init;
+        if (_tile > 0) {
+            const __scan_tile_state<T>& previous = _tiles[_tile - 1];
+            for (std::size_t spin = 0; previous.ready.load(std::memory_order_acquire) == false; ++spin) {
+                if (spin >= 64) {
+                    if (_aborted.load(std::memory_order_relaxed)) {
+                        throw __tile_chain_aborted();
+                    }
+                    // the previous tile can wait on tasks of the executor: a worker executes them meanwhile
+                    thread::wait_helper* helper = thread::wait_helper::current();
+                    if (helper == nullptr || helper->help() == false) {
+                        std::this_thread::yield();
+                    }
+                }
             }
+            carry = &previous.prefix;
+        }
 
-            *local_first = binary_op(val, *local_first);
-            local_first++;
-        };
-    });
-    return d_first;
+        _tiles[_tile].prefix = (carry != nullptr) ? (_binary_op(*carry, aggregate)) : (aggregate);
+        _tiles[_tile].ready.store(true, std::memory_order_release);
+        return carry;
+    }
+
+  private:
+    std::vector<__scan_tile_state<T>>& _tiles;
+    std::size_t _tile;
+    const T* _init;
+    BinaryOperation& _binary_op;
+    const std::atomic<bool>& _aborted;
+};
+
+
+// single pass over the tiles of n_elems elements, with chained tile prefixes
+//
+// tiles are claimed in order by the tasks. fun(begin, end, chain) processes the tile [begin, end):
+// it computes the aggregate of the tile, then calls chain(aggregate) that waits for the prefix of the
+// previous tile, publishes the prefix of this tile and returns the combination of init and of the
+// aggregates of all the previous tiles ( nullptr for the first tile without init ).
+// The tile is usually still in cache when the task uses the returned prefix.
+//
+// an exception thrown by fun aborts the whole chain and is forwarded to the caller.
+// seed is only used to construct the tile states. Returns the prefix of the last tile, or seed
+//
+// fun can block, e.g. on a future: workers waiting inside a tile, on a future or on the chain,
+// execute other tasks of their executor, including tasks of this grid. A task started on a thread
+// that is inside a tile claims no tile, it would wait for the prefix of a tile lower on its own
+// stack. The first task runs on the calling thread and always claims the remaining tiles
+template <class ExecutionPolicy, class T, class BinaryOperation, class TileFunction>
+T _internal_chained_tiles(const ExecutionPolicy& policy, std::size_t n_elems, std::size_t tile_size, const T* init,
+                          const T& seed, BinaryOperation& binary_op, TileFunction fun) {
+    const std::size_t n_tiles = (n_elems + tile_size - 1) / tile_size;
+    const std::size_t num_tasks = std::min(__num_tasks(policy, n_elems), n_tiles);
+
+    if (n_tiles == 0) {
+        return (init != nullptr) ? (*init) : (seed);
+    }
+
+    std::vector<__scan_tile_state<T>> tiles(n_tiles, __scan_tile_state<T>(seed));
+    std::atomic<std::size_t> next_tile(0);
+    std::atomic<bool> aborted(false);
+
+    // a failure aborts the tiles waiting in the chain, only the original exception is forwarded
+    auto process_tiles = [&](int id, int) {
+        if (id != 0 && __active_tiles() != 0) {
+            return;
+        }
+
+        std::size_t tile;
+        while ((tile = next_tile.fetch_add(1, std::memory_order_relaxed)) < n_tiles &&
+               aborted.load(std::memory_order_relaxed) == false) {
+            const std::size_t begin = tile * tile_size, end = std::min(n_elems, begin + tile_size);
+
+            __tile_chain<T, BinaryOperation> chain(tiles, tile, init, binary_op, aborted);
+            __active_tile_scope active;
+            try {
+                fun(begin, end, chain);
+            } catch (__tile_chain_aborted&) {
+                return;
+            } catch (...) {
+                aborted.store(true);
+                throw;
+            }
+        }
+    };
+
+    if (num_tasks <= 1) {
+        process_tiles(0, 1);
+    } else {
+        __execute_grid(policy, static_cast<int>(num_tasks), process_tiles);
+    }
+    return tiles.back().prefix;
+}
+
+
+// single pass parallel scan of the n_elems elements of a cursor, with chained tile prefixes
+//
+// the task of a tile folds it, then scans it from the prefix of the previous tiles, still in cache.
+// Every element is read once from memory and written once.
+//
+// the decomposition in tiles does not depend on the number of tasks: results are reproducible.
+// Output elements are written after their input is read: the output can be the input range
+template <bool Inclusive, class ExecutionPolicy, class Cursor, class OutputIt, class T, class BinaryOperation>
+OutputIt _internal_transform_scan(const ExecutionPolicy& policy, Cursor first, std::size_t n_elems, OutputIt d_first,
+                                  const T* init, BinaryOperation& binary_op, std::random_access_iterator_tag) {
+    constexpr std::size_t tile_size = __scan_tile_size<T>();
+
+    if (n_elems <= tile_size || __num_tasks(policy, n_elems) <= 1) {
+        return __scan_block<Inclusive>(first, n_elems, d_first, init, binary_op);
+    }
+
+    _internal_chained_tiles(policy, n_elems, tile_size, init, (init != nullptr) ? (*init) : (T(*first)), binary_op,
+                            [&](std::size_t begin, std::size_t end, __tile_chain<T, BinaryOperation>& chain) {
+                                Cursor tile_first = first.advanced(begin);
+                                const T* carry = chain(__policy_fold_block<T>(policy, tile_first, end - begin, binary_op));
+                                __scan_block<Inclusive>(tile_first, end - begin, get_end_iterator(d_first, begin), carry,
+                                                        binary_op);
+                            });
+
+    return get_end_iterator(d_first, n_elems);
+}
+
+// ranges without random access are scanned sequentially
+template <bool Inclusive, class ExecutionPolicy, class Cursor, class OutputIt, class T, class BinaryOperation>
+OutputIt _internal_transform_scan(const ExecutionPolicy&, Cursor first, std::size_t n_elems, OutputIt d_first, const T* init,
+                                  BinaryOperation& binary_op, std::forward_iterator_tag) {
+    return __scan_block<Inclusive>(first, n_elems, d_first, init, binary_op);
+}
+
+template <bool Inclusive, class ExecutionPolicy, class Cursor, class OutputIt, class T, class BinaryOperation>
+OutputIt _internal_transform_scan(const ExecutionPolicy& policy, Cursor first, std::size_t n_elems, OutputIt d_first,
+                                  const T* init, BinaryOperation& binary_op) {
+    using input_category = typename std::iterator_traits<decltype(first.it)>::iterator_category;
+    using output_category = typename std::iterator_traits<OutputIt>::iterator_category;
+    using category = typename std::conditional<std::is_base_of<std::random_access_iterator_tag, input_category>::value &&
+                                                   std::is_base_of<std::random_access_iterator_tag, output_category>::value,
+                                               std::random_access_iterator_tag, std::forward_iterator_tag>::type;
+
+    return _internal_transform_scan<Inclusive>(policy, first, n_elems, d_first, init, binary_op, category());
 }
 
 } // namespace detail
@@ -125,19 +401,121 @@ template <class ExecutionPolicy, class InputIt, class OutputIt>
 OutputIt inclusive_scan(ExecutionPolicy&& policy, InputIt first, InputIt last, OutputIt d_first) {
     using value_type = typename std::iterator_traits<InputIt>::value_type;
 
-    return inclusive_scan(std::forward<ExecutionPolicy>(policy), first, last, d_first, std::plus<value_type>());
+    return hadoken::parallel::inclusive_scan(std::forward<ExecutionPolicy>(policy), first, last, d_first,
+                                             std::plus<value_type>());
 }
 
 // inclusive scan algorithm
 template <class ExecutionPolicy, class InputIt, class OutputIt, class BinaryOperation>
 OutputIt inclusive_scan(ExecutionPolicy&& policy, InputIt first, InputIt last, OutputIt d_first, BinaryOperation binary_op) {
-    if (detail::is_parallel_policy(policy)) {
-        // to improve
-        return detail::_internal_inclusive_scan(std::forward<ExecutionPolicy>(policy), first, last, d_first, binary_op);
-    }
-    return std::partial_sum(first, last, d_first, binary_op);
+    using value_type = typename std::iterator_traits<InputIt>::value_type;
+
+    return detail::_internal_transform_scan<true>(policy, detail::__deref_cursor<InputIt>{first},
+                                                  static_cast<std::size_t>(std::distance(first, last)), d_first,
+                                                  static_cast<const value_type*>(nullptr), binary_op);
+}
+
+// inclusive scan algorithm with initial value
+template <class ExecutionPolicy, class InputIt, class OutputIt, class BinaryOperation, class T>
+OutputIt inclusive_scan(ExecutionPolicy&& policy, InputIt first, InputIt last, OutputIt d_first, BinaryOperation binary_op,
+                        T init) {
+    return detail::_internal_transform_scan<true>(policy, detail::__deref_cursor<InputIt>{first},
+                                                  static_cast<std::size_t>(std::distance(first, last)), d_first, &init,
+                                                  binary_op);
+}
+
+// exclusive scan algorithm
+template <class ExecutionPolicy, class InputIt, class OutputIt, class T>
+OutputIt exclusive_scan(ExecutionPolicy&& policy, InputIt first, InputIt last, OutputIt d_first, T init) {
+    return hadoken::parallel::exclusive_scan(std::forward<ExecutionPolicy>(policy), first, last, d_first, init,
+                                             std::plus<T>());
+}
+
+// exclusive scan algorithm with binary op
+template <class ExecutionPolicy, class InputIt, class OutputIt, class T, class BinaryOperation>
+OutputIt exclusive_scan(ExecutionPolicy&& policy, InputIt first, InputIt last, OutputIt d_first, T init,
+                        BinaryOperation binary_op) {
+    return detail::_internal_transform_scan<false>(policy, detail::__deref_cursor<InputIt>{first},
+                                                   static_cast<std::size_t>(std::distance(first, last)), d_first, &init,
+                                                   binary_op);
 }
 
+
+// reduce algorithm
+template <class ExecutionPolicy, class InputIt>
+typename std::iterator_traits<InputIt>::value_type reduce(ExecutionPolicy&& policy, InputIt first, InputIt last) {
+    using value_type = typename std::iterator_traits<InputIt>::value_type;
+
+    return hadoken::parallel::reduce(std::forward<ExecutionPolicy>(policy), first, last, value_type(), std::plus<value_type>());
+}
+
+// reduce algorithm with initial value
+template <class ExecutionPolicy, class InputIt, class T>
+T reduce(ExecutionPolicy&& policy, InputIt first, InputIt last, T init) {
+    return hadoken::parallel::reduce(std::forward<ExecutionPolicy>(policy), first, last, init, std::plus<T>());
+}
+
+// reduce algorithm with initial value and binary op
+template <class ExecutionPolicy, class InputIt, class T, class BinaryOperation>
+T reduce(ExecutionPolicy&& policy, InputIt first, InputIt last, T init, BinaryOperation binary_op) {
+    return detail::_internal_transform_reduce(policy, detail::__deref_cursor<InputIt>{first},
+                                              static_cast<std::size_t>(std::distance(first, last)), init, binary_op);
+}
+
+// transform_reduce algorithm, inner product
+template <class ExecutionPolicy, class InputIt1, class InputIt2, class T>
+T transform_reduce(ExecutionPolicy&& policy, InputIt1 first1, InputIt1 last1, InputIt2 first2, T init) {
+    return hadoken::parallel::transform_reduce(std::forward<ExecutionPolicy>(policy), first1, last1, first2, init,
+                                               std::plus<T>(), std::multiplies<T>());
+}
+
+// transform_reduce algorithm, binary transform
+template <class ExecutionPolicy, class InputIt1, class InputIt2, class T, class BinaryOperation1, class BinaryOperation2>
+T transform_reduce(ExecutionPolicy&& policy, InputIt1 first1, InputIt1 last1, InputIt2 first2, T init,
+                   BinaryOperation1 reduce_op, BinaryOperation2 transform_op) {
+    return detail::_internal_transform_reduce(
+        policy, detail::__binary_cursor<InputIt1, InputIt2, BinaryOperation2>{first1, first2, &transform_op},
+        static_cast<std::size_t>(std::distance(first1, last1)), init, reduce_op);
+}
+
+// transform_reduce algorithm, unary transform
+template <class ExecutionPolicy, class InputIt, class T, class BinaryOperation, class UnaryOperation>
+T transform_reduce(ExecutionPolicy&& policy, InputIt first, InputIt last, T init, BinaryOperation reduce_op,
+                   UnaryOperation transform_op) {
+    return detail::_internal_transform_reduce(policy, detail::__unary_cursor<InputIt, UnaryOperation>{first, &transform_op},
+                                              static_cast<std::size_t>(std::distance(first, last)), init, reduce_op);
+}
+
+// transform_inclusive_scan algorithm
+template <class ExecutionPolicy, class InputIt, class OutputIt, class BinaryOperation, class UnaryOperation>
+OutputIt transform_inclusive_scan(ExecutionPolicy&& policy, InputIt first, InputIt last, OutputIt d_first,
+                                  BinaryOperation binary_op, UnaryOperation unary_op) {
+    using value_type = typename std::decay<decltype(unary_op(*first))>::type;
+
+    return detail::_internal_transform_scan<true>(policy, detail::__unary_cursor<InputIt, UnaryOperation>{first, &unary_op},
+                                                  static_cast<std::size_t>(std::distance(first, last)), d_first,
+                                                  static_cast<const value_type*>(nullptr), binary_op);
+}
+
+// transform_inclusive_scan algorithm with initial value
+template <class ExecutionPolicy, class InputIt, class OutputIt, class BinaryOperation, class UnaryOperation, class T>
+OutputIt transform_inclusive_scan(ExecutionPolicy&& policy, InputIt first, InputIt last, OutputIt d_first,
+                                  BinaryOperation binary_op, UnaryOperation unary_op, T init) {
+    return detail::_internal_transform_scan<true>(policy, detail::__unary_cursor<InputIt, UnaryOperation>{first, &unary_op},
+                                                  static_cast<std::size_t>(std::distance(first, last)), d_first, &init,
+                                                  binary_op);
+}
+
+// transform_exclusive_scan algorithm
+template <class ExecutionPolicy, class InputIt, class OutputIt, class T, class BinaryOperation, class UnaryOperation>
+OutputIt transform_exclusive_scan(ExecutionPolicy&& policy, InputIt first, InputIt last, OutputIt d_first, T init,
+                                  BinaryOperation binary_op, UnaryOperation unary_op) {
+    return detail::_internal_transform_scan<false>(policy, detail::__unary_cursor<InputIt, UnaryOperation>{first, &unary_op},
+                                                   static_cast<std::size_t>(std::distance(first, last)), d_first, &init,
+                                                   binary_op);
+}
+
+
 } // namespace parallel
 
 } // namespace hadoken
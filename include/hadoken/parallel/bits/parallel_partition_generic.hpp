@@ -0,0 +1,262 @@
+/**
+ * Copyright (c) 2016, Adrien Devresse <adrien.devresse@epfl.ch>
+ *
+ * Boost Software License - Version 1.0
+ *
+ * Permission is hereby granted, free of charge, to any person or organization
+ * obtaining a copy of the software and accompanying documentation covered by
+ * this license (the "Software") to use, reproduce, display, distribute,
+ * execute, and transmit the Software, and to prepare derivative works of the
+ * Software, and to permit third-parties to whom the Software is furnished to
+ * do so, all subject to the following:
+ *
+ * The copyright notices in the Software and this entire statement, including
+ * the above license grant, this restriction and the following disclaimer,
+ * must be included in all copies of the Software, in whole or in part, and
+ * all derivative works of the Software, unless such copies or derivative
+ * works are solely in the form of machine-executable object code generated by
+ * a source language processor.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+ * SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+ * FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ *
+ */
+#ifndef PARALLEL_PARTITION_GENERIC_HPP
+#define PARALLEL_PARTITION_GENERIC_HPP
+
+#include <algorithm>
+#include <bitset>
+#include <cstddef>
+#include <functional>
+#include <iterator>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <hadoken/parallel/algorithm.hpp>
+
+
+#include "parallel_find_generic.hpp"
+#include "parallel_generic_utils.hpp"
+#include "parallel_numeric_generic.hpp"
+
+
+namespace hadoken {
+
+
+namespace parallel {
+
+
+namespace detail {
+
+// the matches of a compaction tile are kept in a bitset: the predicate is called once per element
+constexpr std::size_t __compaction_max_tile = 16384;
+
+template <typename T>
+constexpr std::size_t __compaction_tile_size() {
+    return (sizeof(T) >= 64) ? (1024)
+                             : (((65536 / sizeof(T)) > __compaction_max_tile) ? (__compaction_max_tile) : (65536 / sizeof(T)));
+}
+
+using __compaction_chain = __tile_chain<std::size_t, std::plus<std::size_t>>;
+
+
+// evaluate p on the tile [it, it + n), return the number of matches
+template <class InputIt, class UnaryPredicate>
+std::size_t __match_tile(InputIt it, std::size_t n, UnaryPredicate& p, std::bitset<__compaction_max_tile>& matches) {
+    std::size_t count = 0;
+    for (std::size_t i = 0; i < n; ++i, ++it) {
+        if (p(*it)) {
+            matches.set(i);
+            count += 1;
+        }
+    }
+    return count;
+}
+
+
+// stream compaction in a single pass: every tile counts its matches, gets its output offset
+// from the chain of tile prefixes, and scatters its matches while still in cache
+template <class ExecutionPolicy, class InputIt, class OutputIt, class UnaryPredicate>
+OutputIt _internal_copy_if(const ExecutionPolicy& policy, InputIt first, std::size_t n_elems, OutputIt d_first,
+                           UnaryPredicate& p) {
+    using value_type = typename std::iterator_traits<InputIt>::value_type;
+
+    const std::size_t zero = 0;
+    std::plus<std::size_t> sum;
+
+    const std::size_t n_copied = _internal_chained_tiles(
+        policy, n_elems, __compaction_tile_size<value_type>(), &zero, zero, sum,
+        [&](std::size_t begin, std::size_t end, __compaction_chain& chain) {
+            std::bitset<__compaction_max_tile> matches;
+            InputIt tile_first = get_end_iterator(first, begin);
+
+            const std::size_t offset = *chain(__match_tile(tile_first, end - begin, p, matches));
+
+            OutputIt out = get_end_iterator(d_first, offset);
+            for (std::size_t i = 0; i < end - begin; ++i, ++tile_first) {
+                if (matches[i]) {
+                    *out = *tile_first;
+                    ++out;
+                }
+            }
+        });
+
+    return get_end_iterator(d_first, n_copied);
+}
+
+
+template <class ExecutionPolicy, class RandomIt, class RandomOutputIt, class UnaryPredicate>
+RandomOutputIt _internal_copy_if_dispatch(const ExecutionPolicy& policy, RandomIt first, RandomIt last, RandomOutputIt d_first,
+                                          UnaryPredicate& p, std::true_type) {
+    return _internal_copy_if(policy, first, static_cast<std::size_t>(std::distance(first, last)), d_first, p);
+}
+
+// the output offsets of the tiles are only known at runtime: sequential without random access
+template <class ExecutionPolicy, class InputIt, class OutputIt, class UnaryPredicate>
+OutputIt _internal_copy_if_dispatch(const ExecutionPolicy&, InputIt first, InputIt last, OutputIt d_first, UnaryPredicate& p,
+                                    std::false_type) {
+    return std::copy_if(first, last, d_first, p);
+}
+
+
+// stable partition through a buffer, returns the number of elements satisfying p
+//
+// in a single pass, the elements satisfying p are moved to the front of the buffer in order,
+// the others to the back of the buffer in reverse order. The buffer is then moved back in parallel,
+// without the elements that do not satisfy p if move_back_rejected is false
+template <class ExecutionPolicy, class RandomIt, class UnaryPredicate>
+std::size_t _internal_stable_partition(const ExecutionPolicy& policy, RandomIt first, std::size_t n_elems, UnaryPredicate& p,
+                                       bool move_back_rejected) {
+    using value_type = typename std::iterator_traits<RandomIt>::value_type;
+
+    std::vector<value_type> buffer(n_elems);
+
+    const std::size_t zero = 0;
+    std::plus<std::size_t> sum;
+
+    const std::size_t n_accepted = _internal_chained_tiles(
+        policy, n_elems, __compaction_tile_size<value_type>(), &zero, zero, sum,
+        [&](std::size_t begin, std::size_t end, __compaction_chain& chain) {
+            std::bitset<__compaction_max_tile> matches;
+            RandomIt tile_first = first + begin;
+
+            std::size_t accepted = *chain(__match_tile(tile_first, end - begin, p, matches));
+            std::size_t rejected = begin - accepted;
+
+            for (std::size_t i = 0; i < end - begin; ++i, ++tile_first) {
+                if (matches[i]) {
+                    buffer[accepted++] = std::move(*tile_first);
+                } else {
+                    buffer[n_elems - 1 - (rejected++)] = std::move(*tile_first);
+                }
+            }
+        });
+
+    const std::size_t n_moved = (move_back_rejected) ? (n_elems) : (n_accepted);
+    const std::size_t num_tasks = __num_tasks(policy, n_moved);
+    const std::size_t n_blocks = __num_blocks(n_moved, num_tasks);
+
+    __for_each_block(policy, num_tasks, n_blocks, [&](std::size_t block) {
+        const std::size_t begin = __block_begin(n_moved, n_blocks, block), end = __block_begin(n_moved, n_blocks, block + 1);
+
+        const std::size_t accepted_end = std::max(begin, std::min(end, n_accepted));
+        std::move(buffer.begin() + begin, buffer.begin() + accepted_end, first + begin);
+
+        for (std::size_t i = accepted_end; i < end; ++i) {
+            first[i] = std::move(buffer[n_elems - 1 - (i - n_accepted)]);
+        }
+    });
+
+    return n_accepted;
+}
+
+
+// compaction in place requires random access and a buffer of default constructed values
+template <class RandomIt>
+struct __is_compactable
+    : std::integral_constant<bool, __is_random_access<RandomIt>::value &&
+                                       std::is_default_constructible<typename std::iterator_traits<RandomIt>::value_type>::value &&
+                                       std::is_move_assignable<typename std::iterator_traits<RandomIt>::value_type>::value> {};
+
+
+template <class ExecutionPolicy, class RandomIt, class UnaryPredicate, class Fallback>
+RandomIt _internal_stable_partition_dispatch(const ExecutionPolicy& policy, RandomIt first, RandomIt last, UnaryPredicate& p,
+                                             bool move_back_rejected, Fallback&, std::true_type) {
+    const std::size_t n_elems = static_cast<std::size_t>(std::distance(first, last));
+    return first + _internal_stable_partition(policy, first, n_elems, p, move_back_rejected);
+}
+
+// otherwise, sequential std algorithm
+template <class ExecutionPolicy, class ForwardIt, class UnaryPredicate, class Fallback>
+ForwardIt _internal_stable_partition_dispatch(const ExecutionPolicy&, ForwardIt, ForwardIt, UnaryPredicate&, bool,
+                                              Fallback& fallback, std::false_type) {
+    return fallback();
+}
+
+} // namespace detail
+
+
+
+/// parallel copy_if algorithm
+template <class ExecutionPolicy, class InputIterator, class OutputIterator, class UnaryPredicate>
+OutputIterator copy_if(ExecutionPolicy&& policy, InputIterator first, InputIterator last, OutputIterator d_first,
+                       UnaryPredicate p) {
+    if (detail::is_parallel_policy(policy)) {
+        return detail::_internal_copy_if_dispatch(
+            policy, first, last, d_first, p,
+            std::integral_constant<bool, detail::__is_random_access<InputIterator>::value &&
+                                             detail::__is_random_access<OutputIterator>::value>());
+    }
+    return std::copy_if(first, last, d_first, p);
+}
+
+/// parallel remove_if algorithm
+template <class ExecutionPolicy, class ForwardIterator, class UnaryPredicate>
+ForwardIterator remove_if(ExecutionPolicy&& policy, ForwardIterator first, ForwardIterator last, UnaryPredicate p) {
+    using reference = typename std::iterator_traits<ForwardIterator>::reference;
+
+    if (detail::is_parallel_policy(policy)) {
+        auto keep = [&p](reference v) { return !p(v); };
+        auto fallback = [&]() { return std::remove_if(first, last, p); };
+        return detail::_internal_stable_partition_dispatch(policy, first, last, keep, false, fallback,
+                                                           detail::__is_compactable<ForwardIterator>());
+    }
+    return std::remove_if(first, last, p);
+}
+
+/// parallel stable_partition algorithm
+template <class ExecutionPolicy, class BidirectionalIterator, class UnaryPredicate>
+BidirectionalIterator stable_partition(ExecutionPolicy&& policy, BidirectionalIterator first, BidirectionalIterator last,
+                                       UnaryPredicate p) {
+    if (detail::is_parallel_policy(policy)) {
+        auto fallback = [&]() { return std::stable_partition(first, last, p); };
+        return detail::_internal_stable_partition_dispatch(policy, first, last, p, true, fallback,
+                                                           detail::__is_compactable<BidirectionalIterator>());
+    }
+    return std::stable_partition(first, last, p);
+}
+
+/// parallel partition algorithm
+template <class ExecutionPolicy, class ForwardIterator, class UnaryPredicate>
+ForwardIterator partition(ExecutionPolicy&& policy, ForwardIterator first, ForwardIterator last, UnaryPredicate p) {
+    if (detail::is_parallel_policy(policy)) {
+        // the stable partition is the single pass one
+        auto fallback = [&]() { return std::partition(first, last, p); };
+        return detail::_internal_stable_partition_dispatch(policy, first, last, p, true, fallback,
+                                                           detail::__is_compactable<ForwardIterator>());
+    }
+    return std::partition(first, last, p);
+}
+
+
+} // namespace parallel
+
+} // namespace hadoken
+
+#endif // PARALLEL_PARTITION_GENERIC_HPP
@@ -0,0 +1,272 @@
+/**
+ * Copyright (c) 2016, Adrien Devresse <adrien.devresse@epfl.ch>
+ *
+ * Boost Software License - Version 1.0
+ *
+ * Permission is hereby granted, free of charge, to any person or organization
+ * obtaining a copy of the software and accompanying documentation covered by
+ * this license (the "Software") to use, reproduce, display, distribute,
+ * execute, and transmit the Software, and to prepare derivative works of the
+ * Software, and to permit third-parties to whom the Software is furnished to
+ * do so, all subject to the following:
+ *
+ * The copyright notices in the Software and this entire statement, including
+ * the above license grant, this restriction and the following disclaimer,
+ * must be included in all copies of the Software, in whole or in part, and
+ * all derivative works of the Software, unless such copies or derivative
+ * works are solely in the form of machine-executable object code generated by
+ * a source language processor.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+ * SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+ * FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ *
+ */
+#ifndef PARALLEL_RADIX_SORT_GENERIC_HPP
+#define PARALLEL_RADIX_SORT_GENERIC_HPP
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <limits>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <hadoken/parallel/algorithm.hpp>
+
+
+#include "parallel_generic_utils.hpp"
+
+
+namespace hadoken {
+
+
+namespace parallel {
+
+
+namespace detail {
+
+// minimum number of elements processed by a task of the radix sort
+constexpr std::size_t __radix_min_chunk = 16384;
+
+// below this size, a comparison sort on the ordered keys is faster
+constexpr std::size_t __radix_min_elements = 256;
+
+constexpr std::size_t __radix_bits = 8;
+constexpr std::size_t __radix_digits = std::size_t(1) << __radix_bits;
+
+
+// bitwise representation of a key where the unsigned order is the order of the key
+template <typename Key, typename Enable = void>
+struct __radix_traits {
+    static_assert(std::is_integral<Key>::value || std::is_floating_point<Key>::value,
+                  "radix_sort requires integral or floating point keys");
+};
+
+template <typename Key>
+struct __radix_traits<Key, typename std::enable_if<std::is_integral<Key>::value && std::is_unsigned<Key>::value>::type> {
+    using unsigned_type = Key;
+
+    static unsigned_type ordered(Key k) { return k; }
+};
+
+// signed integers: the sign bit is flipped
+template <typename Key>
+struct __radix_traits<Key, typename std::enable_if<std::is_integral<Key>::value && std::is_signed<Key>::value>::type> {
+    using unsigned_type = typename std::make_unsigned<Key>::type;
+
+    static unsigned_type ordered(Key k) {
+        return static_cast<unsigned_type>(k) ^ (unsigned_type(1) << (std::numeric_limits<unsigned_type>::digits - 1));
+    }
+};
+
+// IEEE 754 floats: all the bits of negative values are flipped, only the sign bit of positive values
+template <typename Key>
+struct __radix_traits<Key, typename std::enable_if<std::is_floating_point<Key>::value>::type> {
+    static_assert(std::numeric_limits<Key>::is_iec559 && (sizeof(Key) == 4 || sizeof(Key) == 8),
+                  "radix_sort requires IEEE 754 single or double precision floating point keys");
+
+    using unsigned_type = typename std::conditional<sizeof(Key) == 4, std::uint32_t, std::uint64_t>::type;
+
+    static unsigned_type ordered(Key k) {
+        constexpr unsigned_type sign_bit = unsigned_type(1) << (std::numeric_limits<unsigned_type>::digits - 1);
+
+        unsigned_type bits;
+        std::memcpy(&bits, &k, sizeof(bits));
+        return ((bits & sign_bit) != 0) ? (~bits) : (bits | sign_bit);
+    }
+};
+
+
+// number of elements per digit in the write combining buffers: two cache lines
+template <typename T>
+constexpr std::size_t __radix_combining_size() {
+    return (sizeof(T) >= 128) ? (1) : (128 / sizeof(T));
+}
+
+
+// one LSD pass: stable scatter of [src, src + n) to dst, on the digit at bit shift
+//
+// every task counts the digits of its block, the per task histograms are turned
+// into offsets with a digit major exclusive prefix sum, then every task scatters its block
+// through write combining buffers: elements are staged per digit and flushed by lines
+//
+// returns false without moving anything if all the elements have the same digit
+template <typename ExecutionPolicy, typename ValueIt, typename KeyFunction>
+bool _radix_pass(const ExecutionPolicy& policy, ValueIt src, ValueIt dst, std::size_t n, std::size_t num_tasks,
+                 unsigned int shift, KeyFunction& ordered_key, std::vector<std::size_t>& offsets) {
+    using value_type = typename std::iterator_traits<ValueIt>::value_type;
+    constexpr std::size_t line_size = __radix_combining_size<value_type>();
+
+    std::fill(offsets.begin(), offsets.end(), 0);
+
+    auto count = [&](int id, int) {
+        std::size_t* histogram = offsets.data() + static_cast<std::size_t>(id) * __radix_digits;
+        for (std::size_t i = __block_begin(n, num_tasks, id); i < __block_begin(n, num_tasks, id + 1); ++i) {
+            histogram[(ordered_key(*(src + i)) >> shift) & (__radix_digits - 1)] += 1;
+        }
+    };
+
+    auto scatter = [&](int id, int) {
+        std::size_t* positions = offsets.data() + static_cast<std::size_t>(id) * __radix_digits;
+
+        std::vector<value_type> lines(__radix_digits * line_size);
+        std::size_t fill[__radix_digits] = {};
+
+        for (std::size_t i = __block_begin(n, num_tasks, id); i < __block_begin(n, num_tasks, id + 1); ++i) {
+            value_type& v = *(src + i);
+            const std::size_t digit = (ordered_key(v) >> shift) & (__radix_digits - 1);
+            value_type* line = lines.data() + digit * line_size;
+
+            line[fill[digit]++] = std::move(v);
+            if (fill[digit] == line_size) {
+                std::move(line, line + line_size, dst + positions[digit]);
+                positions[digit] += line_size;
+                fill[digit] = 0;
+            }
+        }
+
+        for (std::size_t digit = 0; digit < __radix_digits; ++digit) {
+            value_type* line = lines.data() + digit * line_size;
+            std::move(line, line + fill[digit], dst + positions[digit]);
+            positions[digit] += fill[digit];
+        }
+    };
+
+    if (num_tasks > 1) {
+        __execute_grid(policy, static_cast<int>(num_tasks), count);
+    } else {
+        count(0, 1);
+    }
+
+    // digit major exclusive prefix sum of the histograms
+    std::size_t total = 0;
+    for (std::size_t digit = 0; digit < __radix_digits; ++digit) {
+        std::size_t digit_count = 0;
+        for (std::size_t task = 0; task < num_tasks; ++task) {
+            std::size_t& offset = offsets[task * __radix_digits + digit];
+            const std::size_t c = offset;
+            offset = total;
+            total += c;
+            digit_count += c;
+        }
+
+        if (digit_count == n) {
+            return false;
+        }
+    }
+
+    if (num_tasks > 1) {
+        __execute_grid(policy, static_cast<int>(num_tasks), scatter);
+    } else {
+        scatter(0, 1);
+    }
+    return true;
+}
+
+
+template <typename ExecutionPolicy, typename RandomIt, typename KeyFunction>
+void _internal_radix_sort(const ExecutionPolicy& policy, RandomIt first, RandomIt last, KeyFunction key, bool parallel) {
+    using value_type = typename std::iterator_traits<RandomIt>::value_type;
+    using key_type = typename std::decay<decltype(key(std::declval<const value_type&>()))>::type;
+    using traits = __radix_traits<key_type>;
+    using unsigned_type = typename traits::unsigned_type;
+
+    static_assert(std::is_default_constructible<value_type>::value && std::is_move_assignable<value_type>::value,
+                  "radix_sort requires default constructible and move assignable values");
+
+    auto ordered_key = [&key](const value_type& v) -> unsigned_type { return traits::ordered(key(v)); };
+
+    const std::size_t n = static_cast<std::size_t>(std::distance(first, last));
+
+    if (n < __radix_min_elements) {
+        std::stable_sort(first, last, [&ordered_key](const value_type& a, const value_type& b) {
+            return ordered_key(a) < ordered_key(b);
+        });
+        return;
+    }
+
+    const std::size_t num_tasks =
+        (parallel) ? (std::max<std::size_t>(1, std::min(__grid_size(policy, n), n / __radix_min_chunk))) : (1);
+
+    std::vector<value_type> buffer(n);
+    std::vector<std::size_t> offsets(num_tasks * __radix_digits);
+
+    // ping pong between the input and the buffer, passes on a constant digit are skipped
+    bool in_buffer = false;
+    for (unsigned int shift = 0; shift < sizeof(unsigned_type) * 8; shift += __radix_bits) {
+        const bool moved = (in_buffer) ? (_radix_pass(policy, buffer.begin(), first, n, num_tasks, shift, ordered_key, offsets))
+                                       : (_radix_pass(policy, first, buffer.begin(), n, num_tasks, shift, ordered_key, offsets));
+        in_buffer = (moved) ? (!in_buffer) : (in_buffer);
+    }
+
+    if (in_buffer) {
+        auto move_back = [&](int id, int num_executor) {
+            const std::size_t begin = __block_begin(n, num_executor, id), end = __block_begin(n, num_executor, id + 1);
+            std::move(buffer.begin() + begin, buffer.begin() + end, first + begin);
+        };
+
+        if (num_tasks > 1) {
+            __execute_grid(policy, static_cast<int>(num_tasks), move_back);
+        } else {
+            move_back(0, 1);
+        }
+    }
+}
+
+
+template <typename T>
+struct __radix_identity {
+    const T& operator()(const T& v) const { return v; }
+};
+
+} // namespace detail
+
+
+// radix sort algorithm
+template <class ExecutionPolicy, class RandomIt>
+void radix_sort(ExecutionPolicy&& policy, RandomIt first, RandomIt last) {
+    using value_type = typename std::iterator_traits<RandomIt>::value_type;
+
+    detail::_internal_radix_sort(policy, first, last, detail::__radix_identity<value_type>(),
+                                 detail::is_parallel_policy(policy));
+}
+
+// radix sort algorithm on the key returned by key_function
+template <class ExecutionPolicy, class RandomIt, class KeyFunction>
+void radix_sort_by_key(ExecutionPolicy&& policy, RandomIt first, RandomIt last, KeyFunction key_function) {
+    detail::_internal_radix_sort(policy, first, last, key_function, detail::is_parallel_policy(policy));
+}
+
+
+} // namespace parallel
+
+} // namespace hadoken
+
+#endif // PARALLEL_RADIX_SORT_GENERIC_HPP
@@ -0,0 +1,450 @@
+/**
+ * Copyright (c) 2016, Adrien Devresse <adrien.devresse@epfl.ch>
+ *
+ * Boost Software License - Version 1.0
+ *
+ * Permission is hereby granted, free of charge, to any person or organization
+ * obtaining a copy of the software and accompanying documentation covered by
+ * this license (the "Software") to use, reproduce, display, distribute,
+ * execute, and transmit the Software, and to prepare derivative works of the
+ * Software, and to permit third-parties to whom the Software is furnished to
+ * do so, all subject to the following:
+ *
+ * The copyright notices in the Software and this entire statement, including
+ * the above license grant, this restriction and the following disclaimer,
+ * must be included in all copies of the Software, in whole or in part, and
+ * all derivative works of the Software, unless such copies or derivative
+ * works are solely in the form of machine-executable object code generated by
+ * a source language processor.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+ * SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+ * FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ *
+ */
+#ifndef PARALLEL_SIMD_GENERIC_HPP
+#define PARALLEL_SIMD_GENERIC_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <type_traits>
+#include <vector>
+
+#include <hadoken/config/platform_config.hpp>
+#include <hadoken/os/topology.hpp>
+#include <hadoken/parallel/algorithm.hpp>
+
+#if (defined __SSE2__)
+#include <emmintrin.h>
+#endif
+
+#include "parallel_generic_utils.hpp"
+
+
+namespace hadoken {
+
+
+namespace parallel {
+
+
+namespace detail {
+
+//
+// vectorized kernels of the parallel_vector_execution_policy
+//
+// every task runs the kernels on its own slice of a contiguous range of arithmetic values.
+// The kernels are written as loops over blocks of a fixed number of bytes that the compiler vectorizes,
+// they are compiled for several instruction sets and the best one supported by the cpu is selected at runtime.
+//
+// Define HADOKEN_PARALLEL_NO_SIMD_DISPATCH to only use the instruction set selected at compile time
+//
+
+// instruction sets of the kernels, in increasing order
+enum class __simd_isa { generic = 0, sse2 = 1, avx2 = 2, avx512 = 3 };
+
+inline __simd_isa __simd_detect_isa() {
+#if (defined HADOKEN_PLATFORM_HAS_X86_TARGETS) && !(defined HADOKEN_PARALLEL_NO_SIMD_DISPATCH)
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512bw")) {
+        return __simd_isa::avx512;
+    }
+    if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")) {
+        return __simd_isa::avx2;
+    }
+    if (__builtin_cpu_supports("sse2")) {
+        return __simd_isa::sse2;
+    }
+#endif
+    return __simd_isa::generic;
+}
+
+// best instruction set of the cpu, detected once
+inline __simd_isa __simd_cpu_isa() {
+    static const __simd_isa isa = __simd_detect_isa();
+    return isa;
+}
+
+
+// bytes of a block of the kernel loops: one AVX-512 register, two AVX2 or four SSE2 registers
+constexpr std::size_t __simd_block_bytes = 64;
+
+// elements of type T in a block
+template <typename T>
+constexpr std::size_t __simd_lanes() {
+    return (sizeof(T) >= __simd_block_bytes) ? (1) : (__simd_block_bytes / sizeof(T));
+}
+
+
+template <typename T>
+struct __is_simd_arithmetic
+    : std::integral_constant<bool, std::is_arithmetic<T>::value && !std::is_same<typename std::remove_cv<T>::type, bool>::value> {
+};
+
+// iterators on contiguous arithmetic values
+template <typename Iterator,
+          bool Arithmetic = __is_simd_arithmetic<typename std::iterator_traits<Iterator>::value_type>::value>
+struct __is_simd_iterator : std::false_type {};
+
+template <typename Iterator>
+struct __is_simd_iterator<Iterator, true> {
+    using value_type = typename std::iterator_traits<Iterator>::value_type;
+
+    static constexpr bool value = std::is_pointer<Iterator>::value ||
+                                  std::is_same<Iterator, typename std::vector<value_type>::iterator>::value ||
+                                  std::is_same<Iterator, typename std::vector<value_type>::const_iterator>::value;
+};
+
+template <typename ExecPolicy>
+struct __is_vector_policy
+    : std::is_same<typename std::decay<ExecPolicy>::type, parallel_vector_execution_policy> {};
+
+// reductions vectorized with one accumulator per lane: associative and commutative operations on arithmetic values
+template <typename T, typename BinaryOperation>
+struct __is_simd_reduction
+    : std::integral_constant<bool, __is_simd_arithmetic<T>::value && (std::is_same<BinaryOperation, std::plus<T>>::value ||
+                                                                      std::is_same<BinaryOperation, std::multiplies<T>>::value)> {
+};
+
+
+// pointer on the element of a contiguous iterator, the iterator must be dereferenceable
+template <typename Iterator>
+inline auto __simd_pointer(Iterator it) -> decltype(std::addressof(*it)) {
+    return std::addressof(*it);
+}
+
+template <typename T>
+inline T* __simd_assume_aligned(T* ptr) {
+#if (defined HADOKEN_COMPILER_IS_GNU_COMPATIBLE)
+    return static_cast<T*>(__builtin_assume_aligned(ptr, __simd_block_bytes));
+#else
+    return ptr;
+#endif
+}
+
+// number of elements before the first block aligned element of ptr, n if the elements can not be aligned
+template <typename T>
+inline std::size_t __simd_prologue(const T* ptr, std::size_t n) {
+    const std::size_t misalignment = static_cast<std::size_t>(reinterpret_cast<std::uintptr_t>(ptr) % __simd_block_bytes);
+    if (misalignment % sizeof(T) != 0) {
+        return n;
+    }
+    return std::min(n, ((__simd_block_bytes - misalignment) % __simd_block_bytes) / sizeof(T));
+}
+
+// true if the memory of two arrays overlaps
+template <typename T, typename U>
+inline bool __simd_overlap(const T* a, std::size_t n_a, const U* b, std::size_t n_b) {
+    const std::uintptr_t a_begin = reinterpret_cast<std::uintptr_t>(a), b_begin = reinterpret_cast<std::uintptr_t>(b);
+    return (a_begin < b_begin + n_b * sizeof(U)) && (b_begin < a_begin + n_a * sizeof(T));
+}
+
+// true if two arrays of n elements overlap, without being the same array
+template <typename T, typename U>
+inline bool __simd_partial_overlap(const T* a, const U* b, std::size_t n) {
+    const bool same = (sizeof(T) == sizeof(U)) && (static_cast<const void*>(a) == static_cast<const void*>(b));
+    return (same == false) && __simd_overlap(a, n, b, n);
+}
+
+
+//
+// kernels, stores are aligned on blocks after a scalar prologue, the remaining elements are
+// processed by a scalar epilogue. The output of a kernel never partially overlaps its inputs:
+// an input can only be the output array itself, every element is read before it is written.
+// For that reason the transform kernels do not declare their output restrict, the compiler
+// versions the vector loop on a runtime alias check instead.
+//
+
+// n_blocks blocks of the aligned array out
+template <typename T>
+HADOKEN_ALWAYS_INLINE void __simd_fill_blocks(T* HADOKEN_RESTRICT out, std::size_t n_blocks, T value) {
+    constexpr std::size_t lanes = __simd_lanes<T>();
+    out = __simd_assume_aligned(out);
+
+    for (std::size_t block = 0; block < n_blocks; ++block) {
+        for (std::size_t k = 0; k < lanes; ++k) {
+            out[block * lanes + k] = value;
+        }
+    }
+}
+
+template <typename U, typename Operation, typename... V>
+HADOKEN_ALWAYS_INLINE void __simd_transform_blocks(U* out, std::size_t n_blocks, Operation* op, V*... in) {
+    constexpr std::size_t lanes = __simd_lanes<U>();
+    out = __simd_assume_aligned(out);
+
+    for (std::size_t block = 0; block < n_blocks; ++block) {
+        for (std::size_t k = 0; k < lanes; ++k) {
+            out[block * lanes + k] = (*op)(in[block * lanes + k]...);
+        }
+    }
+}
+
+// non temporal store of an aligned block, written to memory without reading it in the caches
+template <typename U>
+HADOKEN_ALWAYS_INLINE void __simd_stream_block(U* out, const U* block) {
+#if (defined __SSE2__)
+    static_assert(__simd_block_bytes == 4 * sizeof(__m128i), "a block is four SSE2 registers");
+    const __m128i* src = reinterpret_cast<const __m128i*>(block);
+    __m128i* dst = reinterpret_cast<__m128i*>(out);
+
+    _mm_stream_si128(dst, _mm_load_si128(src));
+    _mm_stream_si128(dst + 1, _mm_load_si128(src + 1));
+    _mm_stream_si128(dst + 2, _mm_load_si128(src + 2));
+    _mm_stream_si128(dst + 3, _mm_load_si128(src + 3));
+#else
+    std::copy(block, block + __simd_lanes<U>(), out);
+#endif
+}
+
+// order the non temporal stores before the following stores
+HADOKEN_ALWAYS_INLINE void __simd_stream_fence() {
+#if (defined __SSE2__)
+    _mm_sfence();
+#endif
+}
+
+template <typename U, typename Operation, typename... V>
+HADOKEN_ALWAYS_INLINE void __simd_stream_transform_blocks(U* out, std::size_t n_blocks, Operation* op, V*... in) {
+    constexpr std::size_t lanes = __simd_lanes<U>();
+    alignas(__simd_block_bytes) U block_values[lanes];
+
+    for (std::size_t block = 0; block < n_blocks; ++block) {
+        for (std::size_t k = 0; k < lanes; ++k) {
+            block_values[k] = (*op)(in[block * lanes + k]...);
+        }
+        __simd_stream_block(out + block * lanes, block_values);
+    }
+    __simd_stream_fence();
+}
+
+
+struct __simd_fill_kernel {
+    template <typename T>
+    static HADOKEN_ALWAYS_INLINE void run(T* out, std::size_t n, T value) {
+        constexpr std::size_t lanes = __simd_lanes<T>();
+        const std::size_t prologue = __simd_prologue(out, n), n_blocks = (n - prologue) / lanes;
+
+        for (std::size_t i = 0; i < prologue; ++i) {
+            out[i] = value;
+        }
+
+        __simd_fill_blocks(out + prologue, n_blocks, value);
+
+        for (std::size_t i = prologue + n_blocks * lanes; i < n; ++i) {
+            out[i] = value;
+        }
+    }
+};
+
+
+// n-ary transform, blocks are written with non temporal stores if streaming is true
+struct __simd_transform_kernel {
+    template <typename U, typename Operation, typename... V>
+    static HADOKEN_ALWAYS_INLINE void run(U* out, std::size_t n, bool streaming, Operation* op, V*... in) {
+        constexpr std::size_t lanes = __simd_lanes<U>();
+        const std::size_t prologue = __simd_prologue(out, n), n_blocks = (n - prologue) / lanes;
+
+        for (std::size_t i = 0; i < prologue; ++i) {
+            out[i] = (*op)(in[i]...);
+        }
+
+        if (streaming) {
+            __simd_stream_transform_blocks(out + prologue, n_blocks, op, (in + prologue)...);
+        } else {
+            __simd_transform_blocks(out + prologue, n_blocks, op, (in + prologue)...);
+        }
+
+        for (std::size_t i = prologue + n_blocks * lanes; i < n; ++i) {
+            out[i] = (*op)(in[i]...);
+        }
+    }
+};
+
+
+// fold of the n > 0 transformed elements of an array with one accumulator per lane of a block
+//
+// loads are not aligned: the lane of an element only depends on its position, the result does not depend
+// on the alignment of the array. Integer results do not depend on the instruction set either, floating point
+// results can differ in the last bits when the instruction set contracts multiplications and additions
+template <typename T>
+struct __simd_fold_kernel {
+    template <typename V, typename UnaryOperation, typename BinaryOperation>
+    static HADOKEN_ALWAYS_INLINE T run(V* HADOKEN_RESTRICT in, std::size_t n, UnaryOperation* transform_op,
+                                       BinaryOperation* reduce_op) {
+        constexpr std::size_t lanes = __simd_lanes<T>();
+
+        if (n < 2 * lanes) {
+            T res = T((*transform_op)(in[0]));
+            for (std::size_t i = 1; i < n; ++i) {
+                res = (*reduce_op)(res, T((*transform_op)(in[i])));
+            }
+            return res;
+        }
+
+        const std::size_t n_blocks = n / lanes;
+
+        T acc[lanes];
+        for (std::size_t k = 0; k < lanes; ++k) {
+            acc[k] = T((*transform_op)(in[k]));
+        }
+
+        for (std::size_t block = 1; block < n_blocks; ++block) {
+            for (std::size_t k = 0; k < lanes; ++k) {
+                acc[k] = (*reduce_op)(acc[k], T((*transform_op)(in[block * lanes + k])));
+            }
+        }
+
+        T res = acc[0];
+        for (std::size_t k = 1; k < lanes; ++k) {
+            res = (*reduce_op)(res, acc[k]);
+        }
+
+        for (std::size_t i = n_blocks * lanes; i < n; ++i) {
+            res = (*reduce_op)(res, T((*transform_op)(in[i])));
+        }
+        return res;
+    }
+};
+
+
+//
+// instruction set dispatch, the kernels are inlined in a function compiled for every instruction set
+//
+
+template <typename Kernel, typename... Args>
+inline auto __simd_run_generic(Args... args) -> decltype(Kernel::run(args...)) {
+    return Kernel::run(args...);
+}
+
+#if (defined HADOKEN_PLATFORM_HAS_X86_TARGETS) && !(defined HADOKEN_PARALLEL_NO_SIMD_DISPATCH)
+
+template <typename Kernel, typename... Args>
+__attribute__((target("sse2"))) inline auto __simd_run_sse2(Args... args) -> decltype(Kernel::run(args...)) {
+    return Kernel::run(args...);
+}
+
+template <typename Kernel, typename... Args>
+__attribute__((target("avx2,fma"))) inline auto __simd_run_avx2(Args... args) -> decltype(Kernel::run(args...)) {
+    return Kernel::run(args...);
+}
+
+template <typename Kernel, typename... Args>
+__attribute__((target("avx512f,avx512bw"))) inline auto __simd_run_avx512(Args... args) -> decltype(Kernel::run(args...)) {
+    return Kernel::run(args...);
+}
+
+#endif
+
+// run a kernel with an instruction set, that must be supported by the cpu
+template <typename Kernel, typename... Args>
+inline auto __simd_invoke(__simd_isa isa, Args... args) -> decltype(Kernel::run(args...)) {
+#if (defined HADOKEN_PLATFORM_HAS_X86_TARGETS) && !(defined HADOKEN_PARALLEL_NO_SIMD_DISPATCH)
+    switch (isa) {
+    case __simd_isa::avx512:
+        return __simd_run_avx512<Kernel>(args...);
+    case __simd_isa::avx2:
+        return __simd_run_avx2<Kernel>(args...);
+    case __simd_isa::sse2:
+        return __simd_run_sse2<Kernel>(args...);
+    default:
+        break;
+    }
+#endif
+    (void)isa;
+    return __simd_run_generic<Kernel>(args...);
+}
+
+
+//
+// vectorized slices of the algorithms, iterators must satisfy __is_simd_iterator
+//
+
+template <typename Iterator, typename T>
+void __simd_fill(Iterator first, std::size_t n, const T& value, __simd_isa isa = __simd_cpu_isa()) {
+    using value_type = typename std::iterator_traits<Iterator>::value_type;
+
+    if (n > 0) {
+        __simd_invoke<__simd_fill_kernel>(isa, __simd_pointer(first), n, static_cast<value_type>(value));
+    }
+}
+
+// d_first[i] = op(firsts[i]...) for i in [0, n)
+template <typename OutputIterator, typename Operation, typename... InputIterators>
+void __simd_transform(__simd_isa isa, bool streaming, OutputIterator d_first, std::size_t n, Operation& op,
+                      InputIterators... firsts) {
+    if (n == 0) {
+        return;
+    }
+
+    auto out = __simd_pointer(d_first);
+
+    // in place transforms are element wise, shifted overlapping ranges are transformed in order
+    bool overlap = false;
+    const int checks[] = {0, (overlap = overlap || __simd_partial_overlap(__simd_pointer(firsts), out, n), 0)...};
+    (void)checks;
+
+    if (overlap) {
+        __transform_slice(d_first, n, op, firsts...);
+        return;
+    }
+    __simd_invoke<__simd_transform_kernel>(isa, out, n, streaming, &op, __simd_pointer(firsts)...);
+}
+
+// outputs larger than the last level cache are written with non temporal stores
+inline std::size_t __simd_streaming_bytes() {
+    static const std::size_t cache_size = get_last_level_cache_size();
+    return (cache_size > 0) ? (cache_size) : (std::numeric_limits<std::size_t>::max());
+}
+
+// fold of the n > 0 transformed elements from first, see __simd_fold_kernel
+template <typename T, typename InputIterator, typename UnaryOperation, typename BinaryOperation>
+T __simd_fold(InputIterator first, std::size_t n, UnaryOperation& transform_op, BinaryOperation& reduce_op,
+              __simd_isa isa = __simd_cpu_isa()) {
+    return __simd_invoke<__simd_fold_kernel<T>>(isa, __simd_pointer(first), n, &transform_op, &reduce_op);
+}
+
+// identity transform of the folds
+struct __simd_identity {
+    template <typename T>
+    const T& operator()(const T& v) const {
+        return v;
+    }
+};
+
+
+} // namespace detail
+
+} // namespace parallel
+
+} // namespace hadoken
+
+#endif // PARALLEL_SIMD_GENERIC_HPP
@@ -31,10 +31,20 @@
 
 #include <algorithm>
 #include <atomic>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <new>
+#include <random>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
 #include <hadoken/parallel/algorithm.hpp>
 
 
 #include "parallel_generic_utils.hpp"
+#include "parallel_merge_generic.hpp"
 
 
 namespace hadoken {
@@ -43,24 +53,277 @@ namespace hadoken {
 namespace parallel {
 
 
-namespace detail {} // namespace detail
+namespace detail {
+
+// minimum number of elements sorted by a task
+constexpr std::size_t __sort_min_chunk = 8192;
+
+// buckets per task and samples per splitter of the sample sort
+constexpr std::size_t __sort_buckets_per_task = 4;
+constexpr std::size_t __sort_oversampling = 16;
+
+// bucket ids are stored on 16 bits: at most 2 * max_splitters + 1 buckets
+constexpr std::size_t __sort_max_splitters = 4096;
+
+
+// fallback without buffer: sort num_tasks chunks, then merge them by pairs in parallel
+template <class ExecutionPolicy, class RandomIt, class Compare>
+void _internal_chunk_merge_sort(const ExecutionPolicy& policy, RandomIt first, std::size_t n, std::size_t num_tasks,
+                                Compare& comp) {
+
+    __execute_grid(policy, static_cast<int>(num_tasks), [&](int id, int num_executor) {
+        std::sort(first + __block_begin(n, num_executor, id), first + __block_begin(n, num_executor, id + 1), comp);
+    });
+
+    for (std::size_t width = 1; width < num_tasks; width *= 2) {
+        const std::size_t num_merges = (num_tasks + 2 * width - 1) / (2 * width);
+
+        __execute_grid(policy, static_cast<int>(num_merges), [&](int id, int) {
+            const std::size_t chunk = static_cast<std::size_t>(id) * 2 * width;
+            const std::size_t middle = std::min(num_tasks, chunk + width);
+            const std::size_t end = std::min(num_tasks, chunk + 2 * width);
+            if (middle < end) {
+                std::inplace_merge(first + __block_begin(n, num_tasks, chunk), first + __block_begin(n, num_tasks, middle),
+                                   first + __block_begin(n, num_tasks, end), comp);
+            }
+        });
+    }
+}
+
+
+// sample sort
+//
+// - splitters are selected from a sorted random sample
+// - every task classifies a block of the input: elements equal to a splitter go to
+//   a dedicated bucket, that is never sorted, which keeps duplicated keys balanced
+// - blocks are scattered to their buckets in the buffer
+// - buckets are sorted and moved back, largest first
+template <class ExecutionPolicy, class RandomIt, class Compare>
+void _internal_sample_sort(const ExecutionPolicy& policy, RandomIt first, std::size_t n, std::size_t num_tasks,
+                           Compare& comp, std::vector<typename std::iterator_traits<RandomIt>::value_type>& buffer) {
+    using value_type = typename std::iterator_traits<RandomIt>::value_type;
+
+    const std::size_t n_splitters = std::min(num_tasks * __sort_buckets_per_task, __sort_max_splitters + 1) - 1;
+    const std::size_t n_buckets = 2 * n_splitters + 1;
+
+    // splitters, as iterators on the input that stays in place until the scatter
+    std::vector<RandomIt> splitters;
+    {
+        std::vector<RandomIt> samples((n_splitters + 1) * __sort_oversampling);
+        std::minstd_rand gen(static_cast<std::minstd_rand::result_type>(n));
+        std::uniform_int_distribution<std::size_t> position(0, n - 1);
+
+        for (auto& sample : samples) {
+            sample = first + position(gen);
+        }
+        std::sort(samples.begin(), samples.end(), [&comp](RandomIt a, RandomIt b) { return comp(*a, *b); });
+
+        splitters.reserve(n_splitters);
+        for (std::size_t i = 1; i <= n_splitters; ++i) {
+            splitters.push_back(samples[i * __sort_oversampling]);
+        }
+    }
+
+    // classification
+    std::vector<std::uint16_t> bucket_ids(n);
+    std::vector<std::size_t> offsets(num_tasks * n_buckets, 0);
+
+    __execute_grid(policy, static_cast<int>(num_tasks), [&](int id, int num_executor) {
+        std::size_t* counts = offsets.data() + static_cast<std::size_t>(id) * n_buckets;
+
+        auto splitter_less = [&comp](RandomIt splitter, const value_type& v) { return comp(*splitter, v); };
+
+        for (std::size_t i = __block_begin(n, num_executor, id); i < __block_begin(n, num_executor, id + 1); ++i) {
+            const value_type& v = *(first + i);
+            const std::size_t pos = static_cast<std::size_t>(
+                std::lower_bound(splitters.begin(), splitters.end(), v, splitter_less) - splitters.begin());
+            const bool equal = (pos < n_splitters) && (comp(v, *splitters[pos]) == false);
+            const std::size_t bucket = 2 * pos + ((equal) ? (1) : (0));
+
+            bucket_ids[i] = static_cast<std::uint16_t>(bucket);
+            counts[bucket] += 1;
+        }
+    });
+
+    // exclusive prefix sum, bucket major
+    std::vector<std::size_t> bucket_begin(n_buckets + 1, 0);
+    {
+        std::size_t total = 0;
+        for (std::size_t bucket = 0; bucket < n_buckets; ++bucket) {
+            bucket_begin[bucket] = total;
+            for (std::size_t task = 0; task < num_tasks; ++task) {
+                std::size_t& offset = offsets[task * n_buckets + bucket];
+                const std::size_t count = offset;
+                offset = total;
+                total += count;
+            }
+        }
+        bucket_begin[n_buckets] = total;
+    }
+
+    // scatter
+    __execute_grid(policy, static_cast<int>(num_tasks), [&](int id, int num_executor) {
+        std::size_t* positions = offsets.data() + static_cast<std::size_t>(id) * n_buckets;
+
+        for (std::size_t i = __block_begin(n, num_executor, id); i < __block_begin(n, num_executor, id + 1); ++i) {
+            buffer[positions[bucket_ids[i]]++] = std::move(*(first + i));
+        }
+    });
+
+    // sort and move back, largest buckets first
+    std::vector<std::size_t> order(n_buckets);
+    for (std::size_t bucket = 0; bucket < n_buckets; ++bucket) {
+        order[bucket] = bucket;
+    }
+    std::sort(order.begin(), order.end(), [&bucket_begin](std::size_t a, std::size_t b) {
+        return (bucket_begin[a + 1] - bucket_begin[a]) > (bucket_begin[b + 1] - bucket_begin[b]);
+    });
+
+    std::atomic<std::size_t> next_bucket(0);
+
+    __execute_grid(policy, static_cast<int>(num_tasks), [&](int, int) {
+        std::size_t claimed;
+        while ((claimed = next_bucket.fetch_add(1, std::memory_order_relaxed)) < n_buckets) {
+            const std::size_t bucket = order[claimed];
+            auto bucket_first = buffer.begin() + bucket_begin[bucket];
+            auto bucket_last = buffer.begin() + bucket_begin[bucket + 1];
+
+            if (bucket_first == bucket_last) {
+                break;
+            }
+
+            if (bucket % 2 == 0) {
+                std::sort(bucket_first, bucket_last, comp);
+            }
+            std::move(bucket_first, bucket_last, first + bucket_begin[bucket]);
+        }
+    });
+}
+
+
+template <class ExecutionPolicy, class RandomIt, class Compare>
+void _internal_parallel_sort(const ExecutionPolicy& policy, RandomIt first, std::size_t n, std::size_t num_tasks,
+                             Compare& comp, std::true_type /* buffered */) {
+    using value_type = typename std::iterator_traits<RandomIt>::value_type;
+
+    std::vector<value_type> buffer;
+    try {
+        buffer.resize(n);
+    } catch (std::bad_alloc&) {
+        _internal_chunk_merge_sort(policy, first, n, num_tasks, comp);
+        return;
+    }
+
+    _internal_sample_sort(policy, first, n, num_tasks, comp, buffer);
+}
+
+// values that can not be default constructed: merge sort through a buffer built by moving the range
+template <class ExecutionPolicy, class RandomIt, class Compare>
+void _internal_parallel_sort(const ExecutionPolicy& policy, RandomIt first, std::size_t n, std::size_t num_tasks,
+                             Compare& comp, std::false_type /* buffered */) {
+    using value_type = typename std::iterator_traits<RandomIt>::value_type;
+
+    std::vector<value_type> buffer;
+    try {
+        buffer.reserve(n);
+    } catch (std::bad_alloc&) {
+        _internal_chunk_merge_sort(policy, first, n, num_tasks, comp);
+        return;
+    }
+
+    _internal_merge_sort<false>(policy, first, n, num_tasks, comp, buffer);
+}
+
+template <class ExecutionPolicy, class RandomIt, class Compare>
+void _internal_sort(const ExecutionPolicy& policy, RandomIt first, RandomIt last, Compare comp) {
+    using value_type = typename std::iterator_traits<RandomIt>::value_type;
+
+    const std::size_t n = static_cast<std::size_t>(std::distance(first, last));
+    const std::size_t num_tasks = std::min(__grid_size(policy, n), n / __sort_min_chunk);
+
+    if (num_tasks <= 1) {
+        std::sort(first, last, comp);
+        return;
+    }
+
+    // the sample sort moves the elements through a buffer of default constructed values
+    using buffered = std::integral_constant<bool, std::is_default_constructible<value_type>::value &&
+                                                      std::is_move_assignable<value_type>::value>;
+
+    _internal_parallel_sort(policy, first, n, num_tasks, comp, buffered());
+}
+
+// merge sort of stable sorted runs
+template <class ExecutionPolicy, class RandomIt, class Compare>
+void _internal_stable_sort(const ExecutionPolicy& policy, RandomIt first, RandomIt last, Compare comp) {
+    using value_type = typename std::iterator_traits<RandomIt>::value_type;
+
+    const std::size_t n = static_cast<std::size_t>(std::distance(first, last));
+    const std::size_t num_tasks = std::min(__grid_size(policy, n), n / __sort_min_chunk);
+
+    if (num_tasks <= 1) {
+        std::stable_sort(first, last, comp);
+        return;
+    }
+
+    std::vector<value_type> buffer;
+    try {
+        buffer.reserve(n);
+    } catch (std::bad_alloc&) {
+        // std::stable_sort falls back to an in place merge sort
+        std::stable_sort(first, last, comp);
+        return;
+    }
+
+    _internal_merge_sort<true>(policy, first, n, num_tasks, comp, buffer);
+}
+
+} // namespace detail
 
 // sort algorithm
 template <class ExecutionPolicy, class RandomIt>
 void sort(ExecutionPolicy&& policy, RandomIt first, RandomIt last) {
-    // temporary dummy implementation
-    (void)policy;
-    std::sort(first, last);
+    using value_type = typename std::iterator_traits<RandomIt>::value_type;
+
+    hadoken::parallel::sort(std::forward<ExecutionPolicy>(policy), first, last, std::less<value_type>());
 }
 
 // sort algorithm with comparator
 template <class ExecutionPolicy, class RandomIt, class Compare>
 void sort(ExecutionPolicy&& policy, RandomIt first, RandomIt last, Compare comp) {
-    // temporary dummy implementation
-    (void)policy;
+    static_assert(
+        std::is_base_of<std::random_access_iterator_tag, typename std::iterator_traits<RandomIt>::iterator_category>::value,
+        "parallel::sort requires random_access_iterator");
+
+    if (detail::is_parallel_policy(policy)) {
+        detail::_internal_sort(policy, first, last, comp);
+        return;
+    }
     std::sort(first, last, comp);
 }
 
+// stable_sort algorithm
+template <class ExecutionPolicy, class RandomIt>
+void stable_sort(ExecutionPolicy&& policy, RandomIt first, RandomIt last) {
+    using value_type = typename std::iterator_traits<RandomIt>::value_type;
+
+    hadoken::parallel::stable_sort(std::forward<ExecutionPolicy>(policy), first, last, std::less<value_type>());
+}
+
+// stable_sort algorithm with comparator
+template <class ExecutionPolicy, class RandomIt, class Compare>
+void stable_sort(ExecutionPolicy&& policy, RandomIt first, RandomIt last, Compare comp) {
+    static_assert(
+        std::is_base_of<std::random_access_iterator_tag, typename std::iterator_traits<RandomIt>::iterator_category>::value,
+        "parallel::stable_sort requires random_access_iterator");
+
+    if (detail::is_parallel_policy(policy)) {
+        detail::_internal_stable_sort(policy, first, last, comp);
+        return;
+    }
+    std::stable_sort(first, last, comp);
+}
+
 
 } // namespace parallel
 
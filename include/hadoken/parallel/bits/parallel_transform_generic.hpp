@@ -30,15 +30,15 @@
 #define PARALLEL_TRANSFORM_GENERIC_BITS_HPP
 
 #include <algorithm>
-#include <tuple>
-
-#include <boost/iterator/zip_iterator.hpp>
-#include <boost/tuple/tuple.hpp>
+#include <cstddef>
+#include <iterator>
+#include <type_traits>
 
 #include <hadoken/parallel/algorithm.hpp>
 
 
 #include "parallel_generic_utils.hpp"
+#include "parallel_simd_generic.hpp"
 
 
 namespace hadoken {
@@ -46,39 +46,112 @@ namespace hadoken {
 
 namespace parallel {
 
-template <class ExecutionPolicy, class InputIterator1, class InputIterator2, class OutputIterator, class BinaryOperation>
-OutputIterator transform(ExecutionPolicy&& policy, InputIterator1 first1, InputIterator1 last1, InputIterator2 first2,
-                         OutputIterator d_first, BinaryOperation binary_op) {
-    if (detail::is_parallel_policy(policy)) {
-        InputIterator1 d_last = d_first;
+namespace detail {
+
+template <class... Iterators>
+struct __all_simd_iterators : std::true_type {};
+
+template <class Iterator, class... Iterators>
+struct __all_simd_iterators<Iterator, Iterators...>
+    : std::integral_constant<bool, __is_simd_iterator<Iterator>::value && __all_simd_iterators<Iterators...>::value> {};
+
+template <class... Iterators>
+struct __all_forward_iterators : std::true_type {};
 
-        hadoken::parallel::for_range(policy, first1, last1, [&](InputIterator1 local_begin, InputIterator2 local_end) {
-            const std::size_t pos = std::distance(first1, local_begin);
+template <class Iterator, class... Iterators>
+struct __all_forward_iterators<Iterator, Iterators...>
+    : std::integral_constant<bool, std::is_base_of<std::forward_iterator_tag,
+                                                   typename std::iterator_traits<Iterator>::iterator_category>::value &&
+                                       __all_forward_iterators<Iterators...>::value> {};
 
-            InputIterator2 local_first2 = first2;
-            std::advance(local_first2, pos);
-            OutputIterator d_local_first = d_first;
-            std::advance(d_local_first, pos);
+// implementation of a transform: vectorized slices, slices or sequential
+enum class __transform_kind { vectorized, slices, sequential };
+
+template <class ExecutionPolicy, class OutputIterator, class... InputIterators>
+struct __transform_kind_of
+    : std::integral_constant<__transform_kind, (__is_vector_policy<ExecutionPolicy>::value &&
+                                                __all_simd_iterators<OutputIterator, InputIterators...>::value)
+                                                   ? (__transform_kind::vectorized)
+                                                   : ((__all_forward_iterators<OutputIterator, InputIterators...>::value)
+                                                          ? (__transform_kind::slices)
+                                                          : (__transform_kind::sequential))> {};
+
+template <__transform_kind Kind>
+using __transform_tag = std::integral_constant<__transform_kind, Kind>;
+
+
+// vectorized transform of every slice, outputs larger than the last level cache are streamed to memory
+template <class ExecutionPolicy, class InputIterator1, class OutputIterator, class Operation, class... InputIterators>
+OutputIterator _internal_transform(ExecutionPolicy&& policy, InputIterator1 first1, InputIterator1 last1, OutputIterator d_first,
+                                   Operation& op, __transform_tag<__transform_kind::vectorized>, InputIterators... firsts) {
+    using output_type = typename std::iterator_traits<OutputIterator>::value_type;
+
+    const std::size_t n_elems = static_cast<std::size_t>(last1 - first1);
+    const bool streaming = (n_elems * sizeof(output_type) > __simd_streaming_bytes());
+    const __simd_isa isa = __simd_cpu_isa();
+
+    for_range(policy, first1, last1, [&](InputIterator1 local_begin, InputIterator1 local_end) {
+        const std::size_t pos = static_cast<std::size_t>(local_begin - first1);
+        __simd_transform(isa, streaming, d_first + pos, static_cast<std::size_t>(local_end - local_begin), op, local_begin,
+                         (firsts + pos)...);
+    });
+    return d_first + n_elems;
+}
 
-            std::transform(local_begin, local_end, local_first2, d_local_first, binary_op);
+template <class ExecutionPolicy, class InputIterator1, class OutputIterator, class Operation, class... InputIterators>
+OutputIterator _internal_transform(ExecutionPolicy&& policy, InputIterator1 first1, InputIterator1 last1, OutputIterator d_first,
+                                   Operation& op, __transform_tag<__transform_kind::slices>, InputIterators... firsts) {
+    const std::size_t n_elems = static_cast<std::size_t>(std::distance(first1, last1));
+
+    if (detail::is_parallel_policy(policy)) {
+        for_range(policy, first1, last1, [&](InputIterator1 local_begin, InputIterator1 local_end) {
+            const std::size_t pos = static_cast<std::size_t>(std::distance(first1, local_begin));
+            __transform_slice(get_end_iterator(d_first, pos), static_cast<std::size_t>(std::distance(local_begin, local_end)),
+                              op, local_begin, get_end_iterator(firsts, pos)...);
         });
+        return get_end_iterator(d_first, n_elems);
+    }
+
+    return __transform_slice(d_first, n_elems, op, first1, firsts...);
+}
 
-        std::advance(d_last, std::distance(first1, last1));
-        return d_last;
-    } else {
-        return std::transform(first1, last1, first2, d_first, binary_op);
+// single pass iterators
+template <class ExecutionPolicy, class InputIterator1, class OutputIterator, class Operation, class... InputIterators>
+OutputIterator _internal_transform(ExecutionPolicy&&, InputIterator1 first1, InputIterator1 last1, OutputIterator d_first,
+                                   Operation& op, __transform_tag<__transform_kind::sequential>, InputIterators... firsts) {
+    for (; first1 != last1; ++first1, ++d_first) {
+        *d_first = op(*first1, *firsts...);
+        const int increments[] = {0, ((void)++firsts, 0)...};
+        (void)increments;
     }
+    return d_first;
 }
 
+} // namespace detail
+
+
+template <class ExecutionPolicy, class InputIterator1, class InputIterator2, class OutputIterator, class BinaryOperation>
+OutputIterator transform(ExecutionPolicy&& policy, InputIterator1 first1, InputIterator1 last1, InputIterator2 first2,
+                         OutputIterator d_first, BinaryOperation binary_op) {
+    return detail::_internal_transform(
+        policy, first1, last1, d_first, binary_op,
+        detail::__transform_kind_of<ExecutionPolicy, OutputIterator, InputIterator1, InputIterator2>(), first2);
+}
 
 
 template <class ExecutionPolicy, class InputIt, class OutputIt, class UnaryOperation>
 OutputIt transform(ExecutionPolicy&& policy, InputIt first1, InputIt last1, OutputIt d_first, UnaryOperation unary_op) {
-    using value_type = typename std::iterator_traits<InputIt>::value_type;
-    return transform(policy, first1, last1, first1, d_first, [&unary_op](const value_type& v1, const value_type& v2) {
-        (void)v2;
-        return unary_op(v1);
-    });
+    return detail::_internal_transform(policy, first1, last1, d_first, unary_op,
+                                       detail::__transform_kind_of<ExecutionPolicy, OutputIt, InputIt>());
+}
+
+
+template <class ExecutionPolicy, class InputIterator1, class OutputIterator, class NaryOperation, class... InputIterators>
+OutputIterator zip_transform(ExecutionPolicy&& policy, InputIterator1 first1, InputIterator1 last1, OutputIterator d_first,
+                             NaryOperation op, InputIterators... firsts) {
+    return detail::_internal_transform(policy, first1, last1, d_first, op,
+                                       detail::__transform_kind_of<ExecutionPolicy, OutputIterator, InputIterator1, InputIterators...>(),
+                                       firsts...);
 }
 
 } // namespace parallel
@@ -0,0 +1,778 @@
+/**
+ * Copyright (c) 2018, Adrien Devresse <adrien.devresse@epfl.ch>
+ *
+ * Boost Software License - Version 1.0
+ *
+ * Permission is hereby granted, free of charge, to any person or organization
+ * obtaining a copy of the software and accompanying documentation covered by
+ * this license (the "Software") to use, reproduce, display, distribute,
+ * execute, and transmit the Software, and to prepare derivative works of the
+ * Software, and to permit third-parties to whom the Software is furnished to
+ * do so, all subject to the following:
+ *
+ * The copyright notices in the Software and this entire statement, including
+ * the above license grant, this restriction and the following disclaimer,
+ * must be included in all copies of the Software, in whole or in part, and
+ * all derivative works of the Software, unless such copies or derivative
+ * works are solely in the form of machine-executable object code generated by
+ * a source language processor.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+ * SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+ * FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ *
+ */
+#ifndef _HADOKEN_THREAD_FUTURE_BITS_HPP_
+#define _HADOKEN_THREAD_FUTURE_BITS_HPP_
+
+#include <thread>
+
+#include "../future.hpp"
+
+namespace hadoken {
+
+namespace thread {
+
+namespace details {
+
+
+inline block_cache::block_cache() noexcept {
+    for (std::size_t i = 0; i < n_size_class; ++i) {
+        _heads[i] = nullptr;
+        _counts[i] = 0;
+    }
+}
+
+inline block_cache::~block_cache() {
+    for (std::size_t i = 0; i < n_size_class; ++i) {
+        while (_heads[i] != nullptr) {
+            free_block* block = _heads[i];
+            _heads[i] = block->next;
+            ::operator delete(static_cast<void*>(block));
+        }
+    }
+    _destroyed() = true;
+}
+
+inline void* block_cache::allocate(std::size_t size) {
+    const std::size_t size_class = _size_class(size);
+
+    if (size_class >= n_size_class) {
+        return ::operator new(size);
+    }
+
+    free_block* block = _heads[size_class];
+    if (block == nullptr) {
+        return ::operator new(min_block_size << size_class);
+    }
+
+    _heads[size_class] = block->next;
+    _counts[size_class] -= 1;
+    return static_cast<void*>(block);
+}
+
+inline void block_cache::deallocate(void* ptr, std::size_t size) noexcept {
+    const std::size_t size_class = _size_class(size);
+
+    if (size_class >= n_size_class || _counts[size_class] >= max_cached_blocks) {
+        ::operator delete(ptr);
+        return;
+    }
+
+    free_block* block = ::new (ptr) free_block;
+    block->next = _heads[size_class];
+    _heads[size_class] = block;
+    _counts[size_class] += 1;
+}
+
+inline void* block_cache::local_allocate(std::size_t size) {
+    block_cache* cache = _local();
+    if (cache != nullptr) {
+        return cache->allocate(size);
+    }
+
+    // rounded to the size class: the block can be recycled later by another cache
+    const std::size_t size_class = _size_class(size);
+    return ::operator new((size_class < n_size_class) ? (min_block_size << size_class) : (size));
+}
+
+inline void block_cache::local_deallocate(void* ptr, std::size_t size) noexcept {
+    block_cache* cache = _local();
+    if (cache != nullptr) {
+        cache->deallocate(ptr, size);
+    } else {
+        ::operator delete(ptr);
+    }
+}
+
+inline std::size_t block_cache::_size_class(std::size_t size) noexcept {
+    std::size_t size_class = 0;
+    while (size_class < n_size_class && (min_block_size << size_class) < size) {
+        size_class += 1;
+    }
+    return size_class;
+}
+
+inline bool& block_cache::_destroyed() noexcept {
+    // trivially destructible, still valid during the destruction of the thread_local objects
+    static thread_local bool destroyed = false;
+    return destroyed;
+}
+
+inline block_cache* block_cache::_local() noexcept {
+    if (_destroyed()) {
+        return nullptr;
+    }
+    static thread_local block_cache cache;
+    return &cache;
+}
+
+
+inline event_count& future_parking_slot(const void* state) {
+    static constexpr std::size_t n_slots = 64;
+
+    // never destroyed: futures can be completed by threads living until the end of the program
+    static event_count* slots = new event_count[n_slots];
+
+    return slots[(reinterpret_cast<std::uintptr_t>(state) / block_cache::min_block_size) % n_slots];
+}
+
+
+inline future_state_base::~future_state_base() {
+    // a state is normally published before its destruction, drop the callbacks never executed
+    continuation_node* node = _continuations.load(std::memory_order_relaxed);
+    while (node != nullptr && node != _published_marker()) {
+        continuation_node* next = node->next;
+        delete node;
+        node = next;
+    }
+}
+
+inline void future_state_base::release() noexcept {
+    if (_state.fetch_sub(ref_unit) < 2 * ref_unit) {
+        delete this;
+    }
+}
+
+inline void future_state_base::publish() noexcept {
+    continuation_node* continuations = _take_continuations();
+
+    _state.fetch_or(ready_bit);
+    future_parking_slot(this).notify_all();
+
+    _run_continuations(continuations);
+}
+
+inline void future_state_base::publish_and_release() noexcept {
+    // the state can be destroyed by a consumer as soon as it is published:
+    // only the parking slot and the continuations, taken beforehand, can be used afterward
+    event_count& slot = future_parking_slot(this);
+    continuation_node* continuations = _take_continuations();
+
+    // ready bit is not set yet: remove one reference and set the ready bit in one operation
+    if (_state.fetch_sub(ref_unit - ready_bit) < 2 * ref_unit) {
+        delete this;
+    } else {
+        slot.notify_all();
+    }
+
+    _run_continuations(continuations);
+}
+
+inline void future_state_base::break_promise() noexcept {
+    set_exception(std::make_exception_ptr(std::future_error(std::future_errc::broken_promise)));
+    publish_and_release();
+}
+
+inline void future_state_base::attach(continuation_node* node) noexcept {
+    continuation_node* head = _continuations.load(std::memory_order_acquire);
+    do {
+        if (head == _published_marker()) {
+            // the publisher owns the result now, it is visible at the latest after a short wait()
+            node->run_and_destroy();
+            return;
+        }
+        node->next = head;
+    } while (_continuations.compare_exchange_weak(head, node, std::memory_order_acq_rel, std::memory_order_acquire) ==
+             false);
+}
+
+inline continuation_node* future_state_base::_published_marker() noexcept {
+    // only its address is used
+    static typename std::aligned_storage<sizeof(continuation_node), alignof(continuation_node)>::type marker;
+    return reinterpret_cast<continuation_node*>(&marker);
+}
+
+inline continuation_node* future_state_base::_take_continuations() noexcept {
+    return _continuations.exchange(_published_marker(), std::memory_order_acq_rel);
+}
+
+inline void future_state_base::_run_continuations(continuation_node* head) noexcept {
+    // attached as a stack: reverse it to execute the continuations in attachment order
+    continuation_node* ordered = nullptr;
+    while (head != nullptr) {
+        continuation_node* next = head->next;
+        head->next = ordered;
+        ordered = head;
+        head = next;
+    }
+
+    while (ordered != nullptr) {
+        continuation_node* next = ordered->next;
+        ordered->run_and_destroy();
+        ordered = next;
+    }
+}
+
+inline void future_state_base::wait() const {
+    wait_helper* helper = wait_helper::current();
+    if (helper != nullptr) {
+        _help_until_ready(*helper);
+        return;
+    }
+
+    // short spin, most results of fine grained tasks arrive quickly
+    for (std::size_t i = 0; i < 16; ++i) {
+        if (is_ready()) {
+            return;
+        }
+        std::this_thread::yield();
+    }
+
+    event_count& slot = future_parking_slot(this);
+    while (is_ready() == false) {
+        const event_count::key_type key = slot.prepare_wait();
+        if (is_ready()) {
+            slot.cancel_wait();
+            break;
+        }
+        slot.commit_wait(key);
+    }
+}
+
+inline void future_state_base::_help_until_ready(wait_helper& helper) const {
+    // new work does not notify the parking slot: park shortly, then look for work again
+    static constexpr std::chrono::microseconds poll_interval(100);
+
+    event_count& slot = future_parking_slot(this);
+    while (is_ready() == false) {
+        if (helper.help()) {
+            continue;
+        }
+
+        const event_count::key_type key = slot.prepare_wait();
+        if (is_ready()) {
+            slot.cancel_wait();
+            break;
+        }
+        slot.commit_wait_for(key, poll_interval);
+    }
+}
+
+template <typename Clock, typename Duration>
+inline bool future_state_base::wait_until(const std::chrono::time_point<Clock, Duration>& deadline) const {
+    event_count& slot = future_parking_slot(this);
+
+    while (is_ready() == false) {
+        const auto now = Clock::now();
+        if (now >= deadline) {
+            return false;
+        }
+
+        const event_count::key_type key = slot.prepare_wait();
+        if (is_ready()) {
+            slot.cancel_wait();
+            break;
+        }
+        slot.commit_wait_for(key, deadline - now);
+    }
+    return true;
+}
+
+
+template <typename R, typename Function>
+template <typename Fun>
+inline task_state<R, Function>::task_state(Fun&& func) : task_state_base<R>(1), _has_func(true) {
+    ::new (static_cast<void*>(&_func)) Function(std::forward<Fun>(func));
+}
+
+template <typename R, typename Function>
+inline task_state<R, Function>::~task_state() {
+    if (_has_func) {
+        reinterpret_cast<Function*>(&_func)->~Function();
+    }
+}
+
+template <typename R, typename Function>
+inline void task_state<R, Function>::run(bool release) noexcept {
+    Function& func = *reinterpret_cast<Function*>(&_func);
+
+    try {
+        set_state_from_result(*this, func);
+    } catch (...) {
+        this->set_exception(std::current_exception());
+    }
+
+    // captured resources are released with the execution, not with the future
+    func.~Function();
+    _has_func = false;
+
+    if (release) {
+        this->publish_and_release();
+    } else {
+        this->publish();
+    }
+}
+
+
+// call a continuation with its input future
+template <typename T, typename Function>
+class bound_continuation {
+  public:
+    template <typename Fun>
+    inline bound_continuation(future<T>&& input, Fun&& func) : _input(std::move(input)), _func(std::forward<Fun>(func)) {}
+
+    inline continuation_result_t<T, Function> operator()() { return _func(std::move(_input)); }
+
+  private:
+    future<T> _input;
+    Function _func;
+};
+
+
+// execute a continuation on the thread publishing the result
+template <typename R>
+class inline_dispatch {
+  public:
+    explicit inline inline_dispatch(packaged_task<R>&& task) noexcept : _task(std::move(task)) {}
+
+    inline void operator()() { _task(); }
+
+  private:
+    packaged_task<R> _task;
+};
+
+
+// submit a continuation to an executor
+template <typename Executor, typename R>
+class executor_dispatch {
+  public:
+    inline executor_dispatch(Executor& executor, packaged_task<R>&& task) noexcept
+        : _executor(&executor), _task(std::move(task)) {}
+
+    inline void operator()() noexcept {
+        try {
+            _executor->execute(std::move(_task));
+        } catch (...) {
+            // the task is destroyed without execution: its future receives a broken_promise error
+        }
+    }
+
+  private:
+    Executor* _executor;
+    packaged_task<R> _task;
+};
+
+
+template <typename Future>
+class when_all_state {
+  public:
+    explicit inline when_all_state(std::vector<Future>&& futures)
+        : _futures(std::move(futures)), _remaining(_futures.size()) {}
+
+    inline std::vector<Future>& futures() noexcept { return _futures; }
+
+    inline future<std::vector<Future>> get_future() { return _promise.get_future(); }
+
+    // called once per ready future, the last one publishes the result
+    inline void notify() noexcept {
+        if (_remaining.fetch_sub(1) == 1) {
+            _promise.set_value(std::move(_futures));
+            delete this;
+        }
+    }
+
+  private:
+    std::vector<Future> _futures;
+    std::atomic<std::size_t> _remaining;
+    promise<std::vector<Future>> _promise;
+};
+
+
+template <typename Future>
+class when_any_state {
+  public:
+    using result_type = when_any_result<std::vector<Future>>;
+
+    explicit inline when_any_state(std::vector<Future>&& futures)
+        : _futures(std::move(futures)), _remaining(_futures.size()), _ready(false) {}
+
+    inline std::vector<Future>& futures() noexcept { return _futures; }
+
+    inline future<result_type> get_future() { return _promise.get_future(); }
+
+    // called once per ready future, the first one publishes the result
+    inline void notify(std::size_t index) noexcept {
+        if (_ready.exchange(true) == false) {
+            result_type result;
+            result.index = index;
+            result.futures = std::move(_futures);
+            _promise.set_value(std::move(result));
+        }
+
+        if (_remaining.fetch_sub(1) == 1) {
+            delete this;
+        }
+    }
+
+  private:
+    std::vector<Future> _futures;
+    std::atomic<std::size_t> _remaining;
+    std::atomic<bool> _ready;
+    promise<result_type> _promise;
+};
+
+
+template <typename Future>
+inline void check_valid_futures(const std::vector<Future>& futures) {
+    for (const Future& f : futures) {
+        if (f.valid() == false) {
+            throw std::future_error(std::future_errc::no_state);
+        }
+    }
+}
+
+
+template <typename Future>
+inline future<std::vector<Future>> when_all_impl(std::vector<Future>&& futures) {
+    check_valid_futures(futures);
+
+    const std::size_t n_futures = futures.size();
+    if (n_futures == 0) {
+        promise<std::vector<Future>> ready;
+        ready.set_value(std::vector<Future>());
+        return ready.get_future();
+    }
+
+    when_all_state<Future>* state = new when_all_state<Future>(std::move(futures));
+    future<std::vector<Future>> result = state->get_future();
+
+    // the result can not be published before the last attach(): the futures stay available until then
+    for (std::size_t i = 0; i < n_futures; ++i) {
+        future_access::state(state->futures()[i])->attach(make_continuation([state]() { state->notify(); }));
+    }
+    return result;
+}
+
+
+template <typename Future>
+inline future<when_any_result<std::vector<Future>>> when_any_impl(std::vector<Future>&& futures) {
+    check_valid_futures(futures);
+
+    const std::size_t n_futures = futures.size();
+    if (n_futures == 0) {
+        when_any_result<std::vector<Future>> empty;
+        empty.index = std::size_t(-1);
+
+        promise<when_any_result<std::vector<Future>>> ready;
+        ready.set_value(std::move(empty));
+        return ready.get_future();
+    }
+
+    // the result, and the futures with it, can be published during the attach loop:
+    // keep the shared states alive until the end of the loop
+    std::vector<future_state_base*> states;
+    states.reserve(n_futures);
+    for (const Future& f : futures) {
+        states.push_back(future_access::state(f));
+        states.back()->add_ref();
+    }
+
+    when_any_state<Future>* state = new when_any_state<Future>(std::move(futures));
+    future<when_any_result<std::vector<Future>>> result = state->get_future();
+
+    for (std::size_t i = 0; i < n_futures; ++i) {
+        states[i]->attach(make_continuation([state, i]() { state->notify(i); }));
+    }
+
+    for (future_state_base* s : states) {
+        s->release();
+    }
+    return result;
+}
+
+
+template <typename T>
+inline void push_futures(std::vector<future<T>>&) {}
+
+template <typename T, typename... Futures>
+inline void push_futures(std::vector<future<T>>& futures, future<T>&& f, Futures&&... others) {
+    futures.push_back(std::move(f));
+    push_futures(futures, std::forward<Futures>(others)...);
+}
+
+
+} // namespace details
+
+
+template <typename T>
+inline future<T>& future<T>::operator=(future&& other) noexcept {
+    if (this != &other) {
+        if (_state) {
+            _state->release();
+        }
+        _state = other._state;
+        other._state = nullptr;
+    }
+    return *this;
+}
+
+template <typename T>
+inline T future<T>::get() {
+    _check_valid();
+
+    details::future_state<T>* state = _state;
+    _state = nullptr;
+
+    details::future_state_guard guard(state);
+    state->wait();
+    return state->get();
+}
+
+
+template <typename T>
+template <typename Function>
+inline future<details::continuation_result_t<T, typename std::decay<Function>::type>> future<T>::then(Function&& func) {
+    using function_type = typename std::decay<Function>::type;
+    using result_type = details::continuation_result_t<T, function_type>;
+
+    _check_valid();
+    details::future_state<T>* state = _state;
+
+    // the continuation takes over the reference of this future
+    packaged_task<result_type> task(
+        details::bound_continuation<T, function_type>(std::move(*this), std::forward<Function>(func)));
+    future<result_type> result = task.get_future();
+
+    state->attach(details::make_continuation(details::inline_dispatch<result_type>(std::move(task))));
+    return result;
+}
+
+template <typename T>
+template <typename Executor, typename Function>
+inline future<details::continuation_result_t<T, typename std::decay<Function>::type>>
+    future<T>::then(Executor& executor, Function&& func) {
+    using function_type = typename std::decay<Function>::type;
+    using result_type = details::continuation_result_t<T, function_type>;
+
+    _check_valid();
+    details::future_state<T>* state = _state;
+
+    packaged_task<result_type> task(
+        details::bound_continuation<T, function_type>(std::move(*this), std::forward<Function>(func)));
+    future<result_type> result = task.get_future();
+
+    state->attach(details::make_continuation(details::executor_dispatch<Executor, result_type>(executor, std::move(task))));
+    return result;
+}
+
+
+template <typename T>
+inline promise<T>::promise(promise&& other) noexcept
+    : _state(other._state), _future_retrieved(other._future_retrieved), _satisfied(other._satisfied) {
+    other._state = nullptr;
+}
+
+template <typename T>
+inline promise<T>& promise<T>::operator=(promise&& other) noexcept {
+    if (this != &other) {
+        _abandon();
+        _state = other._state;
+        _future_retrieved = other._future_retrieved;
+        _satisfied = other._satisfied;
+        other._state = nullptr;
+    }
+    return *this;
+}
+
+template <typename T>
+inline future<T> promise<T>::get_future() {
+    if (_future_retrieved) {
+        throw std::future_error(std::future_errc::future_already_retrieved);
+    }
+    if (_state == nullptr) {
+        throw std::future_error(std::future_errc::no_state);
+    }
+
+    _state->add_ref();
+    _future_retrieved = true;
+    return future<T>(_state);
+}
+
+template <typename T>
+template <typename... Args>
+inline void promise<T>::set_value(Args&&... args) {
+    _check_settable();
+    _state->set_value(std::forward<Args>(args)...);
+    _publish();
+}
+
+template <typename T>
+inline void promise<T>::set_exception(std::exception_ptr error) {
+    _check_settable();
+    _state->set_exception(std::move(error));
+    _publish();
+}
+
+template <typename T>
+inline void promise<T>::_check_settable() const {
+    if (_satisfied) {
+        throw std::future_error(std::future_errc::promise_already_satisfied);
+    }
+    if (_state == nullptr) {
+        throw std::future_error(std::future_errc::no_state);
+    }
+}
+
+template <typename T>
+inline void promise<T>::_publish() {
+    _satisfied = true;
+
+    // the promise does not need the state anymore once the future exists
+    if (_future_retrieved) {
+        details::future_state<T>* state = _state;
+        _state = nullptr;
+        state->publish_and_release();
+    } else {
+        _state->publish();
+    }
+}
+
+template <typename T>
+inline void promise<T>::_abandon() noexcept {
+    if (_state == nullptr) {
+        return;
+    }
+
+    if (_satisfied) {
+        _state->release();
+    } else {
+        _state->break_promise();
+    }
+    _state = nullptr;
+}
+
+
+template <typename R>
+inline packaged_task<R>::packaged_task(packaged_task&& other) noexcept
+    : _state(other._state), _future_retrieved(other._future_retrieved), _executed(other._executed) {
+    other._state = nullptr;
+}
+
+template <typename R>
+inline packaged_task<R>& packaged_task<R>::operator=(packaged_task&& other) noexcept {
+    if (this != &other) {
+        _abandon();
+        _state = other._state;
+        _future_retrieved = other._future_retrieved;
+        _executed = other._executed;
+        other._state = nullptr;
+    }
+    return *this;
+}
+
+template <typename R>
+inline future<R> packaged_task<R>::get_future() {
+    if (_future_retrieved) {
+        throw std::future_error(std::future_errc::future_already_retrieved);
+    }
+    if (_state == nullptr) {
+        throw std::future_error(std::future_errc::no_state);
+    }
+
+    _state->add_ref();
+    _future_retrieved = true;
+    return future<R>(_state);
+}
+
+template <typename R>
+inline void packaged_task<R>::operator()() {
+    if (_executed) {
+        throw std::future_error(std::future_errc::promise_already_satisfied);
+    }
+    if (_state == nullptr) {
+        throw std::future_error(std::future_errc::no_state);
+    }
+
+    _executed = true;
+    if (_future_retrieved) {
+        details::task_state_base<R>* state = _state;
+        _state = nullptr;
+        state->run(true);
+    } else {
+        _state->run(false);
+    }
+}
+
+template <typename R>
+inline void packaged_task<R>::_abandon() noexcept {
+    if (_state == nullptr) {
+        return;
+    }
+
+    if (_executed) {
+        _state->release();
+    } else {
+        _state->break_promise();
+    }
+    _state = nullptr;
+}
+
+
+template <typename InputIterator>
+inline future<std::vector<typename std::iterator_traits<InputIterator>::value_type>> when_all(InputIterator first,
+                                                                                              InputIterator last) {
+    std::vector<typename std::iterator_traits<InputIterator>::value_type> futures;
+    for (; first != last; ++first) {
+        futures.push_back(std::move(*first));
+    }
+    return details::when_all_impl(std::move(futures));
+}
+
+template <typename T, typename... Futures>
+inline future<std::vector<future<T>>> when_all(future<T>&& first, Futures&&... others) {
+    std::vector<future<T>> futures;
+    futures.reserve(1 + sizeof...(Futures));
+    details::push_futures(futures, std::move(first), std::forward<Futures>(others)...);
+    return details::when_all_impl(std::move(futures));
+}
+
+
+template <typename InputIterator>
+inline future<when_any_result<std::vector<typename std::iterator_traits<InputIterator>::value_type>>>
+    when_any(InputIterator first, InputIterator last) {
+    std::vector<typename std::iterator_traits<InputIterator>::value_type> futures;
+    for (; first != last; ++first) {
+        futures.push_back(std::move(*first));
+    }
+    return details::when_any_impl(std::move(futures));
+}
+
+template <typename T, typename... Futures>
+inline future<when_any_result<std::vector<future<T>>>> when_any(future<T>&& first, Futures&&... others) {
+    std::vector<future<T>> futures;
+    futures.reserve(1 + sizeof...(Futures));
+    details::push_futures(futures, std::move(first), std::forward<Futures>(others)...);
+    return details::when_any_impl(std::move(futures));
+}
+
+
+} // namespace thread
+
+} // namespace hadoken
+
+#endif // _HADOKEN_THREAD_FUTURE_BITS_HPP_
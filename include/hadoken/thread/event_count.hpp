@@ -0,0 +1,171 @@
+/**
+ * Copyright (c) 2018, Adrien Devresse <adrien.devresse@epfl.ch>
+ *
+ * Boost Software License - Version 1.0
+ *
+ * Permission is hereby granted, free of charge, to any person or organization
+ * obtaining a copy of the software and accompanying documentation covered by
+ * this license (the "Software") to use, reproduce, display, distribute,
+ * execute, and transmit the Software, and to prepare derivative works of the
+ * Software, and to permit third-parties to whom the Software is furnished to
+ * do so, all subject to the following:
+ *
+ * The copyright notices in the Software and this entire statement, including
+ * the above license grant, this restriction and the following disclaimer,
+ * must be included in all copies of the Software, in whole or in part, and
+ * all derivative works of the Software, unless such copies or derivative
+ * works are solely in the form of machine-executable object code generated by
+ * a source language processor.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+ * SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+ * FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ *
+ */
+#ifndef _HADOKEN_EVENT_COUNT_HPP_
+#define _HADOKEN_EVENT_COUNT_HPP_
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+
+
+namespace hadoken {
+
+namespace thread {
+
+///
+/// \brief event_count class
+///
+/// eventcount: condition variable for lock-free data structures
+///
+/// a waiter registers itself with prepare_wait(), re-checks its condition,
+/// then either cancels with cancel_wait() or blocks with commit_wait()
+///
+/// notify_one() / notify_all() cost a fence and an atomic load when nobody waits,
+/// the mutex is taken only if at least one thread is registered
+///
+/// usage:
+///
+///     while (true) {
+///         if (try_get_work()) break;
+///         auto key = ev.prepare_wait();
+///         if (try_get_work()) { ev.cancel_wait(); break; }
+///         ev.commit_wait(key);
+///     }
+///
+class event_count {
+  public:
+    using key_type = std::uint32_t;
+
+    inline event_count() : _state(0), _cond(), _lock() {}
+
+    /// default destructor
+    ~event_count() = default;
+
+    ///
+    /// \brief register the current thread as waiter
+    /// \return key to give to commit_wait
+    ///
+    inline key_type prepare_wait() { return _epoch_of(_state.fetch_add(1)); }
+
+    ///
+    /// \brief unregister the current thread, condition has been fulfilled
+    ///
+    inline void cancel_wait() { _state.fetch_sub(1); }
+
+    ///
+    /// \brief block until a notification happened since prepare_wait()
+    ///
+    inline void commit_wait(key_type key) {
+        {
+            std::unique_lock<std::mutex> l(_lock);
+            while (_epoch_of(_state.load()) == key) {
+                _cond.wait(l);
+            }
+        }
+        _state.fetch_sub(1);
+    }
+
+    ///
+    /// \brief block until a notification happened since prepare_wait() or timeout
+    /// \return false in case of timeout
+    ///
+    template <typename Duration>
+    inline bool commit_wait_for(key_type key, const Duration& d) {
+        bool notified = true;
+        {
+            const auto deadline = std::chrono::steady_clock::now() + d;
+            std::unique_lock<std::mutex> l(_lock);
+            while (notified && _epoch_of(_state.load()) == key) {
+                if (_cond.wait_until(l, deadline) == std::cv_status::timeout) {
+                    notified = (_epoch_of(_state.load()) != key);
+                }
+            }
+        }
+        _state.fetch_sub(1);
+        return notified;
+    }
+
+    ///
+    /// \brief wake up one waiting thread, if any
+    ///
+    inline void notify_one() { _notify(false); }
+
+    ///
+    /// \brief wake up all waiting threads
+    ///
+    inline void notify_all() { _notify(true); }
+
+    ///
+    /// \brief number of registered waiters
+    ///
+    inline std::size_t waiters() const { return static_cast<std::size_t>(_state.load() & waiter_mask); }
+
+  private:
+    static constexpr std::uint64_t waiter_mask = (std::uint64_t(1) << 32) - 1;
+    static constexpr std::uint64_t epoch_inc = (std::uint64_t(1) << 32);
+
+    static inline key_type _epoch_of(std::uint64_t state) { return static_cast<key_type>(state >> 32); }
+
+    inline void _notify(bool all) {
+        // pairs with the registration of the waiter: either the waiter sees the
+        // new state of the notifier, or the notifier sees the waiter
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if ((_state.load() & waiter_mask) == 0) {
+            return;
+        }
+
+        {
+            std::lock_guard<std::mutex> l(_lock);
+            _state.fetch_add(epoch_inc);
+        }
+
+        if (all) {
+            _cond.notify_all();
+        } else {
+            _cond.notify_one();
+        }
+    }
+
+    event_count(const event_count&) = delete;
+    event_count& operator=(const event_count&) = delete;
+
+    std::atomic<std::uint64_t> _state;
+    std::condition_variable _cond;
+    std::mutex _lock;
+};
+
+
+} // namespace thread
+
+
+} // namespace hadoken
+
+#endif // _HADOKEN_EVENT_COUNT_HPP_
@@ -0,0 +1,628 @@
+/**
+ * Copyright (c) 2018, Adrien Devresse <adrien.devresse@epfl.ch>
+ *
+ * Boost Software License - Version 1.0
+ *
+ * Permission is hereby granted, free of charge, to any person or organization
+ * obtaining a copy of the software and accompanying documentation covered by
+ * this license (the "Software") to use, reproduce, display, distribute,
+ * execute, and transmit the Software, and to prepare derivative works of the
+ * Software, and to permit third-parties to whom the Software is furnished to
+ * do so, all subject to the following:
+ *
+ * The copyright notices in the Software and this entire statement, including
+ * the above license grant, this restriction and the following disclaimer,
+ * must be included in all copies of the Software, in whole or in part, and
+ * all derivative works of the Software, unless such copies or derivative
+ * works are solely in the form of machine-executable object code generated by
+ * a source language processor.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+ * SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+ * FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ *
+ */
+#ifndef _HADOKEN_THREAD_FUTURE_HPP_
+#define _HADOKEN_THREAD_FUTURE_HPP_
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <future>
+#include <iterator>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <hadoken/thread/event_count.hpp>
+
+
+namespace hadoken {
+
+namespace thread {
+
+template <typename T>
+class future;
+
+template <typename T>
+class promise;
+
+template <typename R>
+class packaged_task;
+
+template <typename Sequence>
+struct when_any_result;
+
+
+///
+/// \brief work executed by a thread blocked in future::wait() until the result is ready
+///
+/// executors install one on their worker threads: a worker waiting for a nested task
+/// executes other queued tasks instead of blocking, nested parallelism can then
+/// use every worker without deadlocking the pool
+///
+class wait_helper {
+  public:
+    virtual ~wait_helper() = default;
+
+    /// execute one pending task, return false if none was found
+    virtual bool help() = 0;
+
+    /// helper of the current thread, nullptr if none
+    static inline wait_helper* current() noexcept { return _current(); }
+
+    /// install a helper for the current thread, nullptr to remove it
+    static inline void set_current(wait_helper* helper) noexcept { _current() = helper; }
+
+  private:
+    static inline wait_helper*& _current() noexcept {
+        static thread_local wait_helper* helper = nullptr;
+        return helper;
+    }
+};
+
+
+namespace details {
+
+///
+/// per thread cache of fixed size memory blocks
+///
+/// blocks are recycled by the thread releasing them, allocation and
+/// deallocation do not need any synchronization
+///
+class block_cache {
+  public:
+    /// size classes: 64, 128, 256 and 512 bytes, larger blocks go to operator new
+    static constexpr std::size_t n_size_class = 4;
+    static constexpr std::size_t min_block_size = 64;
+
+    /// maximum number of free blocks kept per size class
+    static constexpr std::size_t max_cached_blocks = 256;
+
+    inline block_cache() noexcept;
+
+    inline ~block_cache();
+
+    inline void* allocate(std::size_t size);
+
+    inline void deallocate(void* ptr, std::size_t size) noexcept;
+
+    /// allocate from the cache of the current thread
+    static inline void* local_allocate(std::size_t size);
+
+    /// give back a block to the cache of the current thread
+    static inline void local_deallocate(void* ptr, std::size_t size) noexcept;
+
+  private:
+    block_cache(const block_cache&) = delete;
+    block_cache& operator=(const block_cache&) = delete;
+
+    struct free_block {
+        free_block* next;
+    };
+
+    static inline std::size_t _size_class(std::size_t size) noexcept;
+
+    static inline bool& _destroyed() noexcept;
+
+    static inline block_cache* _local() noexcept;
+
+    free_block* _heads[n_size_class];
+    std::size_t _counts[n_size_class];
+};
+
+
+///
+/// event_count used to park threads waiting on a future, selected by address
+///
+/// a shared table avoids one mutex and condition variable per shared state
+///
+inline event_count& future_parking_slot(const void* state);
+
+
+///
+/// callback attached to a shared state, executed once by the thread publishing the result
+///
+class continuation_node {
+  public:
+    inline continuation_node() noexcept : next(nullptr) {}
+
+    virtual ~continuation_node() = default;
+
+    /// execute the callback and destroy the node
+    virtual void run_and_destroy() noexcept = 0;
+
+    static inline void* operator new(std::size_t size) { return block_cache::local_allocate(size); }
+
+    static inline void operator delete(void* ptr, std::size_t size) noexcept { block_cache::local_deallocate(ptr, size); }
+
+    continuation_node* next;
+
+  private:
+    continuation_node(const continuation_node&) = delete;
+    continuation_node& operator=(const continuation_node&) = delete;
+};
+
+
+template <typename Function>
+class continuation_impl : public continuation_node {
+  public:
+    template <typename Fun>
+    explicit inline continuation_impl(Fun&& func) : _func(std::forward<Fun>(func)) {}
+
+    inline void run_and_destroy() noexcept override {
+        _func();
+        delete this;
+    }
+
+  private:
+    Function _func;
+};
+
+
+template <typename Function>
+inline continuation_node* make_continuation(Function&& func) {
+    return new continuation_impl<typename std::decay<Function>::type>(std::forward<Function>(func));
+}
+
+
+///
+/// shared state between future and promise, intrusively reference counted
+///
+/// the ready flag and the reference count share the same atomic word:
+/// the producer publishes the result and drops its reference in a single operation,
+/// the consumer is then most of the time the one releasing the state,
+/// in its own block cache
+///
+class future_state_base {
+  public:
+    explicit inline future_state_base(std::uint32_t n_refs) noexcept
+        : _state(n_refs * ref_unit), _continuations(nullptr), _error() {}
+
+    inline virtual ~future_state_base();
+
+    inline bool is_ready() const noexcept { return (_state.load() & ready_bit) != 0; }
+
+    inline void add_ref() noexcept { _state.fetch_add(ref_unit, std::memory_order_relaxed); }
+
+    /// drop one reference, the state is destroyed with the last one
+    inline void release() noexcept;
+
+    /// mark the result as available and wake up the waiters
+    inline void publish() noexcept;
+
+    /// publish() and release() as a single atomic operation
+    inline void publish_and_release() noexcept;
+
+    /// store a broken_promise error, publish and release
+    inline void break_promise() noexcept;
+
+    inline void set_exception(std::exception_ptr error) noexcept { _error = std::move(error); }
+
+    ///
+    /// attach a continuation, executed by the publishing thread after publish()
+    /// or immediately by the caller if the state is already published
+    ///
+    /// the continuation does not hold any reference on the state
+    ///
+    inline void attach(continuation_node* node) noexcept;
+
+    /// block until the result is published, executing the work of the wait_helper of the thread if any
+    inline void wait() const;
+
+    template <typename Clock, typename Duration>
+    inline bool wait_until(const std::chrono::time_point<Clock, Duration>& deadline) const;
+
+    static inline void* operator new(std::size_t size) { return block_cache::local_allocate(size); }
+
+    static inline void operator delete(void* ptr, std::size_t size) noexcept { block_cache::local_deallocate(ptr, size); }
+
+  protected:
+    inline void _help_until_ready(wait_helper& helper) const;
+
+    inline void _rethrow_if_error() const {
+        if (_error) {
+            std::rethrow_exception(_error);
+        }
+    }
+
+  private:
+    future_state_base(const future_state_base&) = delete;
+    future_state_base& operator=(const future_state_base&) = delete;
+
+    static constexpr std::uint32_t ready_bit = 1;
+    static constexpr std::uint32_t ref_unit = 2;
+
+    // end of list marker, set on publication: no continuation can be attached anymore
+    static inline continuation_node* _published_marker() noexcept;
+
+    // detach the continuations, to be executed once the result is visible
+    inline continuation_node* _take_continuations() noexcept;
+
+    static inline void _run_continuations(continuation_node* head) noexcept;
+
+    std::atomic<std::uint32_t> _state;
+    std::atomic<continuation_node*> _continuations;
+    std::exception_ptr _error;
+};
+
+
+template <typename T>
+class future_state : public future_state_base {
+  public:
+    explicit inline future_state(std::uint32_t n_refs) noexcept : future_state_base(n_refs), _has_value(false) {}
+
+    inline ~future_state() {
+        if (_has_value) {
+            reinterpret_cast<T*>(&_value)->~T();
+        }
+    }
+
+    template <typename... Args>
+    inline void set_value(Args&&... args) {
+        ::new (static_cast<void*>(&_value)) T(std::forward<Args>(args)...);
+        _has_value = true;
+    }
+
+    inline T get() {
+        _rethrow_if_error();
+        return std::move(*reinterpret_cast<T*>(&_value));
+    }
+
+  private:
+    typename std::aligned_storage<sizeof(T), alignof(T)>::type _value;
+    bool _has_value;
+};
+
+
+template <typename T>
+class future_state<T&> : public future_state_base {
+  public:
+    explicit inline future_state(std::uint32_t n_refs) noexcept : future_state_base(n_refs), _value(nullptr) {}
+
+    inline void set_value(T& value) noexcept { _value = &value; }
+
+    inline T& get() {
+        _rethrow_if_error();
+        return *_value;
+    }
+
+  private:
+    T* _value;
+};
+
+
+template <>
+class future_state<void> : public future_state_base {
+  public:
+    explicit inline future_state(std::uint32_t n_refs) noexcept : future_state_base(n_refs) {}
+
+    inline void set_value() noexcept {}
+
+    inline void get() { _rethrow_if_error(); }
+};
+
+
+template <typename R, typename Function>
+inline void set_state_from_result(future_state<R>& state, Function& func) {
+    state.set_value(func());
+}
+
+template <typename Function>
+inline void set_state_from_result(future_state<void>& state, Function& func) {
+    func();
+    state.set_value();
+}
+
+
+///
+/// shared state of a packaged_task: hold the callable and its result
+///
+template <typename R>
+class task_state_base : public future_state<R> {
+  public:
+    explicit inline task_state_base(std::uint32_t n_refs) noexcept : future_state<R>(n_refs) {}
+
+    /// execute, publish the result, and drop the task reference if release is true
+    virtual void run(bool release) noexcept = 0;
+};
+
+
+template <typename R, typename Function>
+class task_state : public task_state_base<R> {
+  public:
+    template <typename Fun>
+    explicit inline task_state(Fun&& func);
+
+    inline ~task_state();
+
+    inline void run(bool release) noexcept override;
+
+  private:
+    typename std::aligned_storage<sizeof(Function), alignof(Function)>::type _func;
+    bool _has_func;
+};
+
+
+// release the reference on a shared state at the end of the scope
+class future_state_guard {
+  public:
+    explicit inline future_state_guard(future_state_base* state) noexcept : _state(state) {}
+
+    inline ~future_state_guard() { _state->release(); }
+
+  private:
+    future_state_guard(const future_state_guard&) = delete;
+    future_state_guard& operator=(const future_state_guard&) = delete;
+
+    future_state_base* _state;
+};
+
+
+// access to the shared state of a future, for the composition functions
+struct future_access {
+    template <typename T>
+    static inline future_state<T>* state(const future<T>& f) noexcept {
+        return f._state;
+    }
+};
+
+
+template <typename T, typename Function>
+using continuation_result_t = decltype(std::declval<Function&>()(std::declval<future<T>>()));
+
+} // namespace details
+
+
+///
+/// \brief lightweight future
+///
+/// same interface than std::future, with a cheaper shared state:
+/// - a single allocation, served by a per-thread block cache
+/// - no mutex and condition variable per state, waiters park on a shared table of event_count
+///
+/// T can be a value, a reference or void
+///
+template <typename T>
+class future {
+  public:
+    inline future() noexcept : _state(nullptr) {}
+
+    inline future(future&& other) noexcept : _state(other._state) { other._state = nullptr; }
+
+    inline future& operator=(future&& other) noexcept;
+
+    future(const future&) = delete;
+    future& operator=(const future&) = delete;
+
+    inline ~future() {
+        if (_state) {
+            _state->release();
+        }
+    }
+
+    /// true if the future refers to a shared state
+    inline bool valid() const noexcept { return _state != nullptr; }
+
+    /// true if the result is available, never blocks
+    inline bool is_ready() const {
+        _check_valid();
+        return _state->is_ready();
+    }
+
+    ///
+    /// \brief wait for the result and return it, or rethrow the stored exception
+    ///
+    /// the future is not valid anymore afterward
+    ///
+    inline T get();
+
+    inline void wait() const {
+        _check_valid();
+        _state->wait();
+    }
+
+    template <typename Rep, typename Period>
+    inline std::future_status wait_for(const std::chrono::duration<Rep, Period>& d) const {
+        return wait_until(std::chrono::steady_clock::now() + d);
+    }
+
+    template <typename Clock, typename Duration>
+    inline std::future_status wait_until(const std::chrono::time_point<Clock, Duration>& deadline) const {
+        _check_valid();
+        return (_state->wait_until(deadline)) ? (std::future_status::ready) : (std::future_status::timeout);
+    }
+
+    ///
+    /// \brief attach a continuation
+    ///
+    /// func is called with the ready future as argument, on the thread completing this future,
+    /// or immediately if the result is already available. The future is not valid anymore afterward.
+    ///
+    /// \return future of the result of func
+    ///
+    template <typename Function>
+    inline future<details::continuation_result_t<T, typename std::decay<Function>::type>> then(Function&& func);
+
+    ///
+    /// \brief attach a continuation executed on an executor
+    ///
+    /// func is called with the ready future as argument, it is submitted to executor
+    /// by the thread completing this future: no thread is blocked waiting for the result.
+    /// The executor must outlive the completion of the future.
+    ///
+    template <typename Executor, typename Function>
+    inline future<details::continuation_result_t<T, typename std::decay<Function>::type>> then(Executor& executor,
+                                                                                              Function&& func);
+
+  private:
+    friend class promise<T>;
+    friend class packaged_task<T>;
+    friend struct details::future_access;
+
+    explicit inline future(details::future_state<T>* state) noexcept : _state(state) {}
+
+    inline void _check_valid() const {
+        if (_state == nullptr) {
+            throw std::future_error(std::future_errc::no_state);
+        }
+    }
+
+    details::future_state<T>* _state;
+};
+
+
+///
+/// \brief lightweight promise, see future
+///
+/// set_value() takes no argument for promise<void>
+///
+template <typename T>
+class promise {
+  public:
+    inline promise() : _state(new details::future_state<T>(1)), _future_retrieved(false), _satisfied(false) {}
+
+    inline promise(promise&& other) noexcept;
+
+    inline promise& operator=(promise&& other) noexcept;
+
+    promise(const promise&) = delete;
+    promise& operator=(const promise&) = delete;
+
+    /// an unsatisfied promise stores a broken_promise error
+    inline ~promise() { _abandon(); }
+
+    inline future<T> get_future();
+
+    template <typename... Args>
+    inline void set_value(Args&&... args);
+
+    inline void set_exception(std::exception_ptr error);
+
+  private:
+    inline void _check_settable() const;
+
+    inline void _publish();
+
+    inline void _abandon() noexcept;
+
+    details::future_state<T>* _state;
+    bool _future_retrieved, _satisfied;
+};
+
+
+///
+/// \brief lightweight packaged_task, see future
+///
+/// a one-shot callable computing R and providing it to a future,
+/// the callable and its result share a single allocation
+///
+template <typename R>
+class packaged_task {
+  public:
+    inline packaged_task() noexcept : _state(nullptr), _future_retrieved(false), _executed(false) {}
+
+    template <typename Function, typename = typename std::enable_if<
+                                     !std::is_same<typename std::decay<Function>::type, packaged_task>::value>::type>
+    explicit inline packaged_task(Function&& func)
+        : _state(new details::task_state<R, typename std::decay<Function>::type>(std::forward<Function>(func))),
+          _future_retrieved(false), _executed(false) {}
+
+    inline packaged_task(packaged_task&& other) noexcept;
+
+    inline packaged_task& operator=(packaged_task&& other) noexcept;
+
+    packaged_task(const packaged_task&) = delete;
+    packaged_task& operator=(const packaged_task&) = delete;
+
+    /// a task destroyed without execution stores a broken_promise error
+    inline ~packaged_task() { _abandon(); }
+
+    inline bool valid() const noexcept { return _state != nullptr; }
+
+    inline future<R> get_future();
+
+    /// execute the task, exceptions are stored in the shared state
+    inline void operator()();
+
+  private:
+    inline void _abandon() noexcept;
+
+    details::task_state_base<R>* _state;
+    bool _future_retrieved, _executed;
+};
+
+
+///
+/// result of when_any: index of the first ready future, and all the futures
+///
+template <typename Sequence>
+struct when_any_result {
+    std::size_t index;
+    Sequence futures;
+};
+
+
+///
+/// \brief future ready when all the futures of the range [first, last) are ready
+///
+/// the futures are moved into the result, no thread waits for them
+///
+template <typename InputIterator>
+inline future<std::vector<typename std::iterator_traits<InputIterator>::value_type>> when_all(InputIterator first,
+                                                                                              InputIterator last);
+
+/// when_all for a list of futures of the same type
+template <typename T, typename... Futures>
+inline future<std::vector<future<T>>> when_all(future<T>&& first, Futures&&... others);
+
+
+///
+/// \brief future ready when any future of the range [first, last) is ready
+///
+/// index is the position of the first ready future, or std::size_t(-1) for an empty range
+///
+template <typename InputIterator>
+inline future<when_any_result<std::vector<typename std::iterator_traits<InputIterator>::value_type>>>
+    when_any(InputIterator first, InputIterator last);
+
+/// when_any for a list of futures of the same type
+template <typename T, typename... Futures>
+inline future<when_any_result<std::vector<future<T>>>> when_any(future<T>&& first, Futures&&... others);
+
+
+} // namespace thread
+
+} // namespace hadoken
+
+
+#include "bits/future_bits.hpp"
+
+#endif // _HADOKEN_THREAD_FUTURE_HPP_
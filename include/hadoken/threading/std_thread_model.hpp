@@ -30,9 +30,10 @@
 #define HADOKEN_STD_THREAD_MODEL_HPP
 
 #include <condition_variable>
-#include <future>
 #include <mutex>
 
+#include <hadoken/thread/future.hpp>
+
 namespace hadoken {
 
 
@@ -41,8 +42,12 @@ class std_thread_model {
     using mutex = std::mutex;
     using condition_variable = std::condition_variable;
 
+    /// future with continuations, see hadoken::thread::future
+    template <typename T>
+    using future = thread::future<T>;
+
     template <typename T>
-    using future = std::future<T>;
+    using promise = thread::promise<T>;
 };
 
 
@@ -30,6 +30,8 @@
 #define HADOKEN_OPTIONAL_HPP
 
 
+#include <type_traits>
+
 #include <boost/optional.hpp>
 
 namespace hadoken {
@@ -38,6 +40,28 @@ template <typename T>
 using optional = boost::optional<T>;
 
 
+namespace details {
+
+// boost::optional stores scalar types directly, without initializing the storage of an empty optional:
+// an empty optional<int> returned in registers reads uninitialized memory ( -Wmaybe-uninitialized )
+template <typename T>
+inline optional<T> empty_optional(std::true_type) {
+    return optional<T>(false, T());
+}
+
+template <typename T>
+inline optional<T> empty_optional(std::false_type) {
+    return optional<T>();
+}
+
+template <typename T>
+inline optional<T> empty_optional() {
+    return empty_optional<T>(std::is_scalar<T>());
+}
+
+} // namespace details
+
+
 
 } // namespace hadoken
 
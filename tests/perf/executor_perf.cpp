@@ -28,9 +28,15 @@
  */
 
 
+#include <atomic>
+#include <cstdlib>
+#include <functional>
 #include <future>
+#include <memory>
 #include <mutex>
+#include <new>
 #include <thread>
+#include <vector>
 
 #include <boost/test/floating_point_comparison.hpp>
 
@@ -42,7 +48,9 @@
 
 #include <hadoken/executor/simple_thread_executor.hpp>
 #include <hadoken/executor/system_executor.hpp>
+#include <hadoken/containers/concurrent_queue_mpmc_bounded.hpp>
 #include <hadoken/executor/thread_pool_executor.hpp>
+#include <hadoken/executor/timer_executor.hpp>
 
 
 using namespace boost::chrono;
@@ -51,6 +59,28 @@ typedef system_clock::time_point tp;
 typedef system_clock cl;
 
 
+// count every heap allocation of the process
+static std::atomic<std::size_t> allocation_counter(0);
+
+void* operator new(std::size_t size) {
+    allocation_counter.fetch_add(1, std::memory_order_relaxed);
+    void* ptr = std::malloc((size > 0) ? size : 1);
+    if (ptr == nullptr) {
+        throw std::bad_alloc();
+    }
+    return ptr;
+}
+
+// not inlined: gcc would pair the inlined free() with the builtin operator new and warn
+__attribute__((noinline)) void operator delete(void* ptr) noexcept {
+    std::free(ptr);
+}
+
+__attribute__((noinline)) void operator delete(void* ptr, std::size_t) noexcept {
+    std::free(ptr);
+}
+
+
 template <typename Executor>
 std::size_t executor_test(std::size_t n_exec, const std::string& executor_name) {
 
@@ -116,6 +146,272 @@ std::size_t executor_test_twoway(std::size_t n_exec, const std::string& executor
 }
 
 
+// heap allocations per submitted task, after warm-up
+template <typename Executor>
+std::size_t executor_test_allocations(std::size_t n_exec, const std::string& executor_name) {
+
+    std::atomic<std::size_t> counter(0);
+    std::size_t val = 0;
+
+    Executor executor(2);
+
+    for (int warmup = 0; warmup < 2; ++warmup) {
+
+        const std::size_t alloc_start = allocation_counter.load();
+
+        for (std::size_t i = 0; i < n_exec; ++i) {
+            executor.execute([&counter, i]() { counter += i; });
+        }
+        executor.wait_idle();
+
+        const std::size_t alloc_oneway = allocation_counter.load() - alloc_start;
+
+        for (std::size_t i = 0; i < n_exec; ++i) {
+            auto f = executor.twoway_execute([i]() { return i; });
+            val += f.get();
+        }
+
+        const std::size_t alloc_twoway = allocation_counter.load() - alloc_start - alloc_oneway;
+
+        if (warmup > 0) {
+            std::cout << executor_name << " allocations per task: execute " << double(alloc_oneway) / n_exec
+                      << "; twoway_execute " << double(alloc_twoway) / n_exec << std::endl;
+        }
+    }
+
+    return val + counter.load();
+}
+
+
+// heap allocations per call of the previous two-way path: std::function, shared promise, std::future
+std::size_t executor_test_allocations_std_function(std::size_t n_exec) {
+
+    std::size_t val = 0;
+
+    const std::size_t alloc_start = allocation_counter.load();
+
+    for (std::size_t i = 0; i < n_exec; ++i) {
+        auto prom = std::make_shared<std::promise<std::size_t>>();
+        auto f = prom->get_future();
+
+        std::function<void()> task([prom, i]() { prom->set_value(i); });
+        task();
+
+        val += f.get();
+    }
+
+    std::cout << "std::function and std::promise allocations per task: twoway_execute "
+              << double(allocation_counter.load() - alloc_start) / n_exec << std::endl;
+
+    return val;
+}
+
+
+// fork/join of n_tasks small tasks: one future per task against a single bulk submission
+std::size_t executor_test_fork_join(std::size_t n_exec, std::size_t n_tasks, bool bulk, const std::string& executor_name) {
+
+    tp t1, t2;
+
+    std::atomic<std::size_t> counter(0);
+
+    hadoken::thread_pool_executor executor;
+
+    t1 = cl::now();
+
+    for (std::size_t i = 0; i < n_exec; ++i) {
+        if (bulk) {
+            executor.bulk_twoway_execute(n_tasks, [&counter](std::size_t j) { counter += j; }).get();
+        } else {
+            std::vector<hadoken::thread_pool_executor::future<void>> futures;
+            for (std::size_t j = 0; j < n_tasks; ++j) {
+                futures.emplace_back(executor.twoway_execute([&counter, j]() { counter += j; }));
+            }
+            for (auto& f : futures) {
+                f.get();
+            }
+        }
+    }
+
+    t2 = cl::now();
+
+    std::cout << executor_name << " fork/join of " << n_tasks << " tasks: "
+              << double(boost::chrono::duration_cast<microseconds>(t2 - t1).count()) / n_exec << std::endl;
+
+    return counter.load();
+}
+
+
+// 3-stage pipeline over n_items: continuations scheduled by then() against blocking get() between stages
+std::size_t executor_test_pipeline(std::size_t n_items, bool continuations, const std::string& executor_name) {
+    using future_type = hadoken::thread_pool_executor::future<std::size_t>;
+
+    tp t1, t2;
+
+    std::size_t sum = 0;
+
+    hadoken::thread_pool_executor executor;
+
+    t1 = cl::now();
+
+    if (continuations) {
+        std::vector<future_type> results;
+        results.reserve(n_items);
+        for (std::size_t i = 0; i < n_items; ++i) {
+            results.push_back(executor.twoway_execute([i]() { return i; })
+                                  .then(executor, [](future_type v) { return v.get() * 3; })
+                                  .then(executor, [](future_type v) { return v.get() + 1; }));
+        }
+        for (auto& f : results) {
+            sum += f.get();
+        }
+    } else {
+        for (std::size_t i = 0; i < n_items; ++i) {
+            const std::size_t stage1 = executor.twoway_execute([i]() { return i; }).get();
+            const std::size_t stage2 = executor.twoway_execute([stage1]() { return stage1 * 3; }).get();
+            sum += executor.twoway_execute([stage2]() { return stage2 + 1; }).get();
+        }
+    }
+
+    t2 = cl::now();
+
+    std::cout << executor_name << " 3-stage pipeline: "
+              << double(boost::chrono::duration_cast<microseconds>(t2 - t1).count()) / n_items << std::endl;
+
+    return sum;
+}
+
+
+// insertion and cancellation cost with n_timers pending, then expiration throughput
+std::size_t timer_test(std::size_t n_timers) {
+
+    tp t1, t2, t3;
+
+    std::atomic<std::size_t> counter(0);
+    std::vector<hadoken::timer_executor::timer_handle> handles;
+    handles.reserve(n_timers);
+
+    boost::random::mt19937 rng(42);
+    boost::random::uniform_int_distribution<int> delay_ms(1000, 60000);
+
+    hadoken::timer_executor timer;
+
+    t1 = cl::now();
+
+    for (std::size_t i = 0; i < n_timers; ++i) {
+        handles.push_back(timer.execute_after(std::chrono::milliseconds(delay_ms(rng)), [&counter]() { counter += 1; }));
+    }
+
+    t2 = cl::now();
+
+    for (auto& h : handles) {
+        timer.cancel(h);
+    }
+
+    t3 = cl::now();
+
+    std::cout << "timer_executor " << n_timers << " timers: insert "
+              << double(boost::chrono::duration_cast<nanoseconds>(t2 - t1).count()) / n_timers << "ns; cancel "
+              << double(boost::chrono::duration_cast<nanoseconds>(t3 - t2).count()) / n_timers << "ns" << std::endl;
+
+    // every timer expires within 100ms
+    boost::random::uniform_int_distribution<int> delay_us(0, 100000);
+
+    t1 = cl::now();
+
+    for (std::size_t i = 0; i < n_timers; ++i) {
+        timer.execute_after(std::chrono::microseconds(delay_us(rng)), [&counter]() { counter += 1; });
+    }
+
+    while (counter.load() < n_timers) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+
+    t2 = cl::now();
+
+    std::cout << "timer_executor " << n_timers << " timers expired in "
+              << boost::chrono::duration_cast<milliseconds>(t2 - t1).count() << "ms" << std::endl;
+
+    return counter.load();
+}
+
+
+template <typename T>
+using bounded_queue = hadoken::concurrent_queue_mpmc_bounded<T, 4096>;
+
+
+// round trip latency of a pool with a given spin budget before parking
+std::size_t executor_test_spin_budget(std::size_t n_exec, std::size_t spin_budget, const std::string& executor_name) {
+
+    tp t1, t2;
+
+    int val = 0;
+
+    std::plus<int> add;
+
+    hadoken::thread_pool_executor executor;
+    executor.set_spin_budget(spin_budget);
+
+    t1 = cl::now();
+
+    for (std::size_t i = 0; i < n_exec; ++i) {
+
+        std::packaged_task<int(int, int)> task(add);
+        auto f = task.get_future();
+
+        executor.execute([&]() { task(40, 2); });
+
+        val += f.get();
+    }
+
+    t2 = cl::now();
+
+    std::cout << executor_name << " spin_budget " << spin_budget << ": "
+              << double(boost::chrono::duration_cast<microseconds>(t2 - t1).count()) / n_exec << std::endl;
+
+    return val;
+}
+
+
+// fine grained task graph: binary tree of tasks spawned from the pool threads
+std::size_t executor_test_task_tree(std::size_t n_thread, std::size_t depth, bool work_stealing,
+                                    const std::string& executor_name) {
+
+    tp t1, t2;
+
+    std::atomic<std::size_t> counter(0);
+    const std::size_t n_tasks = (std::size_t(1) << (depth + 1)) - 1;
+
+    std::function<void(std::size_t)> spawn_tree;
+
+    hadoken::thread_pool_executor executor(n_thread);
+    executor.set_flags(hadoken::thread_pool_executor::flags::work_stealing, work_stealing);
+
+    spawn_tree = [&](std::size_t level) {
+        counter += 1;
+        if (level < depth) {
+            executor.execute([&spawn_tree, level]() { spawn_tree(level + 1); });
+            executor.execute([&spawn_tree, level]() { spawn_tree(level + 1); });
+        }
+    };
+
+    t1 = cl::now();
+
+    executor.execute([&spawn_tree]() { spawn_tree(0); });
+
+    while (counter.load() < n_tasks) {
+        std::this_thread::yield();
+    }
+
+    t2 = cl::now();
+
+    const double elapsed_sec = double(boost::chrono::duration_cast<microseconds>(t2 - t1).count()) / 1000000.0;
+
+    std::cout << executor_name << "; threads " << n_thread << "; tasks/s " << double(n_tasks) / elapsed_sec << std::endl;
+
+    return counter.load();
+}
+
+
 
 int main() {
 
@@ -132,5 +428,49 @@ int main() {
 
     junk += executor_test_twoway<hadoken::thread_pool_executor>(n_exec, "pool_executor_twoway");
 
+    junk += executor_test_spin_budget(n_exec, 0, "pool_executor");
+
+    junk += executor_test_spin_budget(n_exec, 1024, "pool_executor");
+
+    std::cout << "\ntest heap allocations\n";
+
+    junk += executor_test_allocations_std_function(n_exec);
+
+    junk += executor_test_allocations<hadoken::thread_pool_executor>(n_exec, "pool_executor");
+
+    junk += executor_test_allocations<hadoken::basic_thread_pool_executor<bounded_queue>>(n_exec, "pool_executor_bounded_queue");
+
+    std::cout << "\ntest fork/join\n";
+
+    for (std::size_t n_tasks : {std::size_t(16), std::size_t(256)}) {
+        junk += executor_test_fork_join(n_exec / 16, n_tasks, false, "pool_executor_twoway");
+        junk += executor_test_fork_join(n_exec / 16, n_tasks, true, "pool_executor_bulk");
+    }
+
+    std::cout << "\ntest pipelines\n";
+
+    junk += executor_test_pipeline(n_exec, false, "pool_executor_blocking_get");
+    junk += executor_test_pipeline(n_exec, true, "pool_executor_then");
+
+    std::cout << "\ntest timers\n";
+
+    junk += timer_test(1000000);
+
+    const std::size_t ncore = std::thread::hardware_concurrency();
+    const std::size_t tree_depth = 18;
+
+    hadoken::format::scat(std::cout, "\ntest task tree of depth ", tree_depth, " with up to ", ncore, " cores\n");
+
+    std::vector<std::size_t> thread_counts;
+    for (std::size_t n_thread = 1; n_thread < ncore; n_thread *= 2) {
+        thread_counts.push_back(n_thread);
+    }
+    thread_counts.push_back(ncore);
+
+    for (auto n_thread : thread_counts) {
+        junk += executor_test_task_tree(n_thread, tree_depth, false, "pool_executor_shared_queue");
+        junk += executor_test_task_tree(n_thread, tree_depth, true, "pool_executor_work_stealing");
+    }
+
     std::cout << "end junk " << junk << std::endl;
 }
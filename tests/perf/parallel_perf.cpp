@@ -28,8 +28,12 @@
  */
 
 
+#include <cstdint>
+#include <cstring>
 #include <future>
+#include <memory>
 #include <mutex>
+#include <numeric>
 #include <set>
 #include <thread>
 #include <vector>
@@ -42,6 +46,7 @@
 
 #include <hadoken/format/format.hpp>
 
+#include <hadoken/executor/thread_pool_executor.hpp>
 #include <hadoken/parallel/algorithm.hpp>
 
 
@@ -107,6 +112,182 @@ std::size_t for_each_vector(std::size_t s_vector, std::size_t n_exec, const std:
 
 
 
+// skewed workload: the cost of an element grows with its position in the vector
+template <typename ForEach>
+std::size_t for_each_skewed_vector(std::size_t s_vector, std::size_t n_exec, const std::string& executor_name) {
+
+    tp t1, t2;
+
+    std::vector<double> values(s_vector, 0);
+
+    std::size_t n = 0;
+    for (auto& v : values) {
+        v += n++;
+    }
+
+    const double* first = values.data();
+    const std::size_t max_cost = 16;
+    auto fops = [first, s_vector, max_cost](double& v) {
+        const std::size_t cost = 1 + (std::size_t(&v - first) * max_cost) / s_vector;
+        double res = v;
+        for (std::size_t i = 0; i < cost; ++i) {
+            res = dummy_operation<double>(res);
+        }
+        v = res;
+    };
+
+    std::size_t cumulated_time = 0;
+
+    for (std::size_t i = 0; i < n_exec; ++i) {
+
+        t1 = cl::now();
+
+        ForEach f;
+
+        f.for_each(values.begin(), values.end(), fops);
+
+        t2 = cl::now();
+
+        cumulated_time += boost::chrono::duration_cast<microseconds>(t2 - t1).count();
+    }
+
+    const int val = int(std::accumulate(values.begin(), values.end(), 0.0, std::plus<double>()));
+
+    std::cout << "" << executor_name << "; skewed vector;  " << s_vector << "; " << double(cumulated_time) / n_exec << ";"
+              << std::endl;
+
+    return std::size_t(val);
+}
+
+
+
+template <typename Sort>
+std::size_t sort_vector(std::size_t s_vector, std::size_t n_exec, const std::string& executor_name) {
+
+    boost::random::mt19937 gen;
+    boost::random::uniform_int_distribution<std::uint64_t> dist;
+
+    std::vector<std::uint64_t> origin(s_vector);
+    for (auto& v : origin) {
+        v = dist(gen);
+    }
+
+    std::size_t cumulated_time = 0, junk = 0;
+
+    for (std::size_t i = 0; i < n_exec; ++i) {
+        std::vector<std::uint64_t> values(origin);
+
+        tp t1 = cl::now();
+
+        Sort s;
+        s.sort(values.begin(), values.end());
+
+        tp t2 = cl::now();
+
+        cumulated_time += boost::chrono::duration_cast<microseconds>(t2 - t1).count();
+        junk += std::size_t(values[values.size() / 2]);
+    }
+
+    std::cout << "" << executor_name << "; vector;  " << s_vector << "; " << double(cumulated_time) / n_exec << ";"
+              << std::endl;
+
+    return junk;
+}
+
+
+
+// scan throughput, in GB/s of input read and output written
+template <typename Scan>
+std::size_t scan_vector(std::size_t s_vector, std::size_t n_exec, const std::string& executor_name) {
+
+    std::vector<std::uint64_t> values(s_vector, 1), res(s_vector);
+
+    std::size_t cumulated_time = 0, junk = 0;
+
+    for (std::size_t i = 0; i < n_exec; ++i) {
+        tp t1 = cl::now();
+
+        Scan s;
+        s.scan(values.begin(), values.end(), res.begin());
+
+        tp t2 = cl::now();
+
+        cumulated_time += boost::chrono::duration_cast<microseconds>(t2 - t1).count();
+        junk += std::size_t(res.back());
+    }
+
+    const double average_time = double(cumulated_time) / n_exec;
+    const double bandwidth = (2.0 * s_vector * sizeof(std::uint64_t)) / (average_time * 1000.0);
+
+    std::cout << "" << executor_name << "; vector;  " << s_vector << "; " << average_time << "; " << bandwidth << " GB/s;"
+              << std::endl;
+
+    return junk;
+}
+
+
+
+// unary transform throughput, in GB/s of input read and output written
+template <typename Transform>
+std::size_t transform_vector(std::size_t s_vector, std::size_t n_exec, const std::string& executor_name) {
+
+    std::vector<float> values(s_vector, 1.5f), res(s_vector);
+
+    std::size_t cumulated_time = 0, junk = 0;
+
+    for (std::size_t i = 0; i < n_exec; ++i) {
+        tp t1 = cl::now();
+
+        Transform t;
+        t.transform(values.data(), values.data() + s_vector, res.data(), [](float v) { return v * 2.0f + 1.0f; });
+
+        tp t2 = cl::now();
+
+        cumulated_time += boost::chrono::duration_cast<microseconds>(t2 - t1).count();
+        junk += std::size_t(res[s_vector / 2]);
+    }
+
+    const double average_time = double(cumulated_time) / n_exec;
+    const double bandwidth = (2.0 * s_vector * sizeof(float)) / (average_time * 1000.0);
+
+    std::cout << "" << executor_name << "; vector;  " << s_vector << "; " << average_time << "; " << bandwidth << " GB/s;"
+              << std::endl;
+
+    return junk;
+}
+
+
+
+// stream compaction, keeps one element out of two
+template <typename CopyIf>
+std::size_t copy_if_vector(std::size_t s_vector, std::size_t n_exec, const std::string& executor_name) {
+
+    std::vector<std::uint32_t> values(s_vector), res(s_vector);
+    boost::random::mt19937 gen;
+    std::generate(values.begin(), values.end(), [&]() { return std::uint32_t(gen()); });
+
+    std::size_t cumulated_time = 0, junk = 0;
+
+    for (std::size_t i = 0; i < n_exec; ++i) {
+        tp t1 = cl::now();
+
+        CopyIf c;
+        auto res_end = c.copy_if(values.begin(), values.end(), res.begin(), [](std::uint32_t v) { return (v & 0x1) == 0; });
+
+        tp t2 = cl::now();
+
+        cumulated_time += boost::chrono::duration_cast<microseconds>(t2 - t1).count();
+        junk += std::size_t(res_end - res.begin());
+    }
+
+    std::cout << "" << executor_name << "; vector;  " << s_vector << "; " << double(cumulated_time) / n_exec << ";"
+              << std::endl;
+
+    return junk;
+}
+
+
+
 template <typename ForEach>
 std::size_t for_each_set(std::size_t s_set, std::size_t n_exec, const std::string& executor_name) {
 
@@ -173,6 +354,149 @@ struct hadoken_parallel_for_each {
 
 
 
+template <hadoken::parallel::partitioner Partitioner>
+struct hadoken_partitioned_for_each {
+
+    template <typename Iter, typename Fun>
+    void for_each(Iter iter1, Iter iter2, Fun fun) {
+        using namespace hadoken;
+        static std::shared_ptr<thread_pool_executor> pool = std::make_shared<thread_pool_executor>();
+
+        parallel::parallel_shared_exec_policy<thread_pool_executor> policy(pool);
+        policy.set_partitioner(Partitioner);
+        parallel::for_each(policy, iter1, iter2, fun);
+    }
+};
+
+
+
+struct std_sort {
+
+    template <typename Iter>
+    void sort(Iter iter1, Iter iter2) {
+        std::sort(iter1, iter2);
+    }
+};
+
+
+
+struct hadoken_parallel_sort {
+
+    template <typename Iter>
+    void sort(Iter iter1, Iter iter2) {
+        using namespace hadoken;
+        parallel::sort(parallel::parallel_execution_policy(), iter1, iter2);
+    }
+};
+
+
+
+struct std_stable_sort {
+
+    template <typename Iter>
+    void sort(Iter iter1, Iter iter2) {
+        std::stable_sort(iter1, iter2);
+    }
+};
+
+
+
+struct hadoken_parallel_stable_sort {
+
+    template <typename Iter>
+    void sort(Iter iter1, Iter iter2) {
+        using namespace hadoken;
+        parallel::stable_sort(parallel::parallel_execution_policy(), iter1, iter2);
+    }
+};
+
+
+
+struct hadoken_parallel_radix_sort {
+
+    template <typename Iter>
+    void sort(Iter iter1, Iter iter2) {
+        using namespace hadoken;
+        parallel::radix_sort(parallel::parallel_execution_policy(), iter1, iter2);
+    }
+};
+
+
+
+struct std_partial_sum {
+
+    template <typename Iter, typename OutIter>
+    void scan(Iter iter1, Iter iter2, OutIter out) {
+        std::partial_sum(iter1, iter2, out);
+    }
+};
+
+
+
+struct hadoken_parallel_inclusive_scan {
+
+    template <typename Iter, typename OutIter>
+    void scan(Iter iter1, Iter iter2, OutIter out) {
+        using namespace hadoken;
+        parallel::inclusive_scan(parallel::parallel_execution_policy(), iter1, iter2, out);
+    }
+};
+
+
+
+struct std_memcpy_transform {
+
+    template <typename T, typename UnaryOperation>
+    void transform(const T* first, const T* last, T* out, UnaryOperation) {
+        std::memcpy(out, first, (last - first) * sizeof(T));
+    }
+};
+
+
+
+struct std_transform {
+
+    template <typename Iter, typename OutIter, typename UnaryOperation>
+    void transform(Iter iter1, Iter iter2, OutIter out, UnaryOperation op) {
+        std::transform(iter1, iter2, out, op);
+    }
+};
+
+
+
+template <typename ExecPolicy>
+struct hadoken_parallel_transform {
+
+    template <typename Iter, typename OutIter, typename UnaryOperation>
+    void transform(Iter iter1, Iter iter2, OutIter out, UnaryOperation op) {
+        using namespace hadoken;
+        parallel::transform(ExecPolicy(), iter1, iter2, out, op);
+    }
+};
+
+
+
+struct std_copy_if {
+
+    template <typename Iter, typename OutIter, typename Pred>
+    OutIter copy_if(Iter iter1, Iter iter2, OutIter out, Pred p) {
+        return std::copy_if(iter1, iter2, out, p);
+    }
+};
+
+
+
+struct hadoken_parallel_copy_if {
+
+    template <typename Iter, typename OutIter, typename Pred>
+    OutIter copy_if(Iter iter1, Iter iter2, OutIter out, Pred p) {
+        using namespace hadoken;
+        return parallel::copy_if(parallel::parallel_execution_policy(), iter1, iter2, out, p);
+    }
+};
+
+
+
 int main() {
     std::string parallel_mode = "";
 #ifdef HADOKEN_PARALLEL_USE_OMP
@@ -206,6 +530,87 @@ int main() {
     }
 
 
+    const std::size_t max_size_skewed = 1000000;
+
+    hadoken::format::scat(std::cout, "\n# test skewed workloads with ", n_exec / 10, " iterations \n");
+    hadoken::format::scat(std::cout, "theading; cores; executor; container; size; time; \n");
+
+    using hadoken::parallel::partitioner;
+    for (std::size_t i = 100; i < max_size_skewed; i *= 10) {
+        const std::size_t skewed_n_exec = std::max<std::size_t>(1, (n_exec / 10) * 1000 / std::max<std::size_t>(i, 1000));
+        const std::string prefix = fmt::scat(parallel_mode, "; ", ncore, "; ");
+
+        junk += for_each_skewed_vector<std_for_each>(i, skewed_n_exec, fmt::scat(prefix, "serial_for_each"));
+        junk += for_each_skewed_vector<hadoken_partitioned_for_each<partitioner::static_split>>(
+            i, skewed_n_exec, fmt::scat(prefix, "static_split_for_each"));
+        junk += for_each_skewed_vector<hadoken_partitioned_for_each<partitioner::dynamic>>(
+            i, skewed_n_exec, fmt::scat(prefix, "dynamic_for_each"));
+        junk += for_each_skewed_vector<hadoken_partitioned_for_each<partitioner::guided>>(i, skewed_n_exec,
+                                                                                          fmt::scat(prefix, "guided_for_each"));
+        junk += for_each_skewed_vector<hadoken_partitioned_for_each<partitioner::automatic>>(
+            i, skewed_n_exec, fmt::scat(prefix, "automatic_for_each"));
+    }
+
+
+    const std::size_t max_size_sort = 100000000;
+
+    hadoken::format::scat(std::cout, "\n# test sort with ", n_exec / 10, " iterations \n");
+    hadoken::format::scat(std::cout, "theading; cores; executor; container; size; time; \n");
+
+    for (std::size_t i = 1000; i <= max_size_sort; i *= 10) {
+        const std::size_t sort_n_exec = std::max<std::size_t>(1, (n_exec / 10) * 100000 / std::max<std::size_t>(i, 100000));
+
+        junk += sort_vector<std_sort>(i, sort_n_exec, fmt::scat(parallel_mode, "; ", ncore, "; ", "serial_sort"));
+        junk += sort_vector<hadoken_parallel_sort>(i, sort_n_exec, fmt::scat(parallel_mode, "; ", ncore, "; ", "parallel_sort"));
+        junk += sort_vector<hadoken_parallel_radix_sort>(i, sort_n_exec,
+                                                         fmt::scat(parallel_mode, "; ", ncore, "; ", "parallel_radix_sort"));
+        junk += sort_vector<std_stable_sort>(i, sort_n_exec, fmt::scat(parallel_mode, "; ", ncore, "; ", "serial_stable_sort"));
+        junk += sort_vector<hadoken_parallel_stable_sort>(i, sort_n_exec,
+                                                          fmt::scat(parallel_mode, "; ", ncore, "; ", "parallel_stable_sort"));
+    }
+
+
+    hadoken::format::scat(std::cout, "\n# test inclusive scan with ", n_exec / 10, " iterations \n");
+    hadoken::format::scat(std::cout, "theading; cores; executor; container; size; time; bandwidth; \n");
+
+    for (std::size_t i = 1000; i <= max_size_sort; i *= 10) {
+        const std::size_t scan_n_exec = std::max<std::size_t>(1, (n_exec / 10) * 1000000 / std::max<std::size_t>(i, 1000000));
+
+        junk += scan_vector<std_partial_sum>(i, scan_n_exec, fmt::scat(parallel_mode, "; ", ncore, "; ", "serial_partial_sum"));
+        junk += scan_vector<hadoken_parallel_inclusive_scan>(
+            i, scan_n_exec, fmt::scat(parallel_mode, "; ", ncore, "; ", "parallel_inclusive_scan"));
+    }
+
+
+    hadoken::format::scat(std::cout, "\n# test unary transform with ", n_exec / 10, " iterations \n");
+    hadoken::format::scat(std::cout, "theading; cores; executor; container; size; time; bandwidth; \n");
+
+    for (std::size_t i = 1000; i <= max_size_sort * 10; i *= 10) {
+        const std::size_t transform_n_exec = std::max<std::size_t>(1, (n_exec / 10) * 1000000 / std::max<std::size_t>(i, 1000000));
+
+        junk += transform_vector<std_memcpy_transform>(i, transform_n_exec, fmt::scat(parallel_mode, "; ", ncore, "; ", "memcpy"));
+        junk += transform_vector<std_transform>(i, transform_n_exec, fmt::scat(parallel_mode, "; ", ncore, "; ", "serial_transform"));
+        junk += transform_vector<hadoken_parallel_transform<hadoken::parallel::parallel_execution_policy>>(
+            i, transform_n_exec, fmt::scat(parallel_mode, "; ", ncore, "; ", "parallel_transform"));
+        junk += transform_vector<hadoken_parallel_transform<hadoken::parallel::parallel_vector_execution_policy>>(
+            i, transform_n_exec, fmt::scat(parallel_mode, "; ", ncore, "; ", "parallel_vector_transform"));
+    }
+
+
+    const std::size_t max_size_copy_if = 1000000000;
+
+    hadoken::format::scat(std::cout, "\n# test copy_if with ", n_exec / 10, " iterations \n");
+    hadoken::format::scat(std::cout, "theading; cores; executor; container; size; time; \n");
+
+    for (std::size_t i = 1000000; i <= max_size_copy_if; i *= 10) {
+        const std::size_t copy_if_n_exec = std::max<std::size_t>(1, (n_exec / 10) * 1000000 / i);
+
+        junk += copy_if_vector<std_copy_if>(i, copy_if_n_exec, fmt::scat(parallel_mode, "; ", ncore, "; ", "serial_copy_if"));
+        junk += copy_if_vector<hadoken_parallel_copy_if>(i, copy_if_n_exec,
+                                                         fmt::scat(parallel_mode, "; ", ncore, "; ", "parallel_copy_if"));
+    }
+
+
     /*
 
     #ifndef HADOKEN_PARALLEL_USE_OMP
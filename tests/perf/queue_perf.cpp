@@ -0,0 +1,228 @@
+/**
+ * Copyright (c) 2016, Adrien Devresse <adrien.devresse@epfl.ch>
+ *
+ * Boost Software License - Version 1.0
+ *
+ * Permission is hereby granted, free of charge, to any person or organization
+ * obtaining a copy of the software and accompanying documentation covered by
+ * this license (the "Software") to use, reproduce, display, distribute,
+ * execute, and transmit the Software, and to prepare derivative works of the
+ * Software, and to permit third-parties to whom the Software is furnished to
+ * do so, all subject to the following:
+ *
+ * The copyright notices in the Software and this entire statement, including
+ * the above license grant, this restriction and the following disclaimer,
+ * must be included in all copies of the Software, in whole or in part, and
+ * all derivative works of the Software, unless such copies or derivative
+ * works are solely in the form of machine-executable object code generated by
+ * a source language processor.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+ * SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+ * FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+
+#include <atomic>
+#include <future>
+#include <iostream>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <boost/chrono.hpp>
+
+#include <hadoken/containers/concurrent_queue.hpp>
+#include <hadoken/containers/concurrent_queue_mpmc_bounded.hpp>
+#include <hadoken/containers/concurrent_queue_spsc.hpp>
+#include <hadoken/format/format.hpp>
+
+
+using namespace boost::chrono;
+
+typedef system_clock::time_point tp;
+typedef system_clock cl;
+
+
+template <typename QueueType>
+std::size_t queue_test(std::size_t n_thread, std::size_t iter, const std::string& queue_name) {
+    tp t1, t2;
+
+    QueueType queue;
+    std::vector<std::future<void>> producers, consumers;
+    std::atomic<std::size_t> n_consumed(0), sum(0);
+    const std::size_t n_items = n_thread * iter;
+
+    t1 = cl::now();
+
+    // n_thread producers and n_thread consumers
+    for (std::size_t i = 0; i < n_thread; ++i) {
+        producers.emplace_back(std::async(std::launch::async, [&] {
+            for (std::size_t j = 0; j < iter; ++j) {
+                queue.push(j);
+            }
+        }));
+
+        consumers.emplace_back(std::async(std::launch::async, [&] {
+            std::size_t local_sum = 0;
+            while (n_consumed.load(std::memory_order_relaxed) < n_items) {
+                auto item = queue.try_pop(std::chrono::microseconds(100));
+                if (item) {
+                    local_sum += item.get();
+                    n_consumed += 1;
+                }
+            }
+            sum += local_sum;
+        }));
+    }
+
+    for (auto& f : producers) {
+        f.wait();
+    }
+
+    for (auto& f : consumers) {
+        f.wait();
+    }
+
+    t2 = cl::now();
+
+    std::cout << queue_name << ": " << boost::chrono::duration_cast<milliseconds>(t2 - t1) << std::endl;
+
+    if (sum.load() != n_thread * (iter * (iter - 1) / 2)) {
+        std::cerr << "invalid queue result, thread safety issue !" << std::endl;
+        abort();
+    }
+
+    return sum.load();
+}
+
+
+
+// one producer, one consumer, element per element
+template <typename QueueType>
+std::size_t queue_test_single_pair(std::size_t iter, const std::string& queue_name) {
+    tp t1, t2;
+
+    QueueType queue;
+    std::size_t sum = 0;
+
+    t1 = cl::now();
+
+    auto producer = std::async(std::launch::async, [&] {
+        for (std::size_t j = 0; j < iter; ++j) {
+            queue.push(j);
+        }
+    });
+
+    for (std::size_t n_consumed = 0; n_consumed < iter;) {
+        auto item = queue.try_pop(std::chrono::microseconds(100));
+        if (item) {
+            sum += item.get();
+            n_consumed += 1;
+        }
+    }
+
+    producer.wait();
+
+    t2 = cl::now();
+
+    std::cout << queue_name << ": " << boost::chrono::duration_cast<milliseconds>(t2 - t1) << std::endl;
+
+    return sum;
+}
+
+
+// one producer, one consumer, spsc queue with batch operations
+std::size_t queue_test_spsc_batch(std::size_t iter, std::size_t batch_size, const std::string& queue_name) {
+    tp t1, t2;
+
+    hadoken::concurrent_queue_spsc<std::size_t> queue(4096);
+    std::size_t sum = 0;
+
+    t1 = cl::now();
+
+    auto producer = std::async(std::launch::async, [&] {
+        std::vector<std::size_t> batch(batch_size);
+        for (std::size_t j = 0; j < iter;) {
+            const std::size_t n = std::min(batch_size, iter - j);
+            for (std::size_t k = 0; k < n; ++k) {
+                batch[k] = j + k;
+            }
+
+            std::size_t pushed = 0;
+            while (pushed < n) {
+                const std::size_t n_batch = queue.push_n(batch.begin() + pushed, n - pushed);
+                if (n_batch == 0) {
+                    // full, blocking push
+                    queue.push(batch[pushed]);
+                    pushed += 1;
+                }
+                pushed += n_batch;
+            }
+            j += n;
+        }
+    });
+
+    std::vector<std::size_t> batch(batch_size);
+    for (std::size_t n_consumed = 0; n_consumed < iter;) {
+        const std::size_t n = queue.pop_n(batch.begin(), batch_size);
+        if (n == 0) {
+            // empty, blocking pop
+            sum += queue.pop();
+            n_consumed += 1;
+        }
+
+        for (std::size_t k = 0; k < n; ++k) {
+            sum += batch[k];
+        }
+        n_consumed += n;
+    }
+
+    producer.wait();
+
+    t2 = cl::now();
+
+    std::cout << queue_name << ": " << boost::chrono::duration_cast<milliseconds>(t2 - t1) << std::endl;
+
+    return sum;
+}
+
+
+int main() {
+
+    const std::size_t ncore = std::thread::hardware_concurrency();
+    std::size_t junk = 0;
+    std::size_t iter = 100000;
+
+    using mutex_queue = hadoken::concurrent_queue<std::size_t>;
+    using bounded_queue = hadoken::concurrent_queue_mpmc_bounded<std::size_t, 4096>;
+
+    hadoken::format::scat(std::cout, "test queues with ", ncore, " cores", "\n");
+
+    for (std::size_t n_thread = 1; n_thread <= 64; n_thread *= 2) {
+        junk += queue_test<mutex_queue>(n_thread, iter,
+                                        hadoken::format::scat("hadoken::concurrent_queue_producers=consumers=", n_thread));
+
+        junk += queue_test<bounded_queue>(
+            n_thread, iter, hadoken::format::scat("hadoken::concurrent_queue_mpmc_bounded_producers=consumers=", n_thread));
+    }
+
+    using spsc_queue = hadoken::concurrent_queue_spsc<std::size_t>;
+
+    const std::size_t iter_pair = 2000000;
+
+    junk += queue_test_single_pair<mutex_queue>(iter_pair, "hadoken::concurrent_queue_single_pair");
+
+    junk += queue_test_single_pair<bounded_queue>(iter_pair, "hadoken::concurrent_queue_mpmc_bounded_single_pair");
+
+    junk += queue_test_single_pair<spsc_queue>(iter_pair, "hadoken::concurrent_queue_spsc_single_pair");
+
+    junk += queue_test_spsc_batch(iter_pair, 64, "hadoken::concurrent_queue_spsc_batch=64");
+
+    std::cout << "end junk " << junk << std::endl;
+}
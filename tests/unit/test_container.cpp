@@ -39,7 +39,10 @@
 
 
 #include <hadoken/containers/concurrent_queue.hpp>
+#include <hadoken/containers/concurrent_queue_mpmc_bounded.hpp>
+#include <hadoken/containers/concurrent_queue_spsc.hpp>
 #include <hadoken/containers/small_vector.hpp>
+#include <hadoken/containers/work_stealing_deque.hpp>
 
 #include <hadoken/utility/range.hpp>
 
@@ -338,4 +341,242 @@ BOOST_AUTO_TEST_CASE_TEMPLATE(concurrent_queue_test_pthread, T, small_vector_typ
     BOOST_CHECK_EQUAL(counter.load(), nb_input_items);
     BOOST_CHECK_EQUAL(result_items.size(), nb_input_items);
     BOOST_CHECK_EQUAL(queue.size(), 0);
+
+    // batch push keeps the order
+    queue.push_n(items.begin(), nb_input_items);
+    BOOST_CHECK_EQUAL(queue.size(), nb_input_items);
+    for (std::size_t i = 0; i < nb_input_items; ++i) {
+        auto item = queue.try_pop();
+        BOOST_CHECK(item);
+        BOOST_CHECK(item.get() == gen(i));
+    }
+    BOOST_CHECK_EQUAL(queue.empty(), true);
+}
+
+
+
+BOOST_AUTO_TEST_CASE(work_stealing_deque_test) {
+
+    using namespace hadoken;
+
+    constexpr std::size_t nb_items = 100000;
+    constexpr std::size_t thief_thread = 4;
+
+    // small initial capacity to exercise the growth path
+    work_stealing_deque<std::size_t> deque(4);
+
+    BOOST_CHECK_EQUAL(deque.empty(), true);
+    BOOST_CHECK(!deque.pop());
+    BOOST_CHECK(!deque.steal());
+
+    // owner side is LIFO, thief side is FIFO
+    deque.push(1);
+    deque.push(2);
+    deque.push(3);
+    BOOST_CHECK_EQUAL(deque.size(), 3);
+    BOOST_CHECK_EQUAL(deque.pop().get(), 3);
+    BOOST_CHECK_EQUAL(deque.steal().get(), 1);
+    BOOST_CHECK_EQUAL(deque.pop().get(), 2);
+    BOOST_CHECK_EQUAL(deque.empty(), true);
+
+    std::vector<std::atomic<int>> seen(nb_items);
+    for (auto& s : seen) {
+        s.store(0);
+    }
+
+    std::atomic<bool> producer_done(false);
+    std::vector<std::thread> thieves;
+
+    for (std::size_t i = 0; i < thief_thread; ++i) {
+        thieves.emplace_back([&]() {
+            while (producer_done.load() == false || deque.empty() == false) {
+                auto item = deque.steal();
+                if (item) {
+                    seen[item.get()] += 1;
+                }
+            }
+        });
+    }
+
+    for (std::size_t i = 0; i < nb_items; ++i) {
+        deque.push(i);
+        if (i % 3 == 0) {
+            auto item = deque.pop();
+            if (item) {
+                seen[item.get()] += 1;
+            }
+        }
+    }
+
+    while (auto item = deque.pop()) {
+        seen[item.get()] += 1;
+    }
+    producer_done.store(true);
+
+    for (auto& t : thieves) {
+        t.join();
+    }
+
+    // every element is consumed exactly once
+    BOOST_CHECK(std::all_of(seen.begin(), seen.end(), [](const std::atomic<int>& v) { return v.load() == 1; }));
+}
+
+
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(concurrent_queue_mpmc_bounded_test, T, small_vector_types) {
+
+    using namespace hadoken;
+
+    constexpr std::size_t nb_producers = 4;
+    constexpr std::size_t nb_consumers = 4;
+    constexpr std::size_t nb_items_per_producer = 2000;
+    constexpr std::size_t nb_items = nb_producers * nb_items_per_producer;
+
+    content_generator<T> gen;
+
+    // smaller than the number of items, producers have to wait for consumers
+    concurrent_queue_mpmc_bounded<T, 64> queue;
+
+    BOOST_CHECK_EQUAL(queue.size(), 0);
+    BOOST_CHECK_EQUAL(queue.empty(), true);
+    BOOST_CHECK(!queue.try_pop());
+    BOOST_CHECK(!queue.try_pop(std::chrono::microseconds(100)));
+
+    // fill until full
+    for (std::size_t i = 0; i < queue.capacity(); ++i) {
+        T item = gen(i);
+        BOOST_CHECK(queue.try_push(std::move(item)));
+    }
+    T extra_item = gen(0);
+    BOOST_CHECK(queue.try_push(std::move(extra_item)) == false);
+    BOOST_CHECK_EQUAL(queue.size(), queue.capacity());
+
+    // FIFO order
+    for (std::size_t i = 0; i < queue.capacity(); ++i) {
+        auto item = queue.try_pop();
+        BOOST_CHECK(item);
+        BOOST_CHECK(item.get() == gen(i));
+    }
+    BOOST_CHECK_EQUAL(queue.empty(), true);
+
+    // batch push
+    std::vector<T> batch;
+    for (std::size_t i = 0; i < 16; ++i) {
+        batch.emplace_back(gen(i));
+    }
+    queue.push_n(batch.begin(), batch.size());
+    BOOST_CHECK_EQUAL(queue.size(), batch.size());
+    for (std::size_t i = 0; i < batch.size(); ++i) {
+        auto item = queue.try_pop();
+        BOOST_CHECK(item);
+        BOOST_CHECK(item.get() == gen(i));
+    }
+
+    std::atomic<std::size_t> counter(0);
+    std::vector<std::thread> producers, consumers;
+
+    for (std::size_t p = 0; p < nb_producers; ++p) {
+        producers.emplace_back([&, p]() {
+            for (std::size_t i = 0; i < nb_items_per_producer; ++i) {
+                queue.push(gen(p * nb_items_per_producer + i));
+            }
+        });
+    }
+
+    for (std::size_t c = 0; c < nb_consumers; ++c) {
+        consumers.emplace_back([&]() {
+            while (counter.load() < nb_items) {
+                auto item = queue.try_pop(std::chrono::milliseconds(1));
+                if (item) {
+                    counter += 1;
+                }
+            }
+        });
+    }
+
+    for (auto& t : producers) {
+        t.join();
+    }
+
+    for (auto& t : consumers) {
+        t.join();
+    }
+
+    BOOST_CHECK_EQUAL(counter.load(), nb_items);
+    BOOST_CHECK_EQUAL(queue.empty(), true);
+}
+
+
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(concurrent_queue_spsc_test, T, small_vector_types) {
+
+    using namespace hadoken;
+
+    constexpr std::size_t nb_items = 20000;
+    constexpr std::size_t batch_size = 37;
+
+    content_generator<T> gen;
+
+    concurrent_queue_spsc<T> queue(100);
+
+    BOOST_CHECK_EQUAL(queue.capacity(), 128);
+    BOOST_CHECK_EQUAL(queue.size(), 0);
+    BOOST_CHECK_EQUAL(queue.empty(), true);
+    BOOST_CHECK(!queue.try_pop());
+    BOOST_CHECK(!queue.try_pop(std::chrono::microseconds(100)));
+
+    std::vector<T> items, result_items;
+    for (std::size_t i = 0; i < nb_items; ++i) {
+        items.emplace_back(gen(i));
+    }
+
+    // batch push over the capacity is partial
+    std::vector<T> batch(items.begin(), items.begin() + 200);
+    BOOST_CHECK_EQUAL(queue.push_n(batch.begin(), batch.size()), 128);
+    T extra_item = gen(0);
+    BOOST_CHECK(queue.try_push(std::move(extra_item)) == false);
+
+    std::vector<T> popped(200);
+    BOOST_CHECK_EQUAL(queue.pop_n(popped.begin(), popped.size()), 128);
+    BOOST_CHECK(std::equal(popped.begin(), popped.begin() + 128, items.begin()));
+    BOOST_CHECK_EQUAL(queue.empty(), true);
+
+    // one producer with mixed single / batch push, one consumer with mixed single / batch pop
+    std::thread producer([&]() {
+        std::size_t pos = 0;
+        while (pos < nb_items) {
+            std::size_t n = 0;
+            if (pos % 2 == 0) {
+                std::vector<T> local_batch(items.begin() + pos, items.begin() + std::min(pos + batch_size, nb_items));
+                n = queue.push_n(local_batch.begin(), local_batch.size());
+                pos += n;
+            }
+
+            if (n == 0) {
+                queue.push(items[pos]);
+                pos += 1;
+            }
+        }
+    });
+
+    while (result_items.size() < nb_items) {
+        std::size_t n = 0;
+        if (result_items.size() % 3 == 0) {
+            std::vector<T> local_batch(batch_size);
+            n = queue.pop_n(local_batch.begin(), local_batch.size());
+            result_items.insert(result_items.end(), local_batch.begin(), local_batch.begin() + n);
+        }
+
+        if (n == 0) {
+            auto item = queue.try_pop(std::chrono::milliseconds(1));
+            if (item) {
+                result_items.push_back(item.get());
+            }
+        }
+    }
+
+    producer.join();
+
+    BOOST_CHECK(items == result_items);
+    BOOST_CHECK_EQUAL(queue.empty(), true);
 }
@@ -0,0 +1,157 @@
+/**
+ * Copyright (c) 2018, Adrien Devresse <adrien.devresse@epfl.ch>
+ *
+ * Boost Software License - Version 1.0
+ *
+ * Permission is hereby granted, free of charge, to any person or organization
+ * obtaining a copy of the software and accompanying documentation covered by
+ * this license (the "Software") to use, reproduce, display, distribute,
+ * execute, and transmit the Software, and to prepare derivative works of the
+ * Software, and to permit third-parties to whom the Software is furnished to
+ * do so, all subject to the following:
+ *
+ * The copyright notices in the Software and this entire statement, including
+ * the above license grant, this restriction and the following disclaimer,
+ * must be included in all copies of the Software, in whole or in part, and
+ * all derivative works of the Software, unless such copies or derivative
+ * works are solely in the form of machine-executable object code generated by
+ * a source language processor.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+ * SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+ * FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+
+#define BOOST_TEST_MODULE coroutineTests
+#define BOOST_TEST_MAIN
+
+#include <atomic>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include <boost/test/unit_test.hpp>
+
+#include <hadoken/executor/coroutine.hpp>
+#include <hadoken/executor/thread_pool_executor.hpp>
+
+
+#ifdef HADOKEN_HAS_COROUTINES
+
+using namespace hadoken;
+
+
+task<std::thread::id> current_thread_on(thread_pool_executor& pool) {
+    co_await schedule_on(pool);
+    co_return std::this_thread::get_id();
+}
+
+task<int> add(int a, int b) { co_return a + b; }
+
+task<int> failing() {
+    throw std::runtime_error("coroutine failure");
+    co_return 0;
+}
+
+task<int> sum_on(thread_pool_executor& pool, int n) {
+    co_await schedule_on(pool);
+
+    int res = 0;
+    for (int i = 0; i < n; ++i) {
+        res += co_await add(i, 0);
+    }
+    co_return res;
+}
+
+task<int> allocated_add(frame_allocator&, int a, int b) { co_return a + b; }
+
+
+BOOST_AUTO_TEST_CASE(coroutine_schedule_on) {
+    thread_pool_executor pool(2);
+
+    const std::thread::id worker_id = sync_wait(current_thread_on(pool));
+    BOOST_CHECK(worker_id != std::this_thread::get_id());
+
+    BOOST_CHECK_EQUAL(sync_wait(sum_on(pool, 100)), 4950);
+}
+
+
+BOOST_AUTO_TEST_CASE(coroutine_task_result) {
+    BOOST_CHECK_EQUAL(sync_wait(add(40, 2)), 42);
+    BOOST_CHECK_THROW(sync_wait(failing()), std::runtime_error);
+
+    // lazy: nothing is executed before the first co_await
+    std::atomic<int> counter(0);
+    auto increment = [&counter]() -> task<void> {
+        counter += 1;
+        co_return;
+    };
+
+    task<void> t = increment();
+    BOOST_CHECK(t.valid());
+    BOOST_CHECK_EQUAL(counter.load(), 0);
+    sync_wait(std::move(t));
+    BOOST_CHECK_EQUAL(counter.load(), 1);
+}
+
+
+BOOST_AUTO_TEST_CASE(coroutine_resume_on) {
+    thread_pool_executor pool(2);
+
+    // the awaiting coroutine is resumed by a worker of the pool
+    auto resumed_thread = [&pool]() -> task<std::thread::id> {
+        const int value = co_await add(1, 2).resume_on(pool);
+        if (value != 3) {
+            throw std::logic_error("unexpected result");
+        }
+        co_return std::this_thread::get_id();
+    };
+    BOOST_CHECK(sync_wait(resumed_thread()) != std::this_thread::get_id());
+
+    // coroutines moving back and forth between the pool and the awaiting coroutine
+    auto fan_out = [&pool]() -> task<int> {
+        std::vector<task<int>> children;
+        for (int i = 0; i < 256; ++i) {
+            children.push_back(sum_on(pool, i));
+        }
+
+        int res = 0;
+        for (auto& child : children) {
+            res += co_await child;
+        }
+        co_return res;
+    };
+
+    int expected = 0;
+    for (int i = 0; i < 256; ++i) {
+        expected += i * (i - 1) / 2;
+    }
+    BOOST_CHECK_EQUAL(sync_wait(fan_out()), expected);
+}
+
+
+BOOST_AUTO_TEST_CASE(coroutine_frame_allocator) {
+    frame_allocator allocator;
+    BOOST_CHECK_EQUAL(allocator.cached_frames(), 0);
+
+    BOOST_CHECK_EQUAL(sync_wait(allocated_add(allocator, 1, 2)), 3);
+    BOOST_CHECK_EQUAL(allocator.cached_frames(), 1);
+
+    // the released frame is reused
+    for (int i = 0; i < 16; ++i) {
+        BOOST_CHECK_EQUAL(sync_wait(allocated_add(allocator, i, i)), 2 * i);
+    }
+    BOOST_CHECK_EQUAL(allocator.cached_frames(), 1);
+}
+
+#else
+
+BOOST_AUTO_TEST_CASE(coroutine_not_supported) { BOOST_TEST_MESSAGE("coroutines not supported by the compiler"); }
+
+#endif
@@ -31,6 +31,7 @@
 #define BOOST_TEST_MAIN
 
 #include <algorithm>
+#include <array>
 #include <future>
 #include <iostream>
 #include <numeric>
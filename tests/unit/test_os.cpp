@@ -40,6 +40,7 @@
 
 #include <hadoken/os/env.hpp>
 #include <hadoken/os/hostname.hpp>
+#include <hadoken/os/topology.hpp>
 
 #include "test_helpers.hpp"
 
@@ -66,3 +67,30 @@ BOOST_AUTO_TEST_CASE(getenv_check_simple) {
     hadoken::optional<std::string> unexisting = hadoken::get_env("BLOUBLOUBLOUBLOUBLOU_TOTALLY_EXISTING");
     BOOST_CHECK(!unexisting);
 }
+
+
+
+BOOST_AUTO_TEST_CASE(topology_check_simple) {
+
+    const std::vector<std::size_t> expected = {0, 1, 2, 3, 8, 10, 11};
+    const std::vector<std::size_t> parsed = hadoken::parse_cpu_list("8,0-3,10-11\n");
+    BOOST_CHECK_EQUAL_COLLECTIONS(parsed.begin(), parsed.end(), expected.begin(), expected.end());
+    BOOST_CHECK(hadoken::parse_cpu_list("").empty());
+
+    // at least one node with one cpu, on any machine
+    const std::vector<hadoken::numa_node> nodes = hadoken::get_numa_nodes();
+    BOOST_CHECK(nodes.size() > 0);
+    for (auto& node : nodes) {
+        BOOST_CHECK(node.cpus.size() > 0);
+    }
+
+    BOOST_CHECK_EQUAL(hadoken::parse_cache_size("48K"), 48 * 1024);
+    BOOST_CHECK_EQUAL(hadoken::parse_cache_size("32M\n"), 32 * 1024 * 1024);
+    BOOST_CHECK_EQUAL(hadoken::parse_cache_size("512"), 512);
+    std::cout << "last level cache size " << hadoken::get_last_level_cache_size() << std::endl;
+
+    BOOST_CHECK(hadoken::set_thread_affinity(std::vector<std::size_t>()) == false);
+#ifdef __linux__
+    BOOST_CHECK(hadoken::set_thread_affinity(nodes.front().cpus));
+#endif
+}
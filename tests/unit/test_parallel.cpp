@@ -31,17 +31,27 @@
 #define BOOST_TEST_MAIN
 
 #include <algorithm>
+#include <atomic>
 #include <future>
 #include <iostream>
+#include <iterator>
+#include <limits>
+#include <list>
+#include <mutex>
 #include <numeric>
 #include <random>
 #include <sstream>
 #include <stdexcept>
+#include <string>
+#include <vector>
 
 #include <chrono>
+#include <cstdint>
 
+#include <boost/range/adaptor/strided.hpp>
 #include <boost/test/unit_test.hpp>
 
+#include <hadoken/executor/thread_pool_executor.hpp>
 #include <hadoken/parallel/algorithm.hpp>
 
 //#include <parallel/algorithm>
@@ -144,6 +154,385 @@ BOOST_AUTO_TEST_CASE(parallel_for_each_nested) {
 
 
 
+BOOST_AUTO_TEST_CASE(parallel_shared_exec_policy_test) {
+    auto pool = std::make_shared<thread_pool_executor>(2);
+    parallel::parallel_shared_exec_policy<thread_pool_executor> policy(pool);
+
+    BOOST_CHECK_EQUAL(policy.max_workers(), 0);
+    BOOST_CHECK_EQUAL(policy.grain_size(), 1);
+    BOOST_CHECK(policy.get_partitioner() == parallel::partitioner::automatic);
+
+    std::vector<int> values(10000);
+    std::iota(values.begin(), values.end(), 0);
+
+    // static split: one task per thread of the pool
+    policy.set_partitioner(parallel::partitioner::static_split);
+    std::atomic<std::size_t> n_ranges(0);
+    parallel::for_range(policy, values.begin(), values.end(),
+                        [&n_ranges](std::vector<int>::iterator, std::vector<int>::iterator) { n_ranges += 1; });
+    BOOST_CHECK_EQUAL(n_ranges.load(), 2);
+
+    // worker limit
+    policy.set_max_workers(5);
+    n_ranges = 0;
+    parallel::for_range(policy, values.begin(), values.end(),
+                        [&n_ranges](std::vector<int>::iterator, std::vector<int>::iterator) { n_ranges += 1; });
+    BOOST_CHECK_EQUAL(n_ranges.load(), 5);
+
+    // at least grain_size elements per task, small ranges are processed inline
+    policy.set_grain_size(4000);
+    n_ranges = 0;
+    parallel::for_range(policy, values.begin(), values.end(),
+                        [&n_ranges](std::vector<int>::iterator, std::vector<int>::iterator) { n_ranges += 1; });
+    BOOST_CHECK_EQUAL(n_ranges.load(), 2);
+
+    std::thread::id executor_id;
+    parallel::for_range(policy, values.begin(), values.begin() + 100,
+                        [&executor_id](std::vector<int>::iterator, std::vector<int>::iterator) {
+                            executor_id = std::this_thread::get_id();
+                        });
+    BOOST_CHECK(executor_id == std::this_thread::get_id());
+
+    // algorithms executed on the pool of the policy
+    policy.set_grain_size(1).set_max_workers(0).set_partitioner(parallel::partitioner::automatic);
+
+    parallel::for_each(policy, values.begin(), values.end(), [](int& v) { v *= 2; });
+    BOOST_CHECK_EQUAL(values[4999], 9998);
+
+    BOOST_CHECK_EQUAL(parallel::count_if(policy, values.begin(), values.end(), [](int v) { return v % 4 == 0; }), 5000);
+    BOOST_CHECK(parallel::all_of(policy, values.begin(), values.end(), [](int v) { return v % 2 == 0; }));
+    BOOST_CHECK(parallel::any_of(policy, values.begin(), values.end(), [](int v) { return v == 19998; }));
+    BOOST_CHECK(parallel::none_of(policy, values.begin(), values.end(), [](int v) { return v < 0; }));
+
+    parallel::fill(policy, values.begin(), values.end(), 1);
+    std::vector<int> scanned(values.size());
+    parallel::inclusive_scan(policy, values.begin(), values.end(), scanned.begin());
+    BOOST_CHECK_EQUAL(scanned.back(), 10000);
+
+    // exceptions are forwarded to the caller
+    BOOST_CHECK_THROW(parallel::for_each(policy, values.begin(), values.end(),
+                                         [](int& v) {
+                                             if (v == 1) {
+                                                 throw std::runtime_error("for_each failure");
+                                             }
+                                         }),
+                      std::runtime_error);
+
+    pool->wait_idle();
+    BOOST_CHECK_EQUAL(pool->pending_tasks(), 0);
+}
+
+
+
+BOOST_AUTO_TEST_CASE(parallel_partitioner_test) {
+    auto pool = std::make_shared<thread_pool_executor>(4);
+    parallel::parallel_shared_exec_policy<thread_pool_executor> policy(pool);
+
+    const std::size_t n_elems = 10000;
+    std::vector<int> values(n_elems);
+    std::iota(values.begin(), values.end(), 0);
+
+    const parallel::partitioner modes[] = {parallel::partitioner::static_split, parallel::partitioner::dynamic,
+                                           parallel::partitioner::guided, parallel::partitioner::automatic};
+
+    for (parallel::partitioner mode : modes) {
+        policy.set_partitioner(mode).set_grain_size(100);
+
+        std::vector<std::atomic<int>> visited(n_elems);
+        for (auto& v : visited) {
+            v = 0;
+        }
+
+        std::mutex chunks_lock;
+        std::vector<std::size_t> chunks;
+
+        parallel::for_range(policy, values.begin(), values.end(),
+                            [&](std::vector<int>::iterator first, std::vector<int>::iterator last) {
+                                for (auto it = first; it != last; ++it) {
+                                    visited[std::size_t(*it)] += 1;
+                                }
+                                std::lock_guard<std::mutex> l(chunks_lock);
+                                chunks.push_back(std::size_t(std::distance(first, last)));
+                            });
+
+        // every element exactly once
+        BOOST_CHECK(std::all_of(visited.begin(), visited.end(), [](const std::atomic<int>& v) { return v.load() == 1; }));
+        BOOST_CHECK_EQUAL(std::accumulate(chunks.begin(), chunks.end(), std::size_t(0)), n_elems);
+
+        // at least grain_size elements per chunk, except for the tail of the range
+        std::sort(chunks.begin(), chunks.end());
+        BOOST_CHECK(chunks.size() < 2 || chunks[1] >= 100);
+
+        switch (mode) {
+        case parallel::partitioner::static_split:
+            BOOST_CHECK_EQUAL(chunks.size(), 4);
+            break;
+        case parallel::partitioner::dynamic:
+            BOOST_CHECK_EQUAL(chunks.size(), n_elems / 100);
+            break;
+        case parallel::partitioner::guided:
+            // decreasing chunks: first one of ( n_elems / ( 2 * n_tasks ) )
+            BOOST_CHECK_EQUAL(chunks.back(), n_elems / 8);
+            BOOST_CHECK(chunks.size() > 4 && chunks.size() < n_elems / 100);
+            break;
+        case parallel::partitioner::automatic:
+            BOOST_CHECK_EQUAL(chunks.size(), 33);
+            break;
+        }
+    }
+
+    // skewed workload: algorithms inherit the partitioner
+    policy.set_partitioner(parallel::partitioner::guided).set_grain_size(1);
+    BOOST_CHECK_EQUAL(parallel::count_if(policy, values.begin(), values.end(), [](int v) { return v % 3 == 0; }), 3334);
+
+    parallel::for_each(policy, values.begin(), values.end(), [](int& v) {
+        int x = v;
+        for (int i = 0; i < v / 100; ++i) {
+            x = (x * 7 + 1) % 1000003;
+        }
+        v = (x >= 0) ? (v + 1) : (v);
+    });
+    BOOST_CHECK_EQUAL(values.front(), 1);
+    BOOST_CHECK_EQUAL(values.back(), int(n_elems));
+}
+
+
+
+BOOST_AUTO_TEST_CASE(parallel_reduce_test) {
+    auto pool = std::make_shared<thread_pool_executor>(4);
+    parallel::parallel_shared_exec_policy<thread_pool_executor> policy(pool);
+
+    const std::size_t n = 100000;
+    std::vector<int> values(n);
+    std::iota(values.begin(), values.end(), 1);
+
+    const long long expected_sum = (long long)(n) * (n + 1) / 2;
+
+    BOOST_CHECK_EQUAL(parallel::reduce(parallel::seq, values.begin(), values.end(), 0LL), expected_sum);
+    BOOST_CHECK_EQUAL(parallel::reduce(parallel::par, values.begin(), values.end(), 0LL), expected_sum);
+    BOOST_CHECK_EQUAL(parallel::reduce(policy, values.begin(), values.end(), 0LL), expected_sum);
+    BOOST_CHECK_EQUAL(parallel::reduce(policy, values.begin(), values.begin() + 10), 55);
+    BOOST_CHECK_EQUAL(parallel::reduce(policy, values.begin(), values.begin(), 42), 42);
+    BOOST_CHECK_EQUAL(parallel::reduce(policy, values.begin(), values.end(), 0,
+                                       [](int a, int b) { return std::max(a, b); }),
+                      int(n));
+
+    // floating point sums are reproducible for a given number of workers
+    std::vector<double> reals(n);
+    std::mt19937 mt;
+    std::uniform_real_distribution<double> dist(-1e10, 1e10);
+    std::generate(reals.begin(), reals.end(), [&]() { return dist(mt); });
+
+    const double sum1 = parallel::reduce(policy, reals.begin(), reals.end(), 0.0);
+    for (int i = 0; i < 10; ++i) {
+        BOOST_CHECK_EQUAL(parallel::reduce(policy, reals.begin(), reals.end(), 0.0), sum1);
+    }
+
+    // transform_reduce
+    std::vector<double> a(n, 2.0), b(n, 0.5);
+    BOOST_CHECK_CLOSE(parallel::transform_reduce(policy, a.begin(), a.end(), b.begin(), 0.0), double(n), 1e-9);
+    BOOST_CHECK_EQUAL(parallel::transform_reduce(policy, values.begin(), values.end(), values.begin(), 0LL,
+                                                 std::plus<long long>(), [](int x, int y) { return (long long)(x - y); }),
+                      0);
+    BOOST_CHECK_EQUAL(parallel::transform_reduce(policy, values.begin(), values.end(), 0LL, std::plus<long long>(),
+                                                 [](int x) { return (long long)(x % 2); }),
+                      (long long)(n / 2));
+
+    // forward iterators
+    std::list<int> l(values.begin(), values.begin() + 1000);
+    BOOST_CHECK_EQUAL(parallel::reduce(policy, l.begin(), l.end(), 0), 500500);
+}
+
+
+BOOST_AUTO_TEST_CASE(parallel_transform_scan_test) {
+    auto pool = std::make_shared<thread_pool_executor>(4);
+    parallel::parallel_shared_exec_policy<thread_pool_executor> policy(pool);
+
+    const std::size_t n = 100000;
+    std::vector<long long> values(n);
+    std::iota(values.begin(), values.end(), 0);
+
+    auto square = [](long long v) { return v * v; };
+
+    std::vector<long long> expected(n);
+    long long acc = 0;
+    for (std::size_t i = 0; i < n; ++i) {
+        acc += square(values[i]);
+        expected[i] = acc;
+    }
+
+    std::vector<long long> res(n);
+    auto res_end = parallel::transform_inclusive_scan(policy, values.begin(), values.end(), res.begin(),
+                                                      std::plus<long long>(), square);
+    BOOST_CHECK(res_end == res.end());
+    BOOST_CHECK(res == expected);
+
+    // initial value
+    parallel::transform_inclusive_scan(policy, values.begin(), values.end(), res.begin(), std::plus<long long>(), square,
+                                       10LL);
+    BOOST_CHECK_EQUAL(res.front(), 10);
+    BOOST_CHECK_EQUAL(res.back(), expected.back() + 10);
+
+    // exclusive
+    parallel::transform_exclusive_scan(policy, values.begin(), values.end(), res.begin(), 0LL, std::plus<long long>(),
+                                       square);
+    BOOST_CHECK_EQUAL(res.front(), 0);
+    BOOST_CHECK(std::equal(res.begin() + 1, res.end(), expected.begin()));
+
+    // in place, sequential policy
+    std::vector<long long> in_place(values);
+    parallel::transform_exclusive_scan(policy, in_place.begin(), in_place.end(), in_place.begin(), 0LL,
+                                       std::plus<long long>(), square);
+    BOOST_CHECK(in_place == res);
+
+    parallel::transform_inclusive_scan(parallel::seq, values.begin(), values.end(), res.begin(), std::plus<long long>(),
+                                       square);
+    BOOST_CHECK(res == expected);
+}
+
+
+
+BOOST_AUTO_TEST_CASE(parallel_find_test) {
+    auto pool = std::make_shared<thread_pool_executor>(4);
+    parallel::parallel_shared_exec_policy<thread_pool_executor> policy(pool);
+
+    const std::size_t n = 1000000;
+    std::vector<int> values(n);
+    std::iota(values.begin(), values.end(), 0);
+
+    // leftmost match
+    BOOST_CHECK(parallel::find(policy, values.begin(), values.end(), 654321) == values.begin() + 654321);
+    BOOST_CHECK(parallel::find(policy, values.begin(), values.end(), -1) == values.end());
+    BOOST_CHECK(parallel::find_if(policy, values.begin(), values.end(), [](int v) { return v % 1000 == 999; }) ==
+                values.begin() + 999);
+    BOOST_CHECK(parallel::find_if_not(policy, values.begin(), values.end(), [](int v) { return v < 500000; }) ==
+                values.begin() + 500000);
+    BOOST_CHECK(parallel::find_if(parallel::seq, values.begin(), values.end(), [](int v) { return v > 10; }) ==
+                values.begin() + 11);
+
+    std::vector<int> needles = {700000, 300000, 900000};
+    BOOST_CHECK(parallel::find_first_of(policy, values.begin(), values.end(), needles.begin(), needles.end()) ==
+                values.begin() + 300000);
+
+    // adjacent_find, including a pair crossing two search blocks
+    std::vector<int> adjacent(values);
+    adjacent[2048] = adjacent[2047];
+    adjacent[800000] = adjacent[800001];
+    BOOST_CHECK(parallel::adjacent_find(policy, adjacent.begin(), adjacent.end()) == adjacent.begin() + 2047);
+    BOOST_CHECK(parallel::adjacent_find(policy, values.begin(), values.end()) == values.end());
+    BOOST_CHECK(parallel::adjacent_find(policy, values.begin(), values.end(), [](int a, int b) { return b < a; }) ==
+                values.end());
+
+    // mismatch
+    auto mis = parallel::mismatch(policy, values.begin(), values.end(), adjacent.begin());
+    BOOST_CHECK(mis.first == values.begin() + 2048);
+    BOOST_CHECK(mis.second == adjacent.begin() + 2048);
+
+    auto shorter = parallel::mismatch(policy, values.begin(), values.end(), values.begin(), values.begin() + 1000);
+    BOOST_CHECK(shorter.first == values.begin() + 1000);
+
+    // single pass input iterators are only read once
+    std::istringstream stream1("1 2 3 4"), stream2("1 2 9 4");
+    auto input_mis = parallel::mismatch(policy, std::istream_iterator<int>(stream1), std::istream_iterator<int>(),
+                                        std::istream_iterator<int>(stream2));
+    BOOST_CHECK(input_mis.first != std::istream_iterator<int>());
+    BOOST_CHECK_EQUAL(*input_mis.first, 3);
+    BOOST_CHECK_EQUAL(*input_mis.second, 9);
+
+    std::list<int> adjacent_list = {1, 2, 3, 3, 4};
+    BOOST_CHECK(parallel::adjacent_find(policy, adjacent_list.begin(), adjacent_list.end()) ==
+                std::next(adjacent_list.begin(), 2));
+
+    // early exit: a match at the beginning stops the search
+    std::atomic<std::size_t> n_calls(0);
+    BOOST_CHECK(parallel::any_of(policy, values.begin(), values.end(), [&n_calls](int v) {
+        n_calls.fetch_add(1, std::memory_order_relaxed);
+        return v == 10;
+    }));
+    BOOST_CHECK_LT(n_calls.load(), n / 10);
+
+    n_calls = 0;
+    BOOST_CHECK(parallel::find_if(policy, values.begin(), values.end(), [&n_calls](int v) {
+                    n_calls.fetch_add(1, std::memory_order_relaxed);
+                    return v >= 5000;
+                }) == values.begin() + 5000);
+    BOOST_CHECK_LT(n_calls.load(), n / 10);
+
+    // forward iterators
+    std::list<int> l(values.begin(), values.begin() + 100);
+    BOOST_CHECK(*parallel::find(policy, l.begin(), l.end(), 42) == 42);
+    BOOST_CHECK(parallel::all_of(policy, l.begin(), l.end(), [](int v) { return v < 100; }));
+}
+
+
+
+BOOST_AUTO_TEST_CASE(parallel_compaction_test) {
+    auto pool = std::make_shared<thread_pool_executor>(4);
+    parallel::parallel_shared_exec_policy<thread_pool_executor> policy(pool);
+
+    const std::size_t n = 1000000;
+    std::vector<int> values(n);
+    std::mt19937 mt;
+    std::uniform_int_distribution<int> dist(0, 1000);
+    std::generate(values.begin(), values.end(), [&]() { return dist(mt); });
+
+    auto is_small = [](int v) { return v < 300; };
+
+    // copy_if
+    std::vector<int> expected, res(n, -1);
+    std::copy_if(values.begin(), values.end(), std::back_inserter(expected), is_small);
+
+    auto res_end = parallel::copy_if(policy, values.begin(), values.end(), res.begin(), is_small);
+    BOOST_CHECK_EQUAL(std::distance(res.begin(), res_end), expected.size());
+    BOOST_CHECK(std::equal(expected.begin(), expected.end(), res.begin()));
+    BOOST_CHECK_EQUAL(res[expected.size()], -1);
+
+    std::vector<int> seq_res;
+    parallel::copy_if(parallel::seq, values.begin(), values.end(), std::back_inserter(seq_res), is_small);
+    BOOST_CHECK(seq_res == expected);
+
+    // remove_if
+    std::vector<int> removed(values);
+    auto removed_end = parallel::remove_if(policy, removed.begin(), removed.end(), is_small);
+    std::vector<int> expected_removed(values);
+    expected_removed.erase(std::remove_if(expected_removed.begin(), expected_removed.end(), is_small), expected_removed.end());
+    BOOST_CHECK_EQUAL(std::distance(removed.begin(), removed_end), expected_removed.size());
+    BOOST_CHECK(std::equal(expected_removed.begin(), expected_removed.end(), removed.begin()));
+
+    // stable_partition and partition
+    std::vector<int> partitioned(values), expected_partitioned(values);
+    auto middle = parallel::stable_partition(policy, partitioned.begin(), partitioned.end(), is_small);
+    std::stable_partition(expected_partitioned.begin(), expected_partitioned.end(), is_small);
+    BOOST_CHECK(partitioned == expected_partitioned);
+    BOOST_CHECK_EQUAL(std::distance(partitioned.begin(), middle), expected.size());
+
+    partitioned = values;
+    middle = parallel::partition(policy, partitioned.begin(), partitioned.end(), is_small);
+    BOOST_CHECK(std::is_partitioned(partitioned.begin(), partitioned.end(), is_small));
+    BOOST_CHECK(std::all_of(partitioned.begin(), middle, is_small));
+
+    // forward iterators and edge cases
+    std::list<int> l(values.begin(), values.begin() + 1000);
+    auto l_middle = parallel::partition(policy, l.begin(), l.end(), is_small);
+    BOOST_CHECK(std::all_of(l.begin(), l_middle, is_small));
+
+    std::vector<int> empty;
+    BOOST_CHECK(parallel::copy_if(policy, empty.begin(), empty.end(), res.begin(), is_small) == res.begin());
+    BOOST_CHECK(parallel::remove_if(policy, empty.begin(), empty.end(), is_small) == empty.end());
+
+    // exceptions abort the chained tiles
+    BOOST_CHECK_THROW(parallel::copy_if(policy, values.begin(), values.end(), res.begin(),
+                                        [](int v) -> bool {
+                                            if (v == 500) {
+                                                throw std::runtime_error("copy_if failure");
+                                            }
+                                            return true;
+                                        }),
+                      std::runtime_error);
+}
+
+
+
 BOOST_AUTO_TEST_CASE(parallel_fill_test) {
 
     using namespace hadoken;
@@ -278,11 +667,168 @@ BOOST_AUTO_TEST_CASE(parallel_transform_test) {
     BOOST_CHECK_EQUAL_COLLECTIONS(res.begin(), res.end(), res3.begin(), res3.end());
 
     BOOST_CHECK_EQUAL_COLLECTIONS(res2.begin(), res2.end(), res4.begin(), res4.end());
+
+    // n-ary transforms, on contiguous, forward and single pass ranges
+    auto dot3 = [](std::size_t a, std::size_t b, std::size_t c) { return a * 3 + b * 2 + c; };
+    for (std::size_t i = 0; i < n; ++i) {
+        res3[i] = dot3(v1[i], v2[i], res4[i]);
+    }
+
+    hadoken::parallel::zip_transform(hadoken::parallel::par, v1.begin(), v1.end(), res.begin(), dot3, v2.begin(), res4.begin());
+    BOOST_CHECK(res == res3);
+
+    std::fill(res.begin(), res.end(), 0);
+    hadoken::parallel::zip_transform(hadoken::parallel::par_vec, v1.begin(), v1.end(), res.begin(), dot3, v2.begin(),
+                                     res4.begin());
+    BOOST_CHECK(res == res3);
+
+    std::list<std::size_t> l1(v1.begin(), v1.end()), l_res(n);
+    auto l_end = hadoken::parallel::zip_transform(hadoken::parallel::par, l1.begin(), l1.end(), l_res.begin(), dot3, v2.begin(),
+                                                  res4.begin());
+    BOOST_CHECK(l_end == l_res.end());
+    BOOST_CHECK(std::equal(l_res.begin(), l_res.end(), res3.begin()));
+
+    std::vector<std::size_t> inserted;
+    hadoken::parallel::transform(hadoken::parallel::par, v1.begin(), v1.end(), std::back_inserter(inserted),
+                                 [](std::size_t v) { return v + 100; });
+    BOOST_CHECK(inserted == res4);
+
+    // unary transform into another type
+    std::vector<double> converted(n);
+    hadoken::parallel::transform(hadoken::parallel::par, v1.begin(), v1.end(), converted.begin(),
+                                 [](std::size_t v) { return double(v) / 2; });
+    BOOST_CHECK_EQUAL(converted[n - 1], double(v1[n - 1]) / 2);
 }
 
 
 
 
+BOOST_AUTO_TEST_CASE(parallel_vector_policy_test) {
+    using namespace hadoken::parallel::detail;
+
+    // every kernel, with every instruction set of the cpu, unaligned heads and tails
+    const __simd_isa cpu_isa = __simd_cpu_isa();
+    const std::size_t sizes[] = {1, 15, 16, 17, 63, 100, 1027};
+
+    std::vector<std::int32_t> ints(2000);
+    std::vector<float> floats(2000);
+    for (std::size_t i = 0; i < ints.size(); ++i) {
+        ints[i] = static_cast<std::int32_t>((i * 7919) % 1000) - 500;
+        floats[i] = 1.0f / float(i + 1);
+    }
+
+    for (int isa_id = 0; isa_id <= static_cast<int>(cpu_isa); ++isa_id) {
+        const __simd_isa isa = static_cast<__simd_isa>(isa_id);
+
+        for (std::size_t n : sizes) {
+            for (std::size_t offset = 0; offset < 4; ++offset) {
+                std::vector<std::int32_t> out(n + 8, -1);
+                __simd_fill(out.begin() + offset, n, 42, isa);
+                BOOST_CHECK_EQUAL(std::count(out.begin(), out.end(), 42), n);
+                BOOST_CHECK_EQUAL(out[offset + n], -1);
+
+                auto twice = [](std::int32_t v) { return 2 * v; };
+                auto sum_self = [](std::int32_t a, std::int32_t b) { return a + b; };
+                for (bool streaming : {false, true}) {
+                    __simd_transform(isa, streaming, out.begin() + offset, n, twice, ints.begin() + offset);
+                    for (std::size_t i = 0; i < n; ++i) {
+                        BOOST_CHECK_EQUAL(out[offset + i], 2 * ints[offset + i]);
+                    }
+
+                    // in place, vectorized: the output is the input
+                    std::vector<std::int32_t> in_place(ints.begin(), ints.begin() + n + 8);
+                    __simd_transform(isa, streaming, in_place.begin() + offset, n, sum_self, in_place.begin() + offset,
+                                     in_place.begin() + offset);
+                    for (std::size_t i = 0; i < n; ++i) {
+                        BOOST_CHECK_EQUAL(in_place[offset + i], 2 * ints[offset + i]);
+                    }
+                    BOOST_CHECK_EQUAL(in_place[offset + n], ints[offset + n]);
+                }
+
+                std::plus<std::int32_t> sum;
+                __simd_transform(isa, true, out.begin() + offset, n, sum, ints.begin() + offset, ints.begin() + 2 * offset);
+                for (std::size_t i = 0; i < n; ++i) {
+                    BOOST_CHECK_EQUAL(out[offset + i], ints[offset + i] + ints[2 * offset + i]);
+                }
+
+                auto fma = [](std::int32_t a, std::int32_t b, std::int32_t c) { return a * b + c; };
+                __simd_transform(isa, false, out.begin() + offset, n, fma, ints.begin() + offset, ints.begin(),
+                                 ints.begin() + 1);
+                for (std::size_t i = 0; i < n; ++i) {
+                    BOOST_CHECK_EQUAL(out[offset + i], ints[offset + i] * ints[i] + ints[1 + i]);
+                }
+
+                __simd_identity identity;
+                BOOST_CHECK_EQUAL(__simd_fold<std::int64_t>(ints.begin() + offset, n, identity, sum, isa),
+                                  std::accumulate(ints.begin() + offset, ints.begin() + offset + n, std::int64_t(0)));
+
+                // lane decomposition independent of the instruction set
+                std::plus<float> fsum;
+                BOOST_CHECK_EQUAL(__simd_fold<float>(floats.begin() + offset, n, identity, fsum, isa),
+                                  __simd_fold<float>(floats.begin() + offset, n, identity, fsum, __simd_isa::generic));
+            }
+        }
+    }
+
+    // algorithms with par_vec
+    const std::size_t n = 100003;
+    std::vector<double> values(n), res(n), expected(n);
+    std::vector<int> ints_values(n);
+    for (std::size_t i = 0; i < n; ++i) {
+        values[i] = double(i % 1000) / 8.0;
+        ints_values[i] = int(i % 17);
+    }
+
+    parallel::fill(parallel::par_vec, res.begin(), res.end(), 3.0);
+    BOOST_CHECK_EQUAL(std::count(res.begin(), res.end(), 3.0), n);
+
+    auto affine = [](double v) { return 0.5 * v + 1.0; };
+    parallel::transform(parallel::par_vec, values.begin(), values.end(), res.begin(), affine);
+    std::transform(values.begin(), values.end(), expected.begin(), affine);
+    BOOST_CHECK(res == expected);
+
+    parallel::transform(parallel::par_vec, values.begin(), values.end(), res.begin(), res.begin(), std::plus<double>());
+    std::transform(values.begin(), values.end(), expected.begin(), expected.begin(), std::plus<double>());
+    BOOST_CHECK(res == expected);
+
+    // in place and overlapping ranges, in place transforms are vectorized
+    parallel::transform(parallel::par_vec, res.begin(), res.end(), res.begin(), affine);
+    std::transform(expected.begin(), expected.end(), expected.begin(), affine);
+    BOOST_CHECK(res == expected);
+
+    BOOST_CHECK(__simd_partial_overlap(res.data(), res.data(), n) == false);
+    BOOST_CHECK(__simd_partial_overlap(res.data() + 1, res.data(), n));
+    BOOST_CHECK(__simd_partial_overlap(reinterpret_cast<const float*>(res.data()), res.data(), n));
+
+    __simd_transform(__simd_cpu_isa(), false, res.begin(), n - 1, affine, res.begin() + 1);
+    std::transform(expected.begin() + 1, expected.end(), expected.begin(), affine);
+    BOOST_CHECK(res == expected);
+
+    BOOST_CHECK_EQUAL(parallel::count(parallel::par_vec, ints_values.begin(), ints_values.end(), 3),
+                      std::count(ints_values.begin(), ints_values.end(), 3));
+    BOOST_CHECK_EQUAL(parallel::count_if(parallel::par_vec, ints_values.begin(), ints_values.end(), [](int v) { return v > 10; }),
+                      std::count_if(ints_values.begin(), ints_values.end(), [](int v) { return v > 10; }));
+
+    BOOST_CHECK_EQUAL(parallel::reduce(parallel::par_vec, ints_values.begin(), ints_values.end(), std::int64_t(5)),
+                      std::accumulate(ints_values.begin(), ints_values.end(), std::int64_t(5)));
+
+    // sums of multiples of 1/8 below 2^53 are exact in any order
+    BOOST_CHECK_EQUAL(parallel::reduce(parallel::par_vec, values.begin(), values.end()),
+                      std::accumulate(values.begin(), values.end(), 0.0));
+
+    std::vector<std::int64_t> scanned(n), expected_scan(n);
+    parallel::inclusive_scan(parallel::par_vec, ints_values.begin(), ints_values.end(), scanned.begin());
+    std::partial_sum(ints_values.begin(), ints_values.end(), expected_scan.begin());
+    BOOST_CHECK(scanned == expected_scan);
+
+    // ranges without contiguous storage
+    std::list<int> l(ints_values.begin(), ints_values.begin() + 1000);
+    parallel::fill(parallel::par_vec, l.begin(), l.end(), 2);
+    BOOST_CHECK_EQUAL(parallel::reduce(parallel::par_vec, l.begin(), l.end()), 2000);
+}
+
+
+
 BOOST_AUTO_TEST_CASE(parallel_all_of_test) {
 
     using namespace hadoken;
@@ -563,6 +1109,331 @@ BOOST_AUTO_TEST_CASE(parallel_sort) {
 }
 
 
+// movable only, without default constructor
+struct sort_key {
+    explicit sort_key(int v) : value(v) {}
+    sort_key(sort_key&&) = default;
+    sort_key& operator=(sort_key&&) = default;
+
+    bool operator<(const sort_key& other) const { return value < other.value; }
+
+    int value;
+};
+
+
+BOOST_AUTO_TEST_CASE(parallel_sort_shared_policy) {
+
+    using namespace hadoken;
+
+    auto pool = std::make_shared<thread_pool_executor>(4);
+    parallel::parallel_shared_exec_policy<thread_pool_executor> policy(pool);
+
+    const std::size_t n = 200000;
+
+    std::mt19937_64 mt;
+    std::uniform_int_distribution<int> dist;
+
+    std::vector<int> values(n);
+    std::generate(values.begin(), values.end(), [&]() { return dist(mt); });
+
+    // sample sort
+    {
+        auto v1 = values, ref = values;
+        parallel::sort(policy, v1.begin(), v1.end());
+        std::sort(ref.begin(), ref.end());
+        BOOST_CHECK(v1 == ref);
+    }
+
+    // comparator
+    {
+        auto v2 = values, ref = values;
+        parallel::sort(policy, v2.begin(), v2.end(), std::greater<int>());
+        std::sort(ref.begin(), ref.end(), std::greater<int>());
+        BOOST_CHECK(v2 == ref);
+    }
+
+    // heavily duplicated keys
+    {
+        std::vector<int> v3(n);
+        std::generate(v3.begin(), v3.end(), [&]() { return dist(mt) % 5; });
+        auto ref = v3;
+        parallel::sort(policy, v3.begin(), v3.end());
+        std::sort(ref.begin(), ref.end());
+        BOOST_CHECK(v3 == ref);
+
+        std::vector<int> constant(n, 42);
+        parallel::sort(policy, constant.begin(), constant.end());
+        BOOST_CHECK(std::all_of(constant.begin(), constant.end(), [](int v) { return v == 42; }));
+    }
+
+    // types without default constructor: merge sort through a buffer of moved values
+    {
+        std::vector<sort_key> keys;
+        keys.reserve(n);
+        for (int v : values) {
+            keys.emplace_back(v % 100000);
+        }
+        parallel::sort(policy, keys.begin(), keys.end());
+        BOOST_CHECK(std::is_sorted(keys.begin(), keys.end()));
+        BOOST_CHECK_EQUAL(keys.size(), n);
+    }
+
+    // small ranges are sorted inline
+    {
+        std::vector<int> small(values.begin(), values.begin() + 100);
+        parallel::sort(policy, small.begin(), small.end());
+        BOOST_CHECK(is_ordered(small));
+    }
+}
+
+
+BOOST_AUTO_TEST_CASE(parallel_merge_test) {
+
+    using namespace hadoken;
+
+    auto pool = std::make_shared<thread_pool_executor>(4);
+    parallel::parallel_shared_exec_policy<thread_pool_executor> policy(pool);
+
+    std::mt19937 mt;
+    std::uniform_int_distribution<int> dist(0, 5000);
+
+    // sorted inputs of different sizes, with many duplicated keys
+    std::vector<int> a(300000), b(170000);
+    std::generate(a.begin(), a.end(), [&]() { return dist(mt); });
+    std::generate(b.begin(), b.end(), [&]() { return dist(mt) / 2; });
+    std::sort(a.begin(), a.end());
+    std::sort(b.begin(), b.end());
+
+    // merge is stable: equal keys of a come first
+    {
+        using keyed = std::pair<int, int>;
+        auto key_less = [](const keyed& x, const keyed& y) { return x.first < y.first; };
+
+        std::vector<keyed> ka, kb, res(a.size() + b.size()), ref;
+        for (int v : a) {
+            ka.emplace_back(v, 0);
+        }
+        for (int v : b) {
+            kb.emplace_back(v, 1);
+        }
+        std::merge(ka.begin(), ka.end(), kb.begin(), kb.end(), std::back_inserter(ref), key_less);
+
+        auto res_end = parallel::merge(policy, ka.begin(), ka.end(), kb.begin(), kb.end(), res.begin(), key_less);
+        BOOST_CHECK(res_end == res.end());
+        BOOST_CHECK(res == ref);
+    }
+
+    // inplace_merge
+    {
+        std::vector<int> v(a), ref;
+        v.insert(v.end(), b.begin(), b.end());
+        ref = v;
+        parallel::inplace_merge(policy, v.begin(), v.begin() + a.size(), v.end());
+        std::inplace_merge(ref.begin(), ref.begin() + a.size(), ref.end());
+        BOOST_CHECK(v == ref);
+    }
+
+    // set operations, on multisets
+    {
+        std::vector<int> res(a.size() + b.size()), ref;
+
+        std::set_union(a.begin(), a.end(), b.begin(), b.end(), std::back_inserter(ref));
+        auto res_end = parallel::set_union(policy, a.begin(), a.end(), b.begin(), b.end(), res.begin());
+        BOOST_CHECK_EQUAL(std::distance(res.begin(), res_end), ref.size());
+        BOOST_CHECK(std::equal(ref.begin(), ref.end(), res.begin()));
+
+        ref.clear();
+        std::set_intersection(a.begin(), a.end(), b.begin(), b.end(), std::back_inserter(ref));
+        res_end = parallel::set_intersection(policy, a.begin(), a.end(), b.begin(), b.end(), res.begin());
+        BOOST_CHECK_EQUAL(std::distance(res.begin(), res_end), ref.size());
+        BOOST_CHECK(std::equal(ref.begin(), ref.end(), res.begin()));
+
+        ref.clear();
+        std::set_difference(a.begin(), a.end(), b.begin(), b.end(), std::back_inserter(ref));
+        res_end = parallel::set_difference(policy, a.begin(), a.end(), b.begin(), b.end(), res.begin());
+        BOOST_CHECK_EQUAL(std::distance(res.begin(), res_end), ref.size());
+        BOOST_CHECK(std::equal(ref.begin(), ref.end(), res.begin()));
+
+        // a single key repeated over many tiles
+        std::vector<int> constant(100000, 7), ones(50000, 7);
+        res_end = parallel::set_difference(policy, constant.begin(), constant.end(), ones.begin(), ones.end(), res.begin());
+        BOOST_CHECK_EQUAL(std::distance(res.begin(), res_end), 50000);
+    }
+
+    // sequential fallbacks and empty ranges
+    {
+        std::list<int> la(a.begin(), a.begin() + 1000), lb(b.begin(), b.begin() + 1000);
+        std::vector<int> res, ref;
+        parallel::merge(policy, la.begin(), la.end(), lb.begin(), lb.end(), std::back_inserter(res));
+        std::merge(la.begin(), la.end(), lb.begin(), lb.end(), std::back_inserter(ref));
+        BOOST_CHECK(res == ref);
+
+        parallel::inplace_merge(policy, la.begin(), la.end(), la.end());
+        BOOST_CHECK(std::is_sorted(la.begin(), la.end()));
+
+        std::vector<int> empty, out(a.size());
+        BOOST_CHECK(parallel::merge(policy, empty.begin(), empty.end(), a.begin(), a.end(), out.begin()) == out.end());
+        BOOST_CHECK(out == a);
+        BOOST_CHECK(parallel::set_union(policy, empty.begin(), empty.end(), empty.begin(), empty.end(), out.begin()) ==
+                    out.begin());
+        BOOST_CHECK(parallel::set_intersection(parallel::seq, a.begin(), a.end(), empty.begin(), empty.end(), out.begin()) ==
+                    out.begin());
+    }
+
+    // stable_sort
+    {
+        using keyed = std::pair<int, int>;
+        auto key_less = [](const keyed& x, const keyed& y) { return x.first < y.first; };
+
+        std::vector<keyed> v(200000);
+        for (std::size_t i = 0; i < v.size(); ++i) {
+            v[i] = keyed(dist(mt) % 100, static_cast<int>(i));
+        }
+        auto ref = v;
+        parallel::stable_sort(policy, v.begin(), v.end(), key_less);
+        std::stable_sort(ref.begin(), ref.end(), key_less);
+        BOOST_CHECK(v == ref);
+
+        std::vector<int> values(100000);
+        std::generate(values.begin(), values.end(), [&]() { return dist(mt); });
+        parallel::stable_sort(parallel::par, values.begin(), values.end());
+        BOOST_CHECK(std::is_sorted(values.begin(), values.end()));
+    }
+}
+
+
+struct string_key {
+    explicit string_key(std::string v) : value(std::move(v)) {}
+
+    std::string value;
+};
+
+
+// comparators taking their arguments by value copy the elements, they must never get rvalues of the merged ranges
+BOOST_AUTO_TEST_CASE(parallel_merge_by_value_comparator) {
+
+    using namespace hadoken;
+
+    auto pool = std::make_shared<thread_pool_executor>(4);
+    parallel::parallel_shared_exec_policy<thread_pool_executor> policy(pool, 4);
+
+    auto by_value_less = [](std::string a, std::string b) { return a < b; };
+
+    std::mt19937 mt;
+    std::uniform_int_distribution<int> dist(0, 100000);
+
+    std::vector<std::string> values(50000);
+    std::generate(values.begin(), values.end(), [&]() { return std::to_string(dist(mt)); });
+
+    {
+        auto v = values, ref = values;
+        parallel::stable_sort(policy, v.begin(), v.end(), by_value_less);
+        std::stable_sort(ref.begin(), ref.end());
+        BOOST_CHECK(v == ref);
+    }
+
+    {
+        auto v = values, ref = values;
+        const std::size_t middle = 20000;
+        std::sort(v.begin(), v.begin() + middle);
+        std::sort(v.begin() + middle, v.end());
+        parallel::inplace_merge(policy, v.begin(), v.begin() + middle, v.end(), by_value_less);
+        std::sort(ref.begin(), ref.end());
+        BOOST_CHECK(v == ref);
+    }
+
+    // merge sort of types without default constructor
+    {
+        std::vector<string_key> keys, ref;
+        for (const std::string& s : values) {
+            keys.emplace_back(s);
+            ref.emplace_back(s);
+        }
+        parallel::sort(policy, keys.begin(), keys.end(), [](string_key a, string_key b) { return a.value < b.value; });
+        std::sort(ref.begin(), ref.end(), [](const string_key& a, const string_key& b) { return a.value < b.value; });
+        BOOST_CHECK(std::equal(keys.begin(), keys.end(), ref.begin(),
+                               [](const string_key& a, const string_key& b) { return a.value == b.value; }));
+    }
+}
+
+
+BOOST_AUTO_TEST_CASE(parallel_radix_sort) {
+
+    using namespace hadoken;
+
+    auto pool = std::make_shared<thread_pool_executor>(4);
+    parallel::parallel_shared_exec_policy<thread_pool_executor> policy(pool);
+
+    const std::size_t n = 200000;
+    std::mt19937_64 mt;
+
+    {
+        std::vector<std::uint64_t> values(n);
+        std::generate(values.begin(), values.end(), [&]() { return mt(); });
+        auto ref = values, seq = values;
+
+        parallel::radix_sort(policy, values.begin(), values.end());
+        parallel::radix_sort(parallel::seq, seq.begin(), seq.end());
+        std::sort(ref.begin(), ref.end());
+        BOOST_CHECK(values == ref);
+        BOOST_CHECK(seq == ref);
+    }
+
+    // small ids: the passes on the constant high digits are skipped
+    {
+        std::vector<std::uint32_t> values(n);
+        std::generate(values.begin(), values.end(), [&]() { return std::uint32_t(mt() % 1000); });
+        auto ref = values;
+
+        parallel::radix_sort(policy, values.begin(), values.end());
+        std::sort(ref.begin(), ref.end());
+        BOOST_CHECK(values == ref);
+    }
+
+    // signed and floating point keys
+    {
+        std::uniform_int_distribution<int> dist(-1000000, 1000000);
+        std::vector<int> ints(n);
+        std::generate(ints.begin(), ints.end(), [&]() { return dist(mt); });
+        auto ref = ints;
+
+        parallel::radix_sort(policy, ints.begin(), ints.end());
+        std::sort(ref.begin(), ref.end());
+        BOOST_CHECK(ints == ref);
+
+        std::uniform_real_distribution<float> fdist(-1e6f, 1e6f);
+        std::vector<float> floats(n);
+        std::generate(floats.begin(), floats.end(), [&]() { return fdist(mt); });
+        floats[0] = -0.0f;
+        floats[1] = std::numeric_limits<float>::infinity();
+        floats[2] = -std::numeric_limits<float>::infinity();
+        auto fref = floats;
+
+        parallel::radix_sort(policy, floats.begin(), floats.end());
+        std::sort(fref.begin(), fref.end());
+        BOOST_CHECK(std::is_sorted(floats.begin(), floats.end()));
+        BOOST_CHECK(std::equal(floats.begin(), floats.end(), fref.begin()));
+
+        std::vector<double> doubles = {3.5, -1.25, 0.0, -1e300, 1e-300, 42.0};
+        parallel::radix_sort(policy, doubles.begin(), doubles.end());
+        BOOST_CHECK(std::is_sorted(doubles.begin(), doubles.end()));
+    }
+
+    // by key, stable
+    {
+        std::vector<std::pair<std::uint16_t, std::size_t>> records(n);
+        for (std::size_t i = 0; i < n; ++i) {
+            records[i] = std::make_pair(std::uint16_t(mt() % 512), i);
+        }
+
+        parallel::radix_sort_by_key(policy, records.begin(), records.end(),
+                                    [](const std::pair<std::uint16_t, std::size_t>& r) { return r.first; });
+
+        BOOST_CHECK(std::is_sorted(records.begin(), records.end()));
+    }
+}
+
+
 
 
 BOOST_AUTO_TEST_CASE(parallel_inclusive_scan) {
@@ -618,3 +1489,116 @@ BOOST_AUTO_TEST_CASE(parallel_inclusive_scan) {
         res = v1[i];
     }
 }
+
+
+// operations of a chained tile algorithm waiting on tasks of the same pool: the waiting workers
+// help with the other tasks of the pool, including the tasks of the algorithm itself
+BOOST_AUTO_TEST_CASE(parallel_chained_tiles_nested_wait) {
+
+    using namespace hadoken;
+
+    auto pool = std::make_shared<thread_pool_executor>(2);
+    parallel::parallel_shared_exec_policy<thread_pool_executor> policy(pool, 8);
+
+    const std::size_t n = 1 << 20;
+    std::vector<long long> values(n), res(n), expected(n);
+    std::iota(values.begin(), values.end(), 0);
+
+    std::atomic<std::size_t> n_calls(0);
+    auto nested_wait = [&pool, &n_calls]() {
+        if ((n_calls.fetch_add(1, std::memory_order_relaxed) % 4096) == 0) {
+            pool->twoway_execute([]() { return 0; }).get();
+        }
+    };
+
+    std::partial_sum(values.begin(), values.end(), expected.begin());
+    parallel::inclusive_scan(policy, values.begin(), values.end(), res.begin(), [&](long long a, long long b) {
+        nested_wait();
+        return a + b;
+    });
+    BOOST_CHECK(res == expected);
+
+    expected.clear();
+    std::copy_if(values.begin(), values.end(), std::back_inserter(expected), [](long long v) { return v % 3 == 0; });
+    auto res_end = parallel::copy_if(policy, values.begin(), values.end(), res.begin(), [&](long long v) {
+        nested_wait();
+        return v % 3 == 0;
+    });
+    BOOST_CHECK_EQUAL(std::distance(res.begin(), res_end), expected.size());
+    BOOST_CHECK(std::equal(expected.begin(), expected.end(), res.begin()));
+}
+
+
+BOOST_AUTO_TEST_CASE(parallel_scan_test) {
+
+    using namespace hadoken;
+
+    auto pool = std::make_shared<thread_pool_executor>(4);
+    parallel::parallel_shared_exec_policy<thread_pool_executor> policy(pool);
+
+    const std::size_t n = 1000000;
+    std::vector<std::uint64_t> values(n), expected(n), res(n);
+    std::iota(values.begin(), values.end(), 1);
+    std::partial_sum(values.begin(), values.end(), expected.begin());
+
+    BOOST_CHECK(parallel::inclusive_scan(policy, values.begin(), values.end(), res.begin()) == res.end());
+    BOOST_CHECK(res == expected);
+
+    // initial value
+    parallel::inclusive_scan(policy, values.begin(), values.end(), res.begin(), std::plus<std::uint64_t>(),
+                             std::uint64_t(100));
+    BOOST_CHECK_EQUAL(res.front(), 101);
+    BOOST_CHECK_EQUAL(res.back(), expected.back() + 100);
+
+    // exclusive
+    BOOST_CHECK(parallel::exclusive_scan(policy, values.begin(), values.end(), res.begin(), std::uint64_t(0)) == res.end());
+    BOOST_CHECK_EQUAL(res.front(), 0);
+    BOOST_CHECK(std::equal(res.begin() + 1, res.end(), expected.begin()));
+
+    // in place
+    std::vector<std::uint64_t> in_place(values);
+    parallel::inclusive_scan(policy, in_place.begin(), in_place.end(), in_place.begin());
+    BOOST_CHECK(in_place == expected);
+
+    in_place = values;
+    parallel::exclusive_scan(policy, in_place.begin(), in_place.end(), in_place.begin(), std::uint64_t(0));
+    BOOST_CHECK(std::equal(in_place.begin() + 1, in_place.end(), expected.begin()));
+
+    // strided output
+    std::vector<std::uint64_t> strided(2 * n, 0);
+    auto strided_range = boost::adaptors::stride(strided, 2);
+    parallel::inclusive_scan(policy, values.begin(), values.end(), strided_range.begin());
+    BOOST_CHECK_EQUAL(strided[2 * (n - 1)], expected.back());
+    BOOST_CHECK_EQUAL(strided[1], 0);
+    BOOST_CHECK(std::equal(strided_range.begin(), strided_range.end(), expected.begin()));
+
+    // non commutative operator: composition of affine functions x -> a * x + b modulo a prime
+    typedef std::pair<std::uint64_t, std::uint64_t> affine;
+    const std::uint64_t prime = 1000003;
+    auto compose = [prime](const affine& f, const affine& g) {
+        return affine((f.first * g.first) % prime, (f.second * g.first + g.second) % prime);
+    };
+
+    std::vector<affine> functions(n), composed(n), composed_seq(n);
+    for (std::size_t i = 0; i < n; ++i) {
+        functions[i] = affine(i % 7 + 1, i % 13);
+    }
+    parallel::inclusive_scan(policy, functions.begin(), functions.end(), composed.begin(), compose);
+    parallel::inclusive_scan(parallel::seq, functions.begin(), functions.end(), composed_seq.begin(), compose);
+    BOOST_CHECK(composed == composed_seq);
+
+    // floating point scans do not depend on the number of workers
+    std::vector<double> reals(n), scan2(n), scan4(n);
+    std::mt19937 mt;
+    std::uniform_real_distribution<double> dist(-1e10, 1e10);
+    std::generate(reals.begin(), reals.end(), [&]() { return dist(mt); });
+
+    parallel::parallel_shared_exec_policy<thread_pool_executor> policy2(std::make_shared<thread_pool_executor>(2));
+    parallel::inclusive_scan(policy, reals.begin(), reals.end(), scan4.begin());
+    parallel::inclusive_scan(policy2, reals.begin(), reals.end(), scan2.begin());
+    BOOST_CHECK(scan2 == scan4);
+
+    // empty range
+    BOOST_CHECK(parallel::exclusive_scan(policy, values.begin(), values.begin(), res.begin(), std::uint64_t(0)) ==
+                res.begin());
+}
@@ -30,16 +30,28 @@
 #define BOOST_TEST_MODULE containerTests
 #define BOOST_TEST_MAIN
 
+// exercise the instrumented thread pool, the other tests use the default build
+#define HADOKEN_EXECUTOR_METRICS
+
+#include <array>
 #include <functional>
 #include <future>
 #include <iostream>
+#include <memory>
+#include <mutex>
 #include <sstream>
 #include <stdexcept>
+#include <string>
 
 #include <boost/test/unit_test.hpp>
 
+#include <hadoken/containers/concurrent_queue_mpmc_bounded.hpp>
 #include <hadoken/executor/simple_thread_executor.hpp>
 #include <hadoken/executor/thread_pool_executor.hpp>
+#include <hadoken/executor/timer_executor.hpp>
+#include <hadoken/executor/unique_task.hpp>
+#include <hadoken/thread/event_count.hpp>
+#include <hadoken/thread/future.hpp>
 #include <hadoken/thread/latch.hpp>
 #include <hadoken/thread/spinlock.hpp>
 
@@ -122,6 +134,7 @@ BOOST_AUTO_TEST_CASE(executor_pool_thread_wait) {
 
     {
         hadoken::thread_pool_executor exec_thread(32);
+        exec_thread.set_flags(hadoken::thread_pool_executor::flags::complete_all_before_delete, true);
 
         for (std::size_t i = 0; i < iterations; ++i) {
             exec_thread.execute([&]() {
@@ -137,6 +150,882 @@ BOOST_AUTO_TEST_CASE(executor_pool_thread_wait) {
 }
 
 
+BOOST_AUTO_TEST_CASE(executor_pool_thread_destroy_pending) {
+    std::atomic<std::size_t> counter(0);
+
+    // a task resubmitting itself forever does not prevent the destruction
+    // declared before the pool, the queued copies are destroyed with it
+    std::function<void()> resubmit;
+    {
+        hadoken::thread_pool_executor exec_thread(2);
+
+        resubmit = [&]() {
+            counter += 1;
+            exec_thread.execute(resubmit);
+        };
+        exec_thread.execute(resubmit);
+
+        while (counter.load() < 16) {
+            std::this_thread::yield();
+        }
+    }
+
+    // a task still queued at destruction is never executed, its future is broken
+    std::atomic<bool> release(false);
+    hadoken::thread_pool_executor::future<int> queued;
+    std::thread releaser([&]() {
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        release = true;
+    });
+    {
+        hadoken::thread_pool_executor exec_thread(1);
+
+        exec_thread.execute([&]() {
+            while (release.load() == false) {
+                std::this_thread::yield();
+            }
+        });
+        queued = exec_thread.twoway_execute([]() { return 42; });
+    }
+    releaser.join();
+
+    BOOST_CHECK_THROW(queued.get(), std::future_error);
+}
+
+
+
+template <typename T>
+using bounded_test_queue = hadoken::concurrent_queue_mpmc_bounded<T, 64>;
+
+BOOST_AUTO_TEST_CASE(executor_pool_thread_bounded_queue) {
+    std::atomic<std::size_t> counter(0);
+    const std::size_t iterations = 1024;
+
+    {
+        using bounded_pool = hadoken::basic_thread_pool_executor<bounded_test_queue>;
+        bounded_pool exec_thread(4);
+        exec_thread.set_flags(bounded_pool::flags::complete_all_before_delete, true);
+
+        for (std::size_t i = 0; i < iterations; ++i) {
+            exec_thread.execute([&]() { counter += 1; });
+        }
+
+        auto f = exec_thread.twoway_execute([]() { return 42; });
+        BOOST_CHECK_EQUAL(f.get(), 42);
+    }
+
+    BOOST_CHECK_EQUAL(counter.load(), iterations);
+}
+
+
+BOOST_AUTO_TEST_CASE(executor_pool_thread_wait_idle) {
+    std::atomic<std::size_t> counter(0);
+    const std::size_t iterations = 64;
+
+    hadoken::thread_pool_executor exec_thread(4);
+
+    BOOST_CHECK_EQUAL(exec_thread.pending_tasks(), 0);
+    BOOST_CHECK_EQUAL(exec_thread.wait_idle_for(std::chrono::milliseconds(1)), true);
+
+    // tasks still running when the queue is already empty, and nested submissions
+    for (std::size_t i = 0; i < iterations; ++i) {
+        exec_thread.execute([&]() {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            exec_thread.execute([&]() { counter += 1; });
+            counter += 1;
+        });
+    }
+
+    exec_thread.wait_idle();
+
+    BOOST_CHECK_EQUAL(counter.load(), 2 * iterations);
+    BOOST_CHECK_EQUAL(exec_thread.pending_tasks(), 0);
+
+    // timed variant
+    exec_thread.execute([]() { std::this_thread::sleep_for(std::chrono::milliseconds(50)); });
+    BOOST_CHECK_EQUAL(exec_thread.wait_idle_for(std::chrono::milliseconds(1)), false);
+    BOOST_CHECK_EQUAL(exec_thread.wait_idle_for(std::chrono::seconds(10)), true);
+
+    // waiting from a worker of the pool is refused
+    auto f = exec_thread.twoway_execute([&]() { exec_thread.wait_idle(); });
+    BOOST_CHECK_THROW(f.get(), std::logic_error);
+}
+
+
+BOOST_AUTO_TEST_CASE(executor_pool_thread_work_stealing) {
+    std::atomic<std::size_t> counter(0);
+    const std::size_t depth = 12;
+    const std::size_t n_tasks = (std::size_t(1) << (depth + 1)) - 1;
+
+    // declared before the pool, need to outlive the workers
+    std::function<void(std::size_t)> spawn_tree;
+
+    hadoken::thread_pool_executor exec_thread(4);
+    exec_thread.set_flags(hadoken::thread_pool_executor::flags::work_stealing, true);
+    BOOST_CHECK(exec_thread.get_flag(hadoken::thread_pool_executor::flags::work_stealing));
+
+    // binary tree of tasks, children are spawned from pool threads
+    spawn_tree = [&](std::size_t level) {
+        counter += 1;
+        if (level < depth) {
+            exec_thread.execute([&spawn_tree, level]() { spawn_tree(level + 1); });
+            exec_thread.execute([&spawn_tree, level]() { spawn_tree(level + 1); });
+        }
+    };
+
+    exec_thread.execute([&spawn_tree]() { spawn_tree(0); });
+
+    while (counter.load() < n_tasks) {
+        std::this_thread::yield();
+    }
+
+    BOOST_CHECK_EQUAL(counter.load(), n_tasks);
+}
+
+
+BOOST_AUTO_TEST_CASE(executor_pool_thread_parking) {
+    std::atomic<std::size_t> counter(0);
+    const std::size_t iterations = 64;
+
+    for (std::size_t spin_budget : {std::size_t(0), std::size_t(1000)}) {
+        counter = 0;
+
+        hadoken::thread_pool_executor exec_thread(4);
+        exec_thread.set_spin_budget(spin_budget);
+        BOOST_CHECK_EQUAL(exec_thread.get_spin_budget(), spin_budget);
+
+        // let the workers park, then wake them up with new work
+        for (std::size_t i = 0; i < iterations; ++i) {
+            if (i % 16 == 0) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(5));
+            }
+
+            auto f = exec_thread.twoway_execute([&]() { return ++counter; });
+            f.get();
+        }
+
+        BOOST_CHECK_EQUAL(counter.load(), iterations);
+    }
+}
+
+
+BOOST_AUTO_TEST_CASE(executor_pool_thread_move_only_task) {
+    hadoken::thread_pool_executor exec_thread(2);
+
+    std::unique_ptr<int> value(new int(42));
+    std::shared_ptr<int> res(new int(0));
+
+    // move-only capture, not accepted by std::function
+    auto task = std::bind([res](std::unique_ptr<int>& v) { *res = *v; }, std::move(value));
+    exec_thread.execute(std::move(task));
+    exec_thread.wait_idle();
+    BOOST_CHECK_EQUAL(*res, 42);
+
+    auto f = exec_thread.twoway_execute([]() -> std::unique_ptr<int> { return std::unique_ptr<int>(new int(7)); });
+    BOOST_CHECK_EQUAL(*f.get(), 7);
+    BOOST_CHECK(f.valid() == false);
+
+    auto f_error = exec_thread.twoway_execute([]() -> int { throw std::runtime_error("task error"); });
+    BOOST_CHECK_THROW(f_error.get(), std::runtime_error);
+}
+
+
+template <typename Executor>
+void check_bulk_execute(Executor& exec_thread) {
+    const std::size_t n = 1000;
+
+    std::vector<std::atomic<int>> hits(n);
+    for (auto& h : hits) {
+        h = 0;
+    }
+
+    exec_thread.bulk_execute(n, [&hits](std::size_t i) { hits[i] += 1; });
+    exec_thread.wait_idle();
+
+    exec_thread.bulk_twoway_execute(n, [&hits](std::size_t i) { hits[i] += 1; }).get();
+
+    for (auto& h : hits) {
+        BOOST_CHECK_EQUAL(h.load(), 2);
+    }
+
+    // empty bulk is immediately ready
+    auto f_empty = exec_thread.bulk_twoway_execute(0, [](std::size_t) {});
+    BOOST_CHECK(f_empty.is_ready());
+
+    // the first error is propagated to the future
+    auto f_error = exec_thread.bulk_twoway_execute(n, [](std::size_t i) {
+        if (i == 10) {
+            throw std::runtime_error("bulk error");
+        }
+    });
+    BOOST_CHECK_THROW(f_error.get(), std::runtime_error);
+    BOOST_CHECK(exec_thread.wait_idle_for(std::chrono::seconds(10)));
+}
+
+BOOST_AUTO_TEST_CASE(executor_pool_thread_bulk) {
+    {
+        hadoken::thread_pool_executor exec_thread(4);
+        check_bulk_execute(exec_thread);
+    }
+
+    {
+        hadoken::basic_thread_pool_executor<bounded_test_queue> exec_thread(4);
+        check_bulk_execute(exec_thread);
+    }
+}
+
+
+// recursive fork/join through twoway_execute, blocking get() on the workers
+std::size_t nested_fibonacci(hadoken::thread_pool_executor& pool, std::size_t n) {
+    if (n < 2) {
+        return n;
+    }
+
+    auto first = pool.twoway_execute([&pool, n]() { return nested_fibonacci(pool, n - 1); });
+    const std::size_t second = nested_fibonacci(pool, n - 2);
+    return first.get() + second;
+}
+
+
+BOOST_AUTO_TEST_CASE(executor_pool_thread_nested) {
+    for (std::size_t n_thread : {1, 4}) {
+        for (bool work_stealing : {false, true}) {
+            hadoken::thread_pool_executor pool(n_thread);
+            pool.set_flags(hadoken::thread_pool_executor::flags::work_stealing, work_stealing);
+
+            // every worker blocked on nested futures: waiting workers execute the nested tasks
+            auto res = pool.twoway_execute([&pool]() { return nested_fibonacci(pool, 16); });
+            BOOST_CHECK_EQUAL(res.get(), 987);
+
+            // nested bulk submission from every worker
+            std::atomic<std::size_t> counter(0);
+            pool.bulk_twoway_execute(8, [&pool, &counter](std::size_t) {
+                    pool.bulk_twoway_execute(64, [&counter](std::size_t i) { counter += i; }).get();
+                }).get();
+            BOOST_CHECK_EQUAL(counter.load(), 8 * (64 * 63 / 2));
+
+            pool.wait_idle();
+            BOOST_CHECK_EQUAL(pool.pending_tasks(), 0);
+        }
+    }
+}
+
+
+BOOST_AUTO_TEST_CASE(executor_pool_thread_metrics) {
+    const std::size_t n_tasks = 1000;
+
+    hadoken::thread_pool_executor pool(2);
+    pool.set_spin_budget(0);
+
+    hadoken::executor_metrics idle = pool.metrics();
+    BOOST_CHECK(idle.enabled);
+    BOOST_CHECK_EQUAL(idle.workers.size(), 2);
+    BOOST_CHECK_EQUAL(idle.tasks(), 0);
+
+    std::atomic<std::size_t> counter(0);
+    for (std::size_t i = 0; i < n_tasks; ++i) {
+        pool.execute([&counter]() { counter += 1; });
+    }
+    pool.twoway_execute([]() { std::this_thread::sleep_for(std::chrono::milliseconds(5)); }).get();
+    pool.bulk_twoway_execute(64, [&counter](std::size_t) { counter += 1; }).get();
+    pool.wait_idle();
+
+    // let the workers park
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+
+    // snapshot of a running pool
+    hadoken::executor_metrics m = pool.metrics();
+    BOOST_CHECK_EQUAL(m.pending_tasks, 0);
+    BOOST_CHECK_GE(m.tasks(), n_tasks + 1 + 1);
+
+    hadoken::histogram_snapshot latency = m.queue_latency(), run_time = m.run_time();
+    BOOST_CHECK_EQUAL(latency.count(), m.tasks());
+    BOOST_CHECK_EQUAL(run_time.count(), m.tasks());
+
+    // the sleeping task is the longest one
+    BOOST_CHECK_GE(run_time.percentile(1.0), 5000000);
+    BOOST_CHECK_LE(run_time.percentile(0.5), run_time.percentile(1.0));
+
+    std::uint64_t parks = 0;
+    for (auto& w : m.workers) {
+        BOOST_CHECK_LE(w.busy_time, w.elapsed_time);
+        parks += w.parks;
+    }
+    BOOST_CHECK_GE(parks, 1);
+    BOOST_CHECK(m.utilization() > 0.0 && m.utilization() <= 1.0);
+
+    // histogram buckets by power of two
+    hadoken::log2_histogram hist;
+    hist.record(0);
+    hist.record(1);
+    hist.record(1000);
+    hadoken::histogram_snapshot snap = hist.snapshot();
+    BOOST_CHECK_EQUAL(snap.count(), 3);
+    BOOST_CHECK_EQUAL(snap.buckets[0], 1);
+    BOOST_CHECK_EQUAL(snap.buckets[1], 1);
+    BOOST_CHECK_EQUAL(snap.buckets[10], 1);
+    BOOST_CHECK_EQUAL(snap.sum, 1001);
+    BOOST_CHECK_EQUAL(snap.percentile(1.0), 1023);
+}
+
+
+BOOST_AUTO_TEST_CASE(executor_pool_thread_affinity) {
+    const std::size_t cpu = hadoken::get_numa_nodes().front().cpus.front();
+
+    {
+        hadoken::thread_pool_executor exec_thread(2, hadoken::worker_affinity::cpu_set({cpu}));
+        BOOST_CHECK_EQUAL(exec_thread.get_node_count(), 1);
+        check_bulk_execute(exec_thread);
+    }
+
+    {
+        // numa mode on the real topology, a single node on most test machines
+        hadoken::thread_pool_executor exec_thread(0, hadoken::worker_affinity::numa());
+        BOOST_CHECK_EQUAL(exec_thread.get_node_count(), hadoken::get_numa_nodes().size());
+        check_bulk_execute(exec_thread);
+    }
+
+    {
+        // two simulated nodes sharing the same cpu
+        std::vector<hadoken::numa_node> nodes = {hadoken::numa_node{0, {cpu}}, hadoken::numa_node{1, {cpu}}};
+        hadoken::thread_pool_executor exec_thread(4, hadoken::worker_affinity::numa(nodes));
+        exec_thread.set_flags(hadoken::thread_pool_executor::flags::work_stealing, true);
+        BOOST_CHECK_EQUAL(exec_thread.get_node_count(), 2);
+
+        check_bulk_execute(exec_thread);
+
+        std::atomic<std::size_t> counter(0);
+        for (std::size_t i = 0; i < 64; ++i) {
+            exec_thread.execute([&]() {
+                for (std::size_t j = 0; j < 16; ++j) {
+                    exec_thread.execute([&]() { counter += 1; });
+                }
+            });
+        }
+        exec_thread.wait_idle();
+        BOOST_CHECK_EQUAL(counter.load(), 64 * 16);
+    }
+}
+
+
+BOOST_AUTO_TEST_CASE(executor_pool_thread_priority) {
+    using hadoken::task_priority;
+    using clock = std::chrono::steady_clock;
+
+    hadoken::thread_pool_executor exec_thread(1);
+    exec_thread.set_aging_threshold(std::chrono::hours(1));
+
+    std::atomic<bool> blocked(true);
+    std::mutex order_lock;
+    std::vector<int> order;
+
+    auto record = [&](int id) {
+        return [&order_lock, &order, id]() {
+            std::lock_guard<std::mutex> l(order_lock);
+            order.push_back(id);
+        };
+    };
+
+    // keep the single worker busy while the lanes are filled
+    exec_thread.execute([&blocked]() {
+        while (blocked.load()) {
+            std::this_thread::yield();
+        }
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(5));
+
+    const auto now = clock::now();
+    exec_thread.execute(record(6), task_priority::low);
+    exec_thread.execute(record(4), task_priority::normal);
+    exec_thread.execute(record(3), task_priority::normal, now + std::chrono::seconds(2));
+    exec_thread.execute(record(2), task_priority::normal, now + std::chrono::seconds(1));
+    exec_thread.execute(record(5), task_priority::normal);
+    exec_thread.execute(record(1), task_priority::high);
+
+    BOOST_CHECK_EQUAL(exec_thread.get_lane_stats(task_priority::normal).depth, 4);
+
+    blocked = false;
+    exec_thread.wait_idle();
+
+    // high first, earliest deadline first, then submission order
+    const std::vector<int> expected = {1, 2, 3, 4, 5, 6};
+    BOOST_CHECK_EQUAL_COLLECTIONS(order.begin(), order.end(), expected.begin(), expected.end());
+
+    const hadoken::priority_lane_stats normal_stats = exec_thread.get_lane_stats(task_priority::normal);
+    BOOST_CHECK_EQUAL(normal_stats.depth, 0);
+    BOOST_CHECK_EQUAL(normal_stats.executed, 4);
+    BOOST_CHECK(normal_stats.max_wait.count() > 0);
+    BOOST_CHECK(normal_stats.mean_wait() <= normal_stats.max_wait);
+
+    // aging: an old low priority task goes before a fresh high priority one
+    order.clear();
+    blocked = true;
+    exec_thread.set_aging_threshold(std::chrono::milliseconds(1));
+
+    exec_thread.execute([&blocked]() {
+        while (blocked.load()) {
+            std::this_thread::yield();
+        }
+    });
+    exec_thread.execute(record(2), task_priority::low);
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    exec_thread.execute(record(1), task_priority::high);
+
+    blocked = false;
+    exec_thread.wait_idle();
+
+    const std::vector<int> expected_aged = {2, 1};
+    BOOST_CHECK_EQUAL_COLLECTIONS(order.begin(), order.end(), expected_aged.begin(), expected_aged.end());
+    BOOST_CHECK_EQUAL(exec_thread.get_lane_stats(task_priority::low).aged, 1);
+}
+
+
+BOOST_AUTO_TEST_CASE(executor_pool_thread_priority_deadline_aging) {
+    using hadoken::task_priority;
+    using clock = std::chrono::steady_clock;
+
+    hadoken::thread_pool_executor exec_thread(1);
+    exec_thread.set_aging_threshold(std::chrono::milliseconds(5));
+
+    const std::size_t max_deadline_tasks = 2000;
+    std::atomic<bool> blocked(true), done(false);
+    std::atomic<std::size_t> n_deadline(0), n_deadline_before(max_deadline_tasks);
+
+    // two chains of deadline tasks: there is always a deadline task queued in the normal lane
+    std::function<void()> deadline_task = [&]() {
+        n_deadline += 1;
+        std::this_thread::sleep_for(std::chrono::microseconds(500));
+        if (done.load() == false && n_deadline.load() < max_deadline_tasks) {
+            exec_thread.execute(deadline_task, task_priority::normal, clock::now() + std::chrono::seconds(1));
+        }
+    };
+
+    exec_thread.execute([&blocked]() {
+        while (blocked.load()) {
+            std::this_thread::yield();
+        }
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(5));
+
+    exec_thread.execute(
+        [&]() {
+            n_deadline_before = n_deadline.load();
+            done = true;
+        },
+        task_priority::normal);
+    exec_thread.execute(deadline_task, task_priority::normal, clock::now() + std::chrono::seconds(1));
+    exec_thread.execute(deadline_task, task_priority::normal, clock::now() + std::chrono::seconds(1));
+
+    blocked = false;
+    exec_thread.wait_idle();
+
+    // the effective deadline of the task without deadline is its submission time plus the aging threshold,
+    // it does not wait for the end of the stream
+    BOOST_CHECK(done.load());
+    BOOST_CHECK_LT(n_deadline_before.load(), max_deadline_tasks / 4);
+}
+
+
+BOOST_AUTO_TEST_CASE(timing_wheel_test) {
+    using hadoken::details::timing_wheel;
+
+    timing_wheel wheel;
+    std::vector<std::pair<timing_wheel::tick_type, timing_wheel::tick_type>> fired;
+    std::vector<timing_wheel::handle> handles;
+
+    // expiries on every level, and beyond the last one
+    std::vector<timing_wheel::tick_type> expiries;
+    std::uint64_t seed = 42;
+    for (std::size_t i = 0; i < 2000; ++i) {
+        seed = seed * 6364136223846793005ULL + 1442695040888963407ULL;
+        const std::size_t level = i % 5;
+        const timing_wheel::tick_type range = timing_wheel::tick_type(1) << (8 * level + 8);
+        expiries.push_back(1 + (seed >> 11) % range);
+    }
+
+    for (auto expiry : expiries) {
+        handles.push_back(wheel.insert(expiry, hadoken::unique_task([&fired, &wheel, expiry]() {
+                                           fired.emplace_back(expiry, wheel.current_tick());
+                                       })));
+    }
+    BOOST_CHECK_EQUAL(wheel.size(), expiries.size());
+
+    // cancel one timer out of 4
+    std::size_t n_cancelled = 0;
+    for (std::size_t i = 0; i < handles.size(); i += 4) {
+        BOOST_CHECK(wheel.cancel(handles[i]));
+        BOOST_CHECK(wheel.cancel(handles[i]) == false);
+        n_cancelled += 1;
+    }
+
+    const timing_wheel::tick_type end = timing_wheel::tick_type(1) << 40;
+    wheel.advance(end, [](hadoken::unique_task&& task) { task(); });
+
+    BOOST_CHECK_EQUAL(wheel.size(), 0);
+    BOOST_CHECK_EQUAL(wheel.current_tick(), end);
+    BOOST_CHECK_EQUAL(fired.size(), expiries.size() - n_cancelled);
+
+    // every timer fired exactly at its expiry, in order
+    for (std::size_t i = 0; i < fired.size(); ++i) {
+        BOOST_CHECK_EQUAL(fired[i].first, fired[i].second);
+        if (i > 0) {
+            BOOST_CHECK(fired[i - 1].second <= fired[i].second);
+        }
+    }
+
+    // a stale handle does not cancel a recycled node
+    BOOST_CHECK(wheel.cancel(handles[1]) == false);
+
+    // periodic timer, re-armed until cancelled
+    std::size_t n_periodic = 0;
+    auto periodic = wheel.insert(wheel.current_tick() + 10, hadoken::unique_task([&n_periodic]() { n_periodic += 1; }), 10);
+    wheel.advance(wheel.current_tick() + 1000, [](hadoken::unique_task&& task) { task(); });
+    BOOST_CHECK_EQUAL(n_periodic, 100);
+    BOOST_CHECK(wheel.cancel(periodic));
+    BOOST_CHECK(wheel.next_event() == timing_wheel::no_event);
+}
+
+
+BOOST_AUTO_TEST_CASE(timer_executor_test) {
+    using clock = std::chrono::steady_clock;
+
+    std::mutex order_lock;
+    std::vector<int> order;
+    std::atomic<std::size_t> n_ticks(0), n_done(0);
+
+    {
+        // executed by the timer thread
+        hadoken::timer_executor timer;
+
+        const auto start = clock::now();
+        clock::time_point executed_at;
+
+        timer.execute_after(std::chrono::milliseconds(30), [&]() {
+            std::lock_guard<std::mutex> l(order_lock);
+            order.push_back(3);
+            executed_at = clock::now();
+            n_done += 1;
+        });
+        timer.execute_at(start + std::chrono::milliseconds(10), [&]() {
+            std::lock_guard<std::mutex> l(order_lock);
+            order.push_back(1);
+            n_done += 1;
+        });
+        timer.execute_after(std::chrono::milliseconds(20), [&]() {
+            std::lock_guard<std::mutex> l(order_lock);
+            order.push_back(2);
+            n_done += 1;
+        });
+
+        auto cancelled = timer.execute_after(std::chrono::milliseconds(15), [&]() { n_done += 100; });
+        BOOST_CHECK(timer.cancel(cancelled));
+        BOOST_CHECK(timer.cancel(cancelled) == false);
+        BOOST_CHECK(timer.cancel(hadoken::timer_executor::timer_handle()) == false);
+
+        auto periodic = timer.execute_every(std::chrono::milliseconds(2), [&]() { n_ticks += 1; });
+        BOOST_CHECK_EQUAL(timer.pending_timers(), 4);
+
+        while (n_done.load() < 3) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+
+        std::lock_guard<std::mutex> l(order_lock);
+        const std::vector<int> expected = {1, 2, 3};
+        BOOST_CHECK_EQUAL_COLLECTIONS(order.begin(), order.end(), expected.begin(), expected.end());
+        BOOST_CHECK(executed_at - start >= std::chrono::milliseconds(30));
+
+        while (n_ticks.load() < 3) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        BOOST_CHECK(timer.cancel(periodic));
+        BOOST_CHECK_EQUAL(timer.pending_timers(), 0);
+
+        // execute() never runs the task on the caller thread
+        hadoken::thread::promise<std::thread::id> timer_id;
+        auto f = timer_id.get_future();
+        timer.execute([&timer_id]() { timer_id.set_value(std::this_thread::get_id()); });
+        BOOST_CHECK(f.get() != std::this_thread::get_id());
+    }
+    BOOST_CHECK_EQUAL(n_done.load(), 3);
+
+    {
+        // dispatched to a thread pool
+        hadoken::thread_pool_executor pool(2);
+        hadoken::timer_executor timer(pool);
+
+        hadoken::thread::promise<std::thread::id> executor_id;
+        auto f = executor_id.get_future();
+        timer.execute_after(std::chrono::milliseconds(1), [&executor_id]() { executor_id.set_value(std::this_thread::get_id()); });
+        BOOST_CHECK(f.get() != std::this_thread::get_id());
+
+        // many timers
+        std::atomic<std::size_t> counter(0);
+        for (std::size_t i = 0; i < 10000; ++i) {
+            timer.execute_after(std::chrono::microseconds(i * 2), [&counter]() { counter += 1; });
+        }
+        while (counter.load() < 10000) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        pool.wait_idle();
+    }
+}
+
+
+BOOST_AUTO_TEST_CASE(unique_task_test) {
+    int counter = 0;
+
+    hadoken::unique_task empty;
+    BOOST_CHECK(!empty);
+    BOOST_CHECK_THROW(empty(), std::bad_function_call);
+
+    // small callable: inline storage
+    hadoken::unique_task small([&counter]() { counter += 1; });
+    BOOST_CHECK(small.is_inline());
+    small();
+    BOOST_CHECK_EQUAL(counter, 1);
+
+    // large callable: heap storage
+    std::array<int, 32> big_payload;
+    big_payload.fill(2);
+    hadoken::unique_task big([&counter, big_payload]() { counter += big_payload[31]; });
+    BOOST_CHECK(big.is_inline() == false);
+    big();
+    BOOST_CHECK_EQUAL(counter, 3);
+
+    // move and swap keep the callable, the source becomes empty
+    hadoken::unique_task moved(std::move(small));
+    BOOST_CHECK(!small);
+    moved();
+    BOOST_CHECK_EQUAL(counter, 4);
+
+    swap(moved, big);
+    moved();
+    BOOST_CHECK_EQUAL(counter, 6);
+    big();
+    BOOST_CHECK_EQUAL(counter, 7);
+
+    // captured resources are destroyed with the task
+    std::shared_ptr<int> resource(new int(0));
+    {
+        hadoken::unique_task holder([resource]() {});
+        BOOST_CHECK_EQUAL(resource.use_count(), 2);
+        hadoken::unique_task other;
+        other = std::move(holder);
+        BOOST_CHECK_EQUAL(resource.use_count(), 2);
+        other.reset();
+        BOOST_CHECK_EQUAL(resource.use_count(), 1);
+    }
+}
+
+
+BOOST_AUTO_TEST_CASE(future_promise_test) {
+    using namespace hadoken::thread;
+
+    {
+        promise<int> p;
+        future<int> f = p.get_future();
+        BOOST_CHECK(f.valid());
+        BOOST_CHECK(f.is_ready() == false);
+        BOOST_CHECK(f.wait_for(std::chrono::milliseconds(1)) == std::future_status::timeout);
+        BOOST_CHECK_THROW(p.get_future(), std::future_error);
+
+        std::thread setter([&p]() { p.set_value(42); });
+        BOOST_CHECK_EQUAL(f.get(), 42);
+        setter.join();
+        BOOST_CHECK_THROW(f.get(), std::future_error);
+        BOOST_CHECK_THROW(p.set_value(1), std::future_error);
+    }
+
+    {
+        // value set before the future is retrieved
+        promise<void> p;
+        p.set_value();
+        future<void> f = p.get_future();
+        BOOST_CHECK(f.is_ready());
+        f.get();
+    }
+
+    {
+        promise<int> p;
+        future<int> f = p.get_future();
+        p.set_exception(std::make_exception_ptr(std::runtime_error("error")));
+        BOOST_CHECK_THROW(f.get(), std::runtime_error);
+    }
+
+    {
+        future<int> f;
+        {
+            promise<int> p;
+            f = p.get_future();
+        }
+        BOOST_CHECK_THROW(f.get(), std::future_error);
+    }
+
+    {
+        int value = 1;
+        packaged_task<int&> task([&value]() -> int& { return value; });
+        future<int&> f = task.get_future();
+        std::thread runner(std::move(task));
+        BOOST_CHECK_EQUAL(&f.get(), &value);
+        runner.join();
+    }
+
+    {
+        // many concurrent waits, recycled states
+        for (std::size_t i = 0; i < 256; ++i) {
+            packaged_task<std::size_t> task([i]() { return i * 2; });
+            future<std::size_t> f = task.get_future();
+            std::thread runner(std::move(task));
+            BOOST_CHECK_EQUAL(f.get(), i * 2);
+            runner.join();
+        }
+    }
+}
+
+
+BOOST_AUTO_TEST_CASE(future_continuation_test) {
+    using namespace hadoken::thread;
+
+    {
+        // inline continuation, attached before and after completion
+        promise<int> p;
+        future<int> f = p.get_future().then([](future<int> v) { return v.get() + 1; });
+        BOOST_CHECK(f.is_ready() == false);
+        p.set_value(41);
+        BOOST_CHECK(f.is_ready());
+        BOOST_CHECK_EQUAL(f.get(), 42);
+
+        promise<void> ready;
+        ready.set_value();
+        future<std::string> s = ready.get_future().then([](future<void> v) {
+            v.get();
+            return std::string("done");
+        });
+        BOOST_CHECK_EQUAL(s.get(), "done");
+    }
+
+    {
+        // exceptions are forwarded through the input future
+        promise<int> p;
+        future<int> f = p.get_future().then([](future<int> v) { return v.get() * 2; });
+        p.set_exception(std::make_exception_ptr(std::runtime_error("stage failure")));
+        BOOST_CHECK_THROW(f.get(), std::runtime_error);
+
+        future<int> empty;
+        BOOST_CHECK_THROW(empty.then([](future<int> v) { return v.get(); }), std::future_error);
+    }
+
+    {
+        // pipeline scheduled on an executor, no thread blocked in between
+        hadoken::thread_pool_executor pool(4);
+        std::vector<future<std::size_t>> results;
+
+        for (std::size_t i = 0; i < 512; ++i) {
+            results.push_back(pool.twoway_execute([i]() { return i; })
+                                  .then(pool, [](future<std::size_t> v) { return v.get() * 2; })
+                                  .then(pool, [](future<std::size_t> v) { return v.get() + 1; }));
+        }
+
+        for (std::size_t i = 0; i < results.size(); ++i) {
+            BOOST_CHECK_EQUAL(results[i].get(), i * 2 + 1);
+        }
+    }
+
+    {
+        // when_all: every future is ready, in the input order
+        hadoken::thread_pool_executor pool(4);
+        std::vector<future<std::size_t>> futures;
+        for (std::size_t i = 0; i < 64; ++i) {
+            futures.push_back(pool.twoway_execute([i]() { return i; }));
+        }
+
+        std::vector<future<std::size_t>> all = when_all(futures.begin(), futures.end()).get();
+        BOOST_CHECK_EQUAL(all.size(), 64);
+        for (std::size_t i = 0; i < all.size(); ++i) {
+            BOOST_CHECK(all[i].is_ready());
+            BOOST_CHECK_EQUAL(all[i].get(), i);
+        }
+
+        promise<int> p1, p2;
+        future<std::vector<future<int>>> pair = when_all(p1.get_future(), p2.get_future());
+        p2.set_value(2);
+        BOOST_CHECK(pair.is_ready() == false);
+        p1.set_value(1);
+        std::vector<future<int>> values = pair.get();
+        BOOST_CHECK_EQUAL(values[0].get() + values[1].get(), 3);
+
+        std::vector<future<int>> none;
+        BOOST_CHECK(when_all(none.begin(), none.end()).get().empty());
+    }
+
+    {
+        // when_any: the first ready future, the others are still pending
+        promise<int> p1, p2, p3;
+        future<when_any_result<std::vector<future<int>>>> any = when_any(p1.get_future(), p2.get_future(), p3.get_future());
+        BOOST_CHECK(any.is_ready() == false);
+
+        p2.set_value(2);
+        when_any_result<std::vector<future<int>>> res = any.get();
+        BOOST_CHECK_EQUAL(res.index, 1);
+        BOOST_CHECK_EQUAL(res.futures.size(), 3);
+        BOOST_CHECK(res.futures[0].is_ready() == false);
+        BOOST_CHECK_EQUAL(res.futures[1].get(), 2);
+
+        // the remaining futures still accept continuations
+        future<int> next = res.futures[2].then([](future<int> v) { return v.get() + 10; });
+        p3.set_value(3);
+        p1.set_value(1);
+        BOOST_CHECK_EQUAL(next.get(), 13);
+        BOOST_CHECK_EQUAL(res.futures[0].get(), 1);
+
+        std::vector<future<int>> none;
+        BOOST_CHECK_EQUAL(when_any(none.begin(), none.end()).get().index, std::size_t(-1));
+    }
+}
+
+
+BOOST_AUTO_TEST_CASE(event_count_test) {
+    hadoken::thread::event_count ev;
+    std::atomic<std::size_t> value(0);
+
+    BOOST_CHECK_EQUAL(ev.waiters(), 0);
+
+    // notification before commit_wait is not lost
+    auto key = ev.prepare_wait();
+    BOOST_CHECK_EQUAL(ev.waiters(), 1);
+    ev.notify_one();
+    ev.commit_wait(key);
+    BOOST_CHECK_EQUAL(ev.waiters(), 0);
+
+    // timeout without notification
+    key = ev.prepare_wait();
+    BOOST_CHECK_EQUAL(ev.commit_wait_for(key, std::chrono::milliseconds(1)), false);
+
+    std::vector<std::thread> waiters;
+    for (std::size_t i = 0; i < 4; ++i) {
+        waiters.emplace_back([&]() {
+            while (value.load() == 0) {
+                auto local_key = ev.prepare_wait();
+                if (value.load() != 0) {
+                    ev.cancel_wait();
+                    break;
+                }
+                ev.commit_wait(local_key);
+            }
+        });
+    }
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    value.store(1);
+    ev.notify_all();
+
+    for (auto& t : waiters) {
+        t.join();
+    }
+
+    BOOST_CHECK_EQUAL(ev.waiters(), 0);
+}
+
 
 BOOST_AUTO_TEST_CASE(latch_test) {
     {